@@ -8,7 +8,7 @@
 //   - Logging         : info/warn/error via spdlog wrapper for structured, leveled output
 //   - Voxel I/O       : writeChunkToDisk for serializing voxel chunks to the ProjectV scene format
 //   - Voxel Mgmt      : ChunkHeader, VoxelBatch, createChunk, moveVoxelBatchToChunk, updateChunkFromItsVoxelBatch
-//   - Z-Order Indexing: createZOrderIndex / reverseZOrderIndex for Morton-coded spatial layout within chunks
+//   - Z-Order Indexing: createZOrderIndexBatch / reverseZOrderIndex for Morton-coded spatial layout within chunks
 //   - ECS             : core ECS types included as the foundation for all ProjectV scene objects
 
 #include "core/ecs.h"
@@ -324,6 +324,8 @@ void voxelizeObjFile(std::filesystem::path modelObjDirectory, std::string modelM
         cornerVoxel.ZOrderPosition = 4;
         cornerVoxel.color = {0, 0, 0};
         voxelBatch.emplace_back(cornerVoxel);
+        // Positions of the voxels after the corner voxel, Z-Orders are created for all of them at once after voxelizing.
+        std::vector<ivec3> voxelPositions;
 
         for (size_t triangleIndex = 0; triangleIndex < vertices.size() / 3; triangleIndex++) {
             const vec3& p0 = vertices[triangleIndex * 3].position;
@@ -428,14 +430,20 @@ void voxelizeObjFile(std::filesystem::path modelObjDirectory, std::string modelM
                         }
 
                         projv::Voxel voxel;
-                        voxel.ZOrderPosition = projv::utils::createZOrderIndex(ivec3(x, y, z));
                         voxel.color = {uint8_t(r), uint8_t(g), uint8_t(b)};
+                        voxelPositions.emplace_back(x, y, z);
                         projv::utils::addVoxelToVoxelBatch(voxel, voxelBatch);
                     }
                 }
             }
         }
 
+        std::vector<uint32_t> voxelZOrders(voxelPositions.size());
+        projv::utils::createZOrderIndexBatch(voxelPositions.data(), voxelZOrders.data(), voxelPositions.size());
+        for (size_t i = 0; i < voxelZOrders.size(); i++) {
+            voxelBatch[i + 1].ZOrderPosition = voxelZOrders[i];
+        }
+
         // Count voxels before batch is consumed (subtract the sentinel corner voxel)
         size_t chunkVoxels = voxelBatch.size() > 0 ? voxelBatch.size() - 1 : 0;
         totalVoxels += chunkVoxels;
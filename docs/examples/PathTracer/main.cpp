@@ -17,6 +17,9 @@
 //   - Logging         : info/warn via spdlog wrapper for structured output
 //   - Voxel I/O       : loadSceneFromDisk — deserializes the chunked voxel scene from disk
 //   - GPU Interface   : createTexturesForScene, GPUData — uploads voxel scene data to the GPU
+//                       updateVisibleChunkTexture — uploads the chunks in view, front to back, every frame
+//   - Scene BVH       : createSceneBVH, createVisibleChunkList — frustum culls and sorts the chunks for the camera
+//   - Occlusion       : findChunkOccluders, removeOccludedChunks — drops the chunks hidden behind closer solid chunks
 //   - Manage Resources: RendererSpecification, ConstructedRenderer, setTextureToData — builds the renderer pipeline
 //   - Disk I/O        : loadRendererSpecification, loadShader — loads renderer config and compiled shaders
 //   - Render Instance : window creation, active renderer management, window resolution query
@@ -32,6 +35,8 @@
 #include "graphics/perform_renderer.h"
 #include "graphics/type_mapping.h"
 #include "utils/voxel_io.h"
+#include "utils/scene_bvh.h"
+#include "utils/occlusion_culling.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -44,6 +49,9 @@ void startup(projv::Application& app) {
     projv::Scene& scene   = projv::core::createGlobalResource<projv::Scene>(app.world);
     float& cameraPhi      = projv::core::createGlobalResource<float>(app.world);
     projv::GPUData& gpuData = projv::core::createGlobalResource<projv::GPUData>(app.world);
+    projv::SceneBVH& sceneBVH = projv::core::createGlobalResource<projv::SceneBVH>(app.world);
+    std::vector<std::vector<projv::OccluderBox>>& chunkOccluders = projv::core::createGlobalResource<std::vector<std::vector<projv::OccluderBox>>>(app.world);
+    projv::core::createGlobalResource<projv::OcclusionBuffer>(app.world);
 
     cameraPhi = 3.14/2 + 0.4;
 
@@ -62,7 +70,11 @@ void startup(projv::Application& app) {
     projv::graphics::setTextureToData(constructedRenderer, 1, img, width, height);
 
     renderInstance.setActiveRenderer(constructedRenderer);
-    gpuData = projv::graphics::createTexturesForScene(scene);
+    sceneBVH = projv::utils::createSceneBVH(scene);
+    gpuData = projv::graphics::createTexturesForScene(scene, false, &sceneBVH);
+    for(const projv::Chunk& chunk : scene.chunks) {
+        chunkOccluders.push_back(projv::utils::findChunkOccluders(chunk));
+    }
 }
 
 // Update: frame timing profiler.
@@ -79,6 +91,10 @@ void update(projv::Application& app) {
 void render(projv::Application& app) {
     projv::graphics::RenderInstance& renderInstance = projv::core::getGlobalResource<projv::graphics::RenderInstance>(app.world);
     projv::GPUData& gpuData   = projv::core::getGlobalResource<projv::GPUData>(app.world);
+    projv::Scene& scene       = projv::core::getGlobalResource<projv::Scene>(app.world);
+    projv::SceneBVH& sceneBVH = projv::core::getGlobalResource<projv::SceneBVH>(app.world);
+    std::vector<std::vector<projv::OccluderBox>>& chunkOccluders = projv::core::getGlobalResource<std::vector<std::vector<projv::OccluderBox>>>(app.world);
+    projv::OcclusionBuffer& occlusionBuffer = projv::core::getGlobalResource<projv::OcclusionBuffer>(app.world);
     float& cameraPhi          = projv::core::getGlobalResource<float>(app.world);
 
     static projv::core::vec3 cameraPosition = projv::core::vec3(74.0, 30.0, -24.0);
@@ -129,6 +145,13 @@ void render(projv::Application& app) {
     projv::core::vec2 texelSize = {1/windowDimensions.x, 1/windowDimensions.y};
     projv::graphics::setUniformToValue(renderInstance.getActiveRenderer(), "texelSize",  texelSize);
 
+    // Cull the chunks against the same camera the shader builds its rays with (60 degree vertical FOV) and upload them front to back.
+    projv::core::mat4 view = projv::core::lookAt(cameraPosition, cameraPosition + cameraDirection, projv::core::vec3(0, 1, 0));
+    projv::core::mat4 projection = projv::core::perspective(projv::core::radians(60.0f), windowDimensions.x / windowDimensions.y, 0.1f, 100000.0f);
+    std::vector<projv::GPUVisibleChunk> visibleChunks = projv::utils::createVisibleChunkList(scene, sceneBVH, projection * view, cameraPosition, true);
+    visibleChunks = projv::utils::removeOccludedChunks(scene, chunkOccluders, visibleChunks, projection * view, cameraPosition, occlusionBuffer);
+    projv::graphics::updateVisibleChunkTexture(gpuData, visibleChunks);
+
     projv::graphics::renderConstructedRenderer(renderInstance, renderInstance.getActiveRenderer(), &gpuData);
 }
 
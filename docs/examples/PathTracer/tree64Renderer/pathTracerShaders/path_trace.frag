@@ -106,11 +106,19 @@ returnStruct castRay(vec2 uv_coord, GBuffer gBuffer) {
         intersectRQ.startLOD = 0;
         intersectRQ.finishLOD = 2;
         intersectRQ.distanceToFinishLOD = 30;
+        if (step == 0) {
+            intersectRQ.finishLOD = 0; // Camera rays stay at full detail, only the bounces stop above the voxels.
+        }
         if (step > 0) {
             //intersectRQ.maxRaySteps = randomFloat0to1(vec2(uv_coord), frameCount.x % 200) * 3 + 5;
         }
 
-        SceneIntersectData intersectHit = raySceneIntersect(ray, intersectRQ);
+        SceneIntersectData intersectHit;
+        if (step == 0) {
+            intersectHit = rayVisibleChunksIntersect(ray, intersectRQ);
+        } else {
+            intersectHit = raySceneIntersect(ray, intersectRQ);
+        }
         IntersectionResult voxelIntersection = getRayBoxEntry(ray, intersectHit.foundBox);
         if (voxelIntersection.distance <= 0) { // Ray hits the sky.
             if (dot(sunDirection, ray.direction) >= cos(thetaMax)) {
@@ -127,7 +135,7 @@ returnStruct castRay(vec2 uv_coord, GBuffer gBuffer) {
 
         vec3 albedo = vec3(1);
 
-        Voxel voxel = fetchVoxelData(intersectHit.foundBox, intersectHit.headerIndex);
+        Voxel voxel = fetchVoxelData(intersectHit);
         albedo = voxel.color; 
        //vec3 albedo = vec3(1.0, 0.8, 1.0);
 
@@ -312,7 +320,7 @@ GBuffer renderGBuffer(vec2 uv_coord) {
     intersectRQ.finishLOD = 0;
     intersectRQ.distanceToFinishLOD = 100;
 
-    SceneIntersectData intersectHit = raySceneIntersect(ray, intersectRQ);
+    SceneIntersectData intersectHit = rayVisibleChunksIntersect(ray, intersectRQ);
     IntersectionResult voxelIntersection = getRayBoxEntry(ray, intersectHit.foundBox);
     if (voxelIntersection.distance <= 0) { // Ray hits the sky.
         gBuffer.albedo = vec4(1, 1, 1, voxelIntersection.distance);
@@ -322,7 +330,7 @@ GBuffer renderGBuffer(vec2 uv_coord) {
     // Calculate the world space point that our ray intersects the scene. Do a small offset by the normal to account for imprecision in ray marching algorithm.
     vec3 intersectPoint = ray.origin + ray.direction * voxelIntersection.distance + voxelIntersection.normal * 0.001f;
 
-    Voxel voxel = fetchVoxelData(intersectHit.foundBox, intersectHit.headerIndex);
+    Voxel voxel = fetchVoxelData(intersectHit);
     vec3 albedo = voxel.color;
     //vec3 albedo = vec3(1);
 
@@ -1,6 +1,12 @@
 #define MAX_STACK_SIZE 12
 #define RENDER_MODE 3 //1-8
 #define VOXEL_TYPEDATA_SLICES 3
+#define VOXEL_ATTRIBUTE_INDEXING 0 // 1 if the scene was uploaded with createTexturesForScene(scene, true).
+#define VOXEL_ATTRIBUTE_SLICES 2
+#define SCENE_BVH_TRAVERSAL 1 // 0 tests every chunk header for every ray instead of walking the scene BVH.
+#define SCENE_BVH_END 0xFFFFFFFFu
+#define VISIBLE_CHUNK_LIST 1 // 1 casts camera rays through the front to back list from updateVisibleChunkTexture, 0 through raySceneIntersect.
+#define NODE_COLOR_NONE 0xFFFFFFFFu // nodeColorStartIndex of chunks uploaded without node colors, and nodeColorIndex of hits on voxels.
 
 /* File structure:
  * - Uniforms
@@ -17,12 +23,15 @@
 USAMPLER2D(tree64Data, 13);
 USAMPLER2D(voxelTypeData, 14);
 USAMPLER2D(headerData, 15);
+USAMPLER2D(sceneBVHData, 12);
+USAMPLER2D(visibleChunkData, 11);
+USAMPLER2D(nodeColorData, 10);
 
 struct RayQuery {
     bool doTransparency = true;
     uint startLOD = 0;
     uint finishLOD = 0;
-    uint distanceToFinishLOD = 0; // Measured in voxels.
+    uint distanceToFinishLOD = 0; // Measured in voxels. Rays stop startLOD tree levels above the voxels at their origin and finishLOD levels at this distance, in chunks with node colors.
     uint maxRaySteps = 100;
 };
 
@@ -98,7 +107,8 @@ struct chunkHeader { // Not designed to be user interfacable on CPU. Only exists
     uint geometryEndIndex;
     uint voxelTypeDataStartIndex;
     uint voxelTypeDataEndIndex;
-    uint padding[2];
+    uint nodeColorStartIndex;
+    uint padding;
 };
 
 struct GPUChunkHeader { // Not designed to be user interfacable on CPU. Only exists during runtime, mainly on GPU. Only the necessary information for rendering.
@@ -112,7 +122,15 @@ struct GPUChunkHeader { // Not designed to be user interfacable on CPU. Only exi
     uint geometryEndIndex;
     uint voxelTypeDataStartIndex;
     uint voxelTypeDataEndIndex;
-    uint padding[2];
+    uint nodeColorStartIndex;
+    uint padding;
+};
+
+struct SceneBVHNode { // Same layout as GPUSceneBVHNode, see createGPUSceneBVH.
+    vec3 boundsMin;
+    uint skipIndex;
+    vec3 boundsMax;
+    uint headerIndex;
 };
 
 struct Voxel {
@@ -124,6 +142,8 @@ struct Voxel {
 struct SceneIntersectData {
     uint steps;
     uint headerIndex;
+    uint voxelAttributeIndex; // Only valid with VOXEL_ATTRIBUTE_INDEXING.
+    uint nodeColorIndex; // Node color of the node the ray stopped at above the voxels, NODE_COLOR_NONE for voxel hits.
     BoxAABB foundBox;
 };
 
@@ -232,6 +252,27 @@ float getRayBoxEntryDistance(Ray ray, BoxAABB box) {
     return tNear;
 }
 
+// Same as getRayBoxEntryDistance for bounds that aren't cubes.
+float getRayBoundsEntryDistance(Ray ray, vec3 boundsMin, vec3 boundsMax) {
+    if (all(greaterThanEqual(ray.origin, boundsMin)) &&
+        all(lessThanEqual(ray.origin, boundsMax))) {
+        return 0;
+    }
+
+    vec3 invDir = 1.0 / ray.direction;
+
+    vec3 t0 = (boundsMin - ray.origin) * invDir;
+    vec3 t1 = (boundsMax - ray.origin) * invDir;
+
+    float tNear = max(max(min(t0.x, t1.x), min(t0.y, t1.y)), min(t0.z, t1.z));
+    float tFar  = min(min(max(t0.x, t1.x), max(t0.y, t1.y)), max(t0.z, t1.z));
+
+    if (tNear > tFar || tFar < 0.0) {
+        return -1;
+    }
+    return tNear;
+}
+
 float getRayBoxEntryDistanceForSureHit(Ray ray, BoxAABB box) {
     vec3 boxMin = box.position;
     vec3 boxMax = box.position + vec3(box.size);
@@ -408,6 +449,16 @@ uint voxelTypeDatas(int index) {
     return pixel[colorIndex];
 }
 
+uint nodeColors(int index) {
+    ivec2 texSize = textureSize(nodeColorData, 0);
+    int pixelIndex = index / 4;
+    int x = pixelIndex % texSize.x;
+    int y = pixelIndex / texSize.x;
+    int colorIndex = index % 4;
+    uvec4 pixel = texelFetch(nodeColorData, ivec2(x, y), 0);
+    return pixel[colorIndex];
+}
+
 chunkHeader headers(int headerIndex) {  
     int index = headerIndex * 3;
 
@@ -426,8 +477,8 @@ chunkHeader headers(int headerIndex) {
     header.geometryEndIndex = pixel1.a;  
     header.voxelTypeDataStartIndex = pixel2.r;  
     header.voxelTypeDataEndIndex = pixel2.g;  
-    header.padding[0] = pixel2.b;
-    header.padding[1] = pixel2.a;
+    header.nodeColorStartIndex = pixel2.b;
+    header.padding = pixel2.a;
       
     return header;
 }
@@ -437,6 +488,21 @@ int headersLength() {
     return int(texSize.x / 3);
 }
 
+SceneBVHNode sceneBVHNodes(uint nodeIndex) {
+    int texWidth = textureSize(sceneBVHData, 0).x;
+    int texelIndex = int(nodeIndex) * 2;
+
+    uvec4 pixel0 = texelFetch(sceneBVHData, ivec2(texelIndex % texWidth, texelIndex / texWidth), 0);
+    uvec4 pixel1 = texelFetch(sceneBVHData, ivec2((texelIndex + 1) % texWidth, (texelIndex + 1) / texWidth), 0);
+
+    SceneBVHNode node;
+    node.boundsMin = uintBitsToFloat(pixel0.rgb);
+    node.skipIndex = pixel0.a;
+    node.boundsMax = uintBitsToFloat(pixel1.rgb);
+    node.headerIndex = pixel1.a;
+    return node;
+}
+
 //Returns a random float.
 float randomFloat0to1(vec2 uv, float timeX) {
     vec3 coords = vec3(uv * timeX, timeX);
@@ -819,8 +885,10 @@ ivec3 roundVoxelCoordinatesBasedOnNodeSize(ivec3 highResPosition, uint targetNod
     return nodeSpaceCoordinate << uint(log2(targetNodeSize)); // Could also be bit shift, targetNodeSize is always power of 4.
 }
 
-SceneIntersectData marchRayThroughTree64_DDA(Ray ray, RayQuery rayQuery, BoxAABB boundingBox, uint tree64StartIndex, uint tree64EndIndex, uint tree64Resolution) {
+// Nodes cutOffLevel levels above the voxels or higher are hit as a whole, nodeColorStartIndex is where the chunk's node colors start.
+SceneIntersectData marchRayThroughTree64_DDA(Ray ray, RayQuery rayQuery, BoxAABB boundingBox, uint tree64StartIndex, uint tree64EndIndex, uint tree64Resolution, uint cutOffLevel, uint nodeColorStartIndex) {
     SceneIntersectData returnData;
+    returnData.nodeColorIndex = NODE_COLOR_NONE;
     vec3 invRayDir = 1.0/ray.direction;
     // If res = 4, treeLevels = 1. In this case just the root node exists.
     // If res = 16, treeLevels = 2. In this case just the root node exists.
@@ -858,16 +926,25 @@ SceneIntersectData marchRayThroughTree64_DDA(Ray ray, RayQuery rayQuery, BoxAABB
                     returnData.foundBox.position = traversalPosition;
                     returnData.foundBox.size = stepSize;
                     returnData.steps = stepCount;
+                    returnData.voxelAttributeIndex = (data.data3 >> 1) + calculateSiblingsBeforeThisZOrder(4, data.data1, data.data2, nodeStack[nodeStackQuantity - 1u].thisNodeZOrderInParent);
                     return returnData;
                     // Leaf found! Handle accordingly.
                 }
+                uint childrenBeforeThisNode = calculateSiblingsBeforeThisZOrder(4, data.data1, data.data2, nodeStack[nodeStackQuantity - 1u].thisNodeZOrderInParent);
+                uint bottomChildPointer = (data.data3 >> 1) & 0b01111111111111111111111111111111;
+                uint parentDataIndex = nodeStack[nodeStackQuantity - 2u].dataIndex;
+                if (candidateNodeLevel <= cutOffLevel) {
+                    // The ray stops at this node instead of descending, the average color of the voxels below it stands in for them.
+                    returnData.foundBox.position = traversalPosition;
+                    returnData.foundBox.size = stepSize;
+                    returnData.steps = stepCount;
+                    returnData.nodeColorIndex = nodeColorStartIndex + bottomChildPointer + parentDataIndex + childrenBeforeThisNode - tree64StartIndex;
+                    return returnData;
+                }
                 BoxAABB candidateBox;
                 candidateBox.position = vec3(traversalPosition);
                 candidateBox.size = float(stepSize);
                 ivec3 highResPosition = determineTraversalCoordinatesFromRayAndBoxAndRayDistance(ray, candidateBox, rayT);
-                uint bottomChildPointer = (data.data3 >> 1) & 0b01111111111111111111111111111111;
-                uint parentDataIndex = nodeStack[nodeStackQuantity - 2u].dataIndex;
-                uint childrenBeforeThisNode = calculateSiblingsBeforeThisZOrder(4, data.data1, data.data2, nodeStack[nodeStackQuantity - 1u].thisNodeZOrderInParent);
                 nodeStack[nodeStackQuantity - 1u].dataIndex = bottomChildPointer + parentDataIndex + childrenBeforeThisNode;
                 nodeStack[nodeStackQuantity].thisNodeZOrderInParent = getZOrderInParentFromThisNodesLevel(highResPosition, candidateNodeLevel - 1); // off by 1 error?
                 nodeStack[nodeStackQuantity].dataIndex = 0;
@@ -940,6 +1017,7 @@ SceneIntersectData marchRayThroughTree64_DDA(Ray ray, RayQuery rayQuery, BoxAABB
                     returnData.foundBox.position = traversalPosition;
                     returnData.foundBox.size = stepSize;
                     returnData.steps = stepCount;
+                    returnData.voxelAttributeIndex = (data.data3 >> 1) + calculateSiblingsBeforeThisZOrder(4, data.data1, data.data2, nodeStack[nodeStackQuantity - 1u].thisNodeZOrderInParent);
                     return returnData;
                     // Leaf found, handle accordingly.
                 }
@@ -979,10 +1057,18 @@ SceneIntersectData castRayThroughTree64(Ray ray, RayQuery rayQuery, uint headerI
 
     IntersectionResult rootIntersect = getRayBoxEntry(transformedRay, tree64BoundingBox);
 
+    // The farther into the ray the chunk starts, the higher up the tree the ray stops. Chunks without node colors can't be shaded above their voxels.
+    uint cutOffLevel = 0u;
+    if(header.nodeColorStartIndex != NODE_COLOR_NONE) {
+        float LODBlend = rayQuery.distanceToFinishLOD == 0u ? 1.0 : clamp(rootIntersect.distance / float(rayQuery.distanceToFinishLOD), 0.0, 1.0);
+        cutOffLevel = uint(mix(float(rayQuery.startLOD), float(rayQuery.finishLOD), LODBlend));
+    }
+
     SceneIntersectData tree64Intersect;
     tree64Intersect.foundBox.size = -1;
+    tree64Intersect.nodeColorIndex = NODE_COLOR_NONE;
     if(rootIntersect.distance >= 0){
-        tree64Intersect = marchRayThroughTree64_DDA(transformedRay, rayQuery, tree64BoundingBox, tree64StartIndex, tree64EndIndex, header.resolution);
+        tree64Intersect = marchRayThroughTree64_DDA(transformedRay, rayQuery, tree64BoundingBox, tree64StartIndex, tree64EndIndex, header.resolution, cutOffLevel, header.nodeColorStartIndex);
     }
     // size should be 1 for full res, 2 for half res, 4 for quarter res etc. So we multiply the size by what the voxel scale actually is.
     tree64Intersect.foundBox.size *= header.scale/tree64BoundingBox.size;
@@ -1093,15 +1179,33 @@ uint findVoxelIndex(BoxAABB voxelBoundingBox, uint headerIndex){
     return voxelTypeDataIndex;
 }
 
-//Given the voxel index, return the voxel data.
-Voxel fetchVoxelData(BoxAABB voxelBoundingBox, uint headerIndex){
-    uint voxelIndex = findVoxelIndex(voxelBoundingBox, headerIndex);
+//Given the intersection, return the voxel data.
+Voxel fetchVoxelData(SceneIntersectData intersectHit){
+    uint headerIndex = intersectHit.headerIndex;
+    uint voxelTypeDataStartIndex = headers(headerIndex).voxelTypeDataStartIndex;
+    uint voxelIndex;
+    uint SerializedColor;
+    uint SerializedNormals;
+    if (intersectHit.nodeColorIndex != NODE_COLOR_NONE) {
+        // The ray stopped above the voxels, nodes only carry a color so far.
+        voxelIndex = intersectHit.nodeColorIndex;
+        SerializedColor = nodeColors(int(voxelIndex));
+        SerializedNormals = 0u;
+    } else {
+#if VOXEL_ATTRIBUTE_INDEXING
+        // The attribute index comes straight from the leaf's parent, no search needed.
+        voxelIndex = intersectHit.voxelAttributeIndex * VOXEL_ATTRIBUTE_SLICES;
+        SerializedColor = voxelTypeDatas(voxelIndex+voxelTypeDataStartIndex);
+        SerializedNormals = voxelTypeDatas(voxelIndex+1+voxelTypeDataStartIndex);
+#else
+        voxelIndex = findVoxelIndex(intersectHit.foundBox, headerIndex);
+        SerializedColor = voxelTypeDatas(voxelIndex+1+voxelTypeDataStartIndex);
+        SerializedNormals = voxelTypeDatas(voxelIndex+2+voxelTypeDataStartIndex);
+#endif
+    }
     //Assume 6-bit color channels ()
     //Assume 4-bit normal vector channels ()
-    uint voxelTypeDataStartIndex = headers(headerIndex).voxelTypeDataStartIndex;
     Voxel voxel;
-    uint SerializedColor = voxelTypeDatas(voxelIndex+1+voxelTypeDataStartIndex);
-    uint SerializedNormals = voxelTypeDatas(voxelIndex+2+voxelTypeDataStartIndex);
     uint R10 = (SerializedColor >> 20) & 0x3FF;
     uint G10 = (SerializedColor >> 10) & 0x3FF;
     uint B10 = (SerializedColor >> 00) & 0x3FF;
@@ -1120,28 +1224,75 @@ Voxel fetchVoxelData(BoxAABB voxelBoundingBox, uint headerIndex){
     return voxel;
 }
 
+// Casts the ray through one chunk and keeps the hit if it's closer than closestDistance.
+void intersectChunk(Ray ray, RayQuery rayQuery, int headerIndex, inout float closestDistance, inout SceneIntersectData sceneIntersect) {
+    BoxAABB tree64BoundingBox;
+    tree64BoundingBox.position = vec3(headers(headerIndex).positionX, headers(headerIndex).positionY, headers(headerIndex).positionZ);
+    tree64BoundingBox.size = headers(headerIndex).scale;
+    float tBB = getRayBoxEntryDistance(ray, tree64BoundingBox);
+    if(tBB < 0 || tBB >= closestDistance) return;
+
+    SceneIntersectData tree64Intersect = castRayThroughTree64(ray, rayQuery, headerIndex);
+    float intersectionDistance = getRayBoxEntryDistance(ray, tree64Intersect.foundBox);
+    if(tree64Intersect.foundBox.size > 0 && intersectionDistance > 0 && intersectionDistance < closestDistance){
+        sceneIntersect = tree64Intersect;
+        sceneIntersect.headerIndex = headerIndex;
+        closestDistance = intersectionDistance;
+    }
+}
+
 SceneIntersectData raySceneIntersect(Ray ray, RayQuery rayQuery) {
     float closestDistance = 100000000;
-    BoxAABB closestBox;
-    uint closestHeaderIndex = 0;
     SceneIntersectData sceneIntersect;
     sceneIntersect.foundBox.size = -1;
     sceneIntersect.steps = 0;
-    for(int i = 0; i < headersLength(); i++){ // HEADER_LENGTH should be headers.length();
-        BoxAABB tree64BoundingBox;
-        tree64BoundingBox.position = vec3(headers(i).positionX, headers(i).positionY, headers(i).positionZ);
-        tree64BoundingBox.size = headers(i).scale;
-        float tBB = getRayBoxEntryDistance(ray, tree64BoundingBox);
-        if(tBB < 0 || tBB >= closestDistance) continue;
-
-        SceneIntersectData tree64Intersect = castRayThroughTree64(ray, rayQuery, i);
-        float intersectionDistance = getRayBoxEntryDistance(ray, tree64Intersect.foundBox);
-        if(tree64Intersect.foundBox.size > 0 && intersectionDistance > 0 && intersectionDistance < closestDistance){
-            sceneIntersect = tree64Intersect;
-            sceneIntersect.headerIndex = i;
-            closestDistance = intersectionDistance;
+    sceneIntersect.nodeColorIndex = NODE_COLOR_NONE;
+#if SCENE_BVH_TRAVERSAL
+    // The nodes are stored depth first, so a hit inner node continues with the next node and everything else jumps to its skip index. No stack needed.
+    uint nodeIndex = 0u;
+    while(nodeIndex != SCENE_BVH_END) {
+        SceneBVHNode node = sceneBVHNodes(nodeIndex);
+        float tNode = getRayBoundsEntryDistance(ray, node.boundsMin, node.boundsMax);
+        if(tNode < 0 || tNode >= closestDistance) {
+            nodeIndex = node.skipIndex;
+            continue;
+        }
+        if(node.headerIndex == SCENE_BVH_END) {
+            nodeIndex += 1u;
+            continue;
         }
+        intersectChunk(ray, rayQuery, int(node.headerIndex), closestDistance, sceneIntersect);
+        nodeIndex = node.skipIndex;
     }
+#else
+    for(int i = 0; i < headersLength(); i++){ // HEADER_LENGTH should be headers.length();
+        intersectChunk(ray, rayQuery, i, closestDistance, sceneIntersect);
+    }
+#endif
     return sceneIntersect;
 }
 
+// Only for rays starting at the camera the list was made for, other rays can hit chunks outside of the view. The list is sorted by the distance
+// from the camera to each chunk, which no ray from the camera can enter a chunk before, so the walk ends at the first chunk past the closest hit.
+SceneIntersectData rayVisibleChunksIntersect(Ray ray, RayQuery rayQuery) {
+#if VISIBLE_CHUNK_LIST
+    float closestDistance = 100000000;
+    SceneIntersectData sceneIntersect;
+    sceneIntersect.foundBox.size = -1;
+    sceneIntersect.steps = 0;
+    sceneIntersect.nodeColorIndex = NODE_COLOR_NONE;
+    int texWidth = textureSize(visibleChunkData, 0).x;
+    uint visibleChunkCount = texelFetch(visibleChunkData, ivec2(0, 0), 0).r;
+    for(uint i = 0u; i < visibleChunkCount; i++) {
+        int texelIndex = int(i) + 1;
+        uvec4 visibleChunk = texelFetch(visibleChunkData, ivec2(texelIndex % texWidth, texelIndex / texWidth), 0);
+        if(uintBitsToFloat(visibleChunk.g) >= closestDistance) {
+            break;
+        }
+        intersectChunk(ray, rayQuery, int(visibleChunk.r), closestDistance, sceneIntersect);
+    }
+    return sceneIntersect;
+#else
+    return raySceneIntersect(ray, rayQuery);
+#endif
+}
@@ -0,0 +1,122 @@
+// ProjectV Tree64 Layout Benchmark
+// Compares the node orders of reorderTree64 on the chunks of a pre-voxelized scene. Every chunk is stored
+// breadth first (as createTree64 writes it), depth first and in van Emde Boas treelets, then the same
+// incoherent secondary rays are cast through each copy. It prints the simulated cache misses of the node
+// reads and the measured single threaded traversal time, so layout changes can be judged by numbers.
+//
+// Usage:
+//   ./main.o [-s <scene-directory>] [-c <chunks>] [-r <rays-per-chunk>] [-k <cache-KiB>] [-i <iterations>]
+//
+// ProjectV Engine Features Used:
+//   - Core Math       : vec3, normalize, dot — generating the rays
+//   - Logging         : info/error via spdlog wrapper for structured output
+//   - Voxel I/O       : loadSceneFromDisk — deserializes the chunked voxel scene from disk
+//   - Tree64 Raycast  : castRayThroughTree64, castRaysThroughTree64 — finds the bounce points and times traversal
+//   - Tree64 Layout   : reorderTree64, measureTree64CacheMisses — reorders the nodes and simulates the cache
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/voxel_io.h"
+#include "utils/tree64_raycast.h"
+#include "utils/tree64_layout.h"
+
+// Rays leaving random surface points in random directions, like the bounce rays of a path tracer.
+std::vector<projv::Ray> createSecondaryRays(const projv::Chunk& chunk, size_t rayCount, std::mt19937& random) {
+    float resolution = float(chunk.header.resolution);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<projv::Ray> rays;
+    for (size_t attempt = 0; rays.size() < rayCount && attempt < rayCount * 16; attempt++) {
+        projv::Ray primaryRay;
+        primaryRay.origin = projv::core::vec3(unit(random), unit(random), unit(random)) * resolution;
+        primaryRay.direction = projv::core::normalize(projv::core::vec3(unit(random), unit(random), unit(random)) - 0.5f);
+        projv::RayHit hit = projv::utils::castRayThroughTree64(chunk.geometryData, chunk.voxelTypeData, int(chunk.header.resolution), primaryRay);
+        if (!hit.hit) {
+            continue;
+        }
+        projv::core::vec3 normal = projv::core::vec3(hit.normal);
+        projv::core::vec3 direction = projv::core::normalize(projv::core::vec3(unit(random), unit(random), unit(random)) - 0.5f);
+        if (projv::core::dot(direction, normal) < 0.0f) {
+            direction = -direction;
+        }
+        rays.push_back({primaryRay.origin + primaryRay.direction * hit.distance + normal * 1e-3f, direction});
+    }
+    return rays;
+}
+
+int main(int argc, char** argv) {
+    std::string sceneDirectory = "../PathTracer/SponzaScene/";
+    size_t chunkCount = 8;
+    size_t raysPerChunk = 100000;
+    int iterations = 5;
+    projv::Tree64CacheSettings cacheSettings;
+
+    for (int i = 1; i < argc; i++) {
+        auto has = [&](int count) { return i + count < argc; };
+        if (!strcmp(argv[i], "-s") && has(1)) { sceneDirectory = argv[++i]; }
+        else if (!strcmp(argv[i], "-c") && has(1)) { chunkCount = size_t(atoi(argv[++i])); }
+        else if (!strcmp(argv[i], "-r") && has(1)) { raysPerChunk = size_t(atoi(argv[++i])); }
+        else if (!strcmp(argv[i], "-k") && has(1)) { cacheSettings.cacheSize = size_t(atoi(argv[++i])) * 1024; }
+        else if (!strcmp(argv[i], "-i") && has(1)) { iterations = std::max(1, atoi(argv[++i])); }
+        else {
+            projv::core::error("Unknown or incomplete argument: {}", argv[i]);
+            return 1;
+        }
+    }
+
+    // The biggest chunks put the most pressure on the cache. Only chunks with a single root can be reordered and ray cast.
+    projv::Scene scene = projv::utils::loadSceneFromDisk(sceneDirectory);
+    std::vector<const projv::Chunk*> chunks;
+    for (const projv::Chunk& chunk : scene.chunks) {
+        if (!chunk.geometryData.empty() && projv::utils::hasSingleTree64Root(int(chunk.header.resolution))) {
+            chunks.push_back(&chunk);
+        }
+    }
+    std::sort(chunks.begin(), chunks.end(), [](const projv::Chunk* a, const projv::Chunk* b) { return a->geometryData.size() > b->geometryData.size(); });
+    chunks.resize(std::min(chunks.size(), chunkCount));
+
+    const projv::Tree64NodeOrder orders[] = {projv::Tree64NodeOrder::BreadthFirst, projv::Tree64NodeOrder::DepthFirst, projv::Tree64NodeOrder::VanEmdeBoas};
+    const char* orderNames[] = {"breadth first", "depth first", "van Emde Boas"};
+    size_t totalRays = 0;
+    size_t totalMisses[3] = {};
+    size_t totalLineReads[3] = {};
+    double totalMilliseconds[3] = {};
+    std::mt19937 random(1);
+    for (const projv::Chunk* chunk : chunks) {
+        std::vector<projv::Ray> rays = createSecondaryRays(*chunk, raysPerChunk, random);
+        std::vector<projv::RayHit> hits(rays.size());
+        totalRays += rays.size();
+        for (int order = 0; order < 3; order++) {
+            std::vector<uint32_t> tree64 = projv::utils::reorderTree64(chunk->geometryData, orders[order]);
+            projv::Tree64CacheStatistics statistics = projv::utils::measureTree64CacheMisses(tree64, chunk->voxelTypeData, int(chunk->header.resolution), rays.data(), rays.size(), cacheSettings);
+            totalMisses[order] += statistics.cacheMisses;
+            totalLineReads[order] += statistics.lineReads;
+
+            // The fastest of a few runs, so other work on the machine doesn't skew the comparison.
+            double fastest = INFINITY;
+            for (int iteration = 0; iteration < iterations; iteration++) {
+                auto start = std::chrono::high_resolution_clock::now();
+                projv::utils::castRaysThroughTree64(tree64, chunk->voxelTypeData, int(chunk->header.resolution), rays.data(), hits.data(), rays.size(), projv::utils::DEFAULT_MAX_RAY_STEPS, 1);
+                auto end = std::chrono::high_resolution_clock::now();
+                fastest = std::min(fastest, std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            totalMilliseconds[order] += fastest;
+            projv::core::info("Chunk {} ({} nodes), {}: {:.2f} misses per ray, {:.2f}ms", chunk->header.chunkID, tree64.size() / 3, orderNames[order], statistics.missesPerRay, fastest);
+        }
+    }
+
+    projv::core::info("{} rays through {} chunks, {} KiB {}-way cache with {} byte lines:", totalRays, chunks.size(), cacheSettings.cacheSize / 1024, cacheSettings.associativity, cacheSettings.lineSize);
+    for (int order = 0; order < 3; order++) {
+        projv::core::info("  {:>14}: {:.2f} misses per ray ({:.1f}% of line reads), {:.1f} Mrays/s", orderNames[order], double(totalMisses[order]) / double(std::max<size_t>(totalRays, 1)),
+                          100.0 * double(totalMisses[order]) / double(std::max<size_t>(totalLineReads[order], 1)), double(totalRays) / (totalMilliseconds[order] * 1000.0));
+    }
+    return 0;
+}
@@ -62,6 +62,7 @@ namespace projv::core {
     using glm::log2;
 
     using glm::lookAt;
+    using glm::perspective;
     inline mat4 projectionMatrix(float fovy, float aspect, float nearPlane, float farPlane, bool homogeneousDepth) {
         float out[16];
         bx::mtxProj(out, fovy, aspect, nearPlane, farPlane, homogeneousDepth);
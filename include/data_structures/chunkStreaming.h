@@ -0,0 +1,35 @@
+#ifndef CHUNK_STREAMING_H
+#define CHUNK_STREAMING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace projv {
+    /**
+     * @brief Settings of a ChunkStreamer.
+     * @struct ChunkStreamingSettings
+     */
+    struct ChunkStreamingSettings {
+        float loadDistance = 512.0f; // Chunks whose bounds come closer than this to the camera's predicted path are loaded, in world units.
+        float predictionTime = 1.0f; // Seconds of camera movement at its current velocity that loading looks ahead.
+        size_t ramBudget = size_t(1) << 30; // Bytes of chunk data kept in RAM.
+        size_t gpuBudget = size_t(512) << 20; // Bytes the resident chunks take up in the GPU textures (see createTexturesForScene).
+        uint32_t threadCount = 2; // Background threads reading chunks from disk.
+        uint32_t maxQueuedChunks = 16; // Chunks waiting to be read at once. Fewer lets a moving camera change the order sooner.
+    };
+
+    /**
+     * @brief What a ChunkStreamer holds and has done. Only exists during runtime.
+     * @struct ChunkStreamingStatistics
+     */
+    struct ChunkStreamingStatistics {
+        size_t residentChunks;
+        size_t loadingChunks; // Queued or being read.
+        size_t residentRAMBytes;
+        size_t residentGPUBytes;
+        size_t loadedChunks; // Since the streamer was created.
+        size_t evictedChunks; // Since the streamer was created.
+    };
+}
+
+#endif
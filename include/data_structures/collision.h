@@ -0,0 +1,48 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <stdint.h>
+#include "core/math.h"
+
+namespace projv {
+    /**
+     * @brief The result of sweeping a box or capsule through voxels.
+     * @struct SweepHit
+     */
+    struct SweepHit {
+        bool hit;
+        float time; // Fraction of the displacement (0-1) the shape can move before it touches the voxel, 1 when nothing is hit.
+        core::vec3 normal; // Contact normal pointing out of the voxel. When the shape starts inside, the direction that gets it out the quickest, (0, 0, 0) if there is none.
+        bool startsInside; // The shape already overlaps the voxel before moving, time is 0.
+        uint32_t chunkIndex; // Index of the hit chunk in Scene::chunks.
+        core::ivec3 voxelPosition; // Position of the hit voxel in the chunk's grid.
+        uint32_t ZOrder; // Z-Order of the hit voxel.
+    };
+
+    /**
+     * @brief Places a tree64 in the world. A position p in its grid ends up at position + rotation * (p * scale / resolution),
+     * so position and scale mean the same as in ChunkHeader and the rotation turns the object around its minimum corner.
+     * @struct VoxelObjectTransform
+     */
+    struct VoxelObjectTransform {
+        core::vec3 position;
+        core::mat3 rotation; // Must be a pure rotation (orthonormal, determinant 1).
+        float scale;
+    };
+
+    /**
+     * @brief Two overlapping voxels of different objects, found by findOverlappingVoxelsTree64.
+     * @struct VoxelOverlapPair
+     */
+    struct VoxelOverlapPair {
+        core::ivec3 voxelA; // Position of the voxel in the first object's grid.
+        uint32_t ZOrderA;
+        core::ivec3 voxelB; // Position of the voxel in the second object's grid.
+        uint32_t ZOrderB;
+        core::vec3 contactPoint; // World space, halfway between the centers of the two voxels.
+        core::vec3 normal; // World space, the direction that moves the first voxel out of the second the quickest.
+        float depth; // How far the first voxel has to move along the normal to stop overlapping, in world units.
+    };
+}
+
+#endif
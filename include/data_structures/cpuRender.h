@@ -0,0 +1,40 @@
+#ifndef CPU_RENDER_H
+#define CPU_RENDER_H
+
+#include <stdint.h>
+#include <vector>
+#include "core/math.h"
+
+namespace projv {
+    /**
+     * @brief Settings for rendering a scene on the CPU. The lighting defaults match path_trace.frag.
+     * @struct CPURenderSettings
+     */
+    struct CPURenderSettings {
+        int width = 512;
+        int height = 512;
+        float fov = 60.0f; // Vertical field of view in degrees.
+        uint32_t samplesPerPixel = 16;
+        uint32_t bounces = 1; // Bounces after the primary hit, each one lit by the sun and the sky.
+        uint32_t maxRaySteps = 1024; // Empty cells a ray may step through in each chunk before it counts as a miss.
+        int tileSize = 32; // Width and height of the tiles the image is split into for the worker threads.
+        int threadCount = 0; // 0 uses every hardware thread.
+        uint32_t seed = 0; // Renders with the same seed and settings give identical images.
+        core::vec3 sunDirection = core::normalize(core::vec3(-0.5f, 0.9f, 0.6f));
+        core::vec3 sunRadiance = core::vec3(1.0f, 0.8f, 0.4f) * 19000.0f;
+        core::vec3 skyRadiance = core::vec3(0.3f, 0.45f, 0.9f) * 9.0f;
+        float maxSampleRadiance = 5.0f; // Samples are clamped to this before being averaged, like accumulate.frag does.
+    };
+
+    /**
+     * @brief An image rendered on the CPU.
+     * @struct CPUImage
+     */
+    struct CPUImage {
+        int width = 0;
+        int height = 0;
+        std::vector<float> pixels; // Linear RGB radiance, 3 floats per pixel, the first row is the top of the image.
+    };
+}
+
+#endif
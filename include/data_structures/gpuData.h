@@ -8,10 +8,18 @@ namespace projv {
         bgfx::TextureHandle tree64Texture;
         bgfx::TextureHandle voxelTypeDataTexture;
         bgfx::TextureHandle headerTexture;
+        bgfx::TextureHandle sceneBVHTexture;
+        bgfx::TextureHandle visibleChunkTexture;
+        bgfx::TextureHandle nodeColorTexture;
 
         bgfx::UniformHandle tree64Sampler;
         bgfx::UniformHandle voxelTypeDataSampler;
         bgfx::UniformHandle headerSampler;
+        bgfx::UniformHandle sceneBVHSampler;
+        bgfx::UniformHandle visibleChunkSampler;
+        bgfx::UniformHandle nodeColorSampler;
+
+        uint32_t visibleChunkCapacity; // Number of chunks visibleChunkTexture has room for, the chunk count of the uploaded scene.
     };
 }
 
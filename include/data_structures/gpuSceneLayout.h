@@ -0,0 +1,82 @@
+#ifndef GPU_SCENE_LAYOUT_H
+#define GPU_SCENE_LAYOUT_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "data_structures/scene.h"
+
+namespace projv {
+    constexpr uint32_t GPU_SCENE_TEXTURE_COUNT = 3;
+
+    enum class GPUSceneTexture { // The persistent RGBA32U textures chunk data is placed in. Values index GPUSceneLayout::allocators.
+        Tree64 = 0, // One node per texel, the alpha channel is unused.
+        VoxelTypeData = 1, // 4 uint32_t's per texel.
+        NodeColor = 2 // 4 uint32_t's per texel.
+    };
+
+    struct TexelRange { // Texels of a row-major texture, counted from its top left texel.
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct TextureRectangle { // The part of a TexelRange in one rectangle of its texture, what a single bgfx::updateTexture2D writes.
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+        uint32_t firstTexel; // Texels of the range before this rectangle.
+    };
+
+    struct TexelAllocator { // Only exists during runtime. A free list over the texels of a texture.
+        uint32_t capacity = 0;
+        std::map<uint32_t, uint32_t> freeBlocks; // First texel -> texel count. Neighbouring free blocks are always merged.
+        std::unordered_map<uint32_t, uint32_t> allocations; // First texel -> texel count.
+    };
+
+    /**
+     * @brief Settings of a GPUSceneLayout.
+     * @struct GPUSceneLayoutSettings
+     */
+    struct GPUSceneLayoutSettings {
+        uint32_t textureWidth = 4096; // Texels per row of every scene texture. Must not be above the GPU's maxTextureSize.
+        uint32_t initialTextureRows = 64; // Rows each texture starts with. Textures double their rows when a chunk doesn't fit.
+        uint32_t maxTextureRows = 4096; // Rows a texture may grow to, lowered to the GPU's maxTextureSize when the textures are created.
+        bool implicitVoxelAttributes = false; // Whether to place the implicit attribute layout (see addAttributeOffsetsTree64) instead of voxelTypeData. The shader's VOXEL_ATTRIBUTE_INDEXING must match.
+    };
+
+    struct GPUChunkPlacement { // Only exists during runtime. Where a chunk's data is in the scene textures and which data it was.
+        std::array<TexelRange, GPU_SCENE_TEXTURE_COUNT> ranges; // Empty ranges aren't allocated.
+        uint32_t LOD;
+        uint64_t revision; // The chunk's revision (Chunk::revision) when it was placed, a different one means its data changed.
+        std::array<size_t, GPU_SCENE_TEXTURE_COUNT> valueCounts;
+    };
+
+    struct GPUSceneLayout { // Only exists during runtime. The CPU side bookkeeping of the persistent scene textures, see updateGPUSceneLayout.
+        GPUSceneLayoutSettings settings;
+        std::array<TexelAllocator, GPU_SCENE_TEXTURE_COUNT> allocators; // Each allocator's capacity is the rows of its texture times settings.textureWidth.
+        std::unordered_map<uint32_t, GPUChunkPlacement> placements; // chunkID -> placement.
+        std::unordered_set<uint32_t> changedChunkIDs; // Chunks marked with markGPUChunkChanged since the last update.
+        std::vector<GPUChunkHeader> headers; // In the order of Scene::chunks at the last update.
+    };
+
+    struct GPUTextureWrite { // Texels of a scene texture that have to be uploaded from a chunk's data.
+        GPUSceneTexture texture;
+        uint32_t chunkIndex; // Index of the chunk in Scene::chunks.
+        TexelRange range;
+    };
+
+    struct GPUSceneLayoutUpdate { // What updateGPUSceneLayout changed, and so what has to be uploaded.
+        std::vector<GPUTextureWrite> writes;
+        std::array<bool, GPU_SCENE_TEXTURE_COUNT> resizedTextures; // The texture has to be created again with the new rows. The writes then cover every chunk in it.
+        bool headerCountChanged; // The header texture has to be created again and every header uploaded.
+        TexelRange changedHeaders; // In headers, not texels. Empty if no header changed.
+    };
+}
+
+#endif
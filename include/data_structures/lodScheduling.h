@@ -0,0 +1,33 @@
+#ifndef LOD_SCHEDULING_H
+#define LOD_SCHEDULING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace projv {
+    /**
+     * @brief Settings of a LODScheduler.
+     * @struct LODSchedulerSettings
+     */
+    struct LODSchedulerSettings {
+        float pixelsPerVoxel = 1.0f; // Chunks are lowered until their voxels cover about this many pixels of the screen.
+        float hysteresis = 0.25f; // How far past a LOD boundary (in LODs) a chunk must move before it changes, so chunks near a boundary don't flicker.
+        uint32_t maxLOD = 3; // The lowest detail any chunk is lowered to. Chunks also keep at least one tree64 level.
+        float transitionTimeBudget = 4.0f; // Milliseconds per frame the threads may spend on LOD changes. Spending more is paid back the next frames.
+        uint32_t threadCount = 2; // Background threads changing LODs.
+        uint32_t maxQueuedTransitions = 4; // LOD changes waiting for a thread at once. Each holds a copy of its chunk.
+    };
+
+    /**
+     * @brief What a LODScheduler has done. Only exists during runtime.
+     * @struct LODSchedulerStatistics
+     */
+    struct LODSchedulerStatistics {
+        size_t pendingTransitions; // Queued or running.
+        size_t completedTransitions; // Swapped into the scene since the scheduler was created.
+        size_t discardedTransitions; // Finished for a chunk that had changed LOD or left the scene in the meantime.
+        float transitionMilliseconds; // Thread time spent on LOD changes since the last update.
+    };
+}
+
+#endif
@@ -2,6 +2,9 @@
 #define NODE_STRUCTURE_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <vector>
 
 namespace projv{
     struct nodeStructure {
@@ -15,6 +18,62 @@ namespace projv{
         uint32_t pointerAndLeafFlag; // 31 bits for pointer, rightmost bit for leaf flag.
         uint32_t ZOrderIndex;
     };
+
+    // A 32 bit Z-Order holds at most 5 levels of 6 bits each.
+    constexpr int MAX_TREE64_LEVELS = 5;
+
+    struct Tree64Path { // The nodes from the root down to a cell of a tree64, kept between lookups so nearby cells start from a shared ancestor (see descendTree64Path).
+        std::array<uint32_t, MAX_TREE64_LEVELS> nodes = {}; // Index of the node at each depth, nodes[0] is the root.
+        int depth = 0; // Nodes up to and including this depth are valid.
+        uint32_t ZOrder = 0; // Z-Order of the cell the nodes were found for.
+    };
+
+    struct Tree64Layout { // Node counts of every level of a tree64, measured before it is written.
+        int levelsOfDepth;
+        std::array<size_t, MAX_TREE64_LEVELS + 1> levelNodeCounts; // Index 1 is the parents of the leaves, index levelsOfDepth is the root level.
+        size_t nodeCount;
+    };
+
+    struct Tree64DAG { // A tree64 with identical subtrees merged, see createTree64DAG.
+        std::vector<uint32_t> geometryData; // Same node format as a tree64, sibling blocks may be shared by several parents.
+        size_t treeNodeCount; // Nodes in the source tree64.
+        size_t uniqueNodeCount; // Distinct subtrees found.
+        size_t dagNodeCount; // Nodes actually stored in geometryData.
+        float compressionRatio; // treeNodeCount / dagNodeCount.
+    };
+
+    enum class Tree64NodeOrder { // How the nodes of a serialized tree64 are ordered, see reorderTree64. Children are always stored after their parent.
+        BreadthFirst, // Level by level from the root down, as createTree64 writes them. In place edits and LOD changes need this order.
+        DepthFirst, // Every block of siblings is followed by the subtrees of its nodes, so a walk to a leaf mostly reads nearby nodes.
+        VanEmdeBoas // The top half of the levels is stored as one treelet, followed by the treelets of the bottom half, recursively.
+    };
+
+    struct Tree64CacheSettings { // The cache measureTree64CacheMisses simulates.
+        size_t cacheSize = 32768; // In bytes, 32 KiB is a typical L1 data cache.
+        size_t lineSize = 64; // In bytes.
+        size_t associativity = 8; // Lines per set, the least recently used line of a set is evicted.
+    };
+
+    struct Tree64CacheStatistics { // Memory traffic of casting rays through a tree64, see measureTree64CacheMisses.
+        size_t rayCount;
+        size_t nodeReads; // Nodes read by all rays together.
+        size_t lineReads; // Cache lines touched by those reads, a 12 byte node can straddle two lines.
+        size_t cacheMisses; // Lines that weren't in the simulated cache.
+        float missesPerRay;
+        float missRate; // cacheMisses / lineReads.
+    };
+
+    enum class Tree64CSGOperation { // Boolean operation applied by applyCSGToTree64.
+        Union, // Voxels in either tree.
+        Subtract, // Voxels in tree A that aren't in tree B.
+        Intersect // Voxels in both trees.
+    };
+
+    struct Tree64CSGResult { // The output of applyCSGToTree64.
+        std::vector<uint32_t> geometryData; // The combined tree64, empty when no voxels are left.
+        std::vector<uint32_t> voxelTypeData; // The matching voxelTypeData, sorted by Z-Order.
+        size_t visitedNodeCount; // Node pairs walked, pruned subtrees are never visited.
+    };
 }
 
 #endif
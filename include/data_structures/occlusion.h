@@ -0,0 +1,41 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <stdint.h>
+#include <vector>
+#include "core/math.h"
+
+namespace projv {
+    /**
+     * @brief A box in world space that is completely solid, so anything behind it is hidden. See findChunkOccluders.
+     * @struct OccluderBox
+     */
+    struct OccluderBox {
+        core::vec3 boundsMin;
+        core::vec3 boundsMax;
+    };
+
+    /**
+     * @brief A low resolution depth buffer the occluders are drawn into on the CPU. Only exists during runtime.
+     * @struct OcclusionBuffer
+     */
+    struct OcclusionBuffer {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth; // Normalized device depth (z / w), row by row. Larger is farther, infinity where nothing was drawn.
+        core::mat4 viewProjection;
+        core::vec3 cameraPosition;
+    };
+
+    /**
+     * @brief Settings of removeOccludedChunks.
+     * @struct OcclusionCullingSettings
+     */
+    struct OcclusionCullingSettings {
+        int width = 256; // Resolution of the occlusion buffer.
+        int height = 128;
+        uint32_t occluderChunks = 16; // How many of the nearest visible chunks draw their occluders.
+    };
+}
+
+#endif
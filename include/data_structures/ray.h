@@ -0,0 +1,43 @@
+#ifndef RAY_H
+#define RAY_H
+
+#include <stdint.h>
+#include "core/math.h"
+
+namespace projv {
+    /**
+     * @brief A ray cast on the CPU. The direction doesn't have to be normalized, distances along the ray are measured in multiples of it.
+     * @struct Ray
+     */
+    struct Ray {
+        core::vec3 origin;
+        core::vec3 direction;
+    };
+
+    /**
+     * @brief The result of casting a Ray through a tree64.
+     * @struct RayHit
+     */
+    struct RayHit {
+        bool hit;
+        float distance; // Distance along the ray to where it enters the hit voxel.
+        core::ivec3 voxelPosition; // Position of the hit voxel in the tree64's grid.
+        uint32_t ZOrder; // Z-Order of the hit voxel.
+        core::ivec3 normal; // Normal of the face the ray entered the voxel through, (0, 0, 0) when the ray starts inside of it.
+        uint32_t voxelTypeDataIndex; // Index of the voxel in voxelTypeData (in voxels, not uint32_t's), UINT32_MAX when it isn't there.
+        uint32_t nodeIndex; // Index of the hit node when the ray stopped above the voxels (castRayThroughTree64AtLOD), its node color is the hit's color. UINT32_MAX for voxel hits.
+        uint32_t steps; // Empty cells the ray stepped through.
+    };
+
+    /**
+     * @brief The result of casting a Ray through a scene.
+     * @struct SceneRayHit
+     */
+    struct SceneRayHit {
+        RayHit voxelHit; // The hit inside the chunk, with its distance in world space.
+        uint32_t chunkIndex; // Index of the hit chunk in Scene::chunks.
+        uint32_t chunksTested; // Chunks the ray was cast through.
+    };
+}
+
+#endif
@@ -28,7 +28,8 @@ namespace projv{
         uint32_t geometryEndIndex;
         uint32_t voxelTypeDataStartIndex;
         uint32_t voxelTypeDataEndIndex;
-        uint32_t padding[2];
+        uint32_t nodeColorStartIndex; // Index of the chunk's first node color, UINT32_MAX if the chunk has none and can't be cut off above its voxels.
+        uint32_t padding;
     };
     #pragma pack(pop)
     
@@ -36,8 +37,10 @@ namespace projv{
         ChunkHeader header;
         std::vector<uint32_t> geometryData;
         std::vector<uint32_t> voxelTypeData;
+        std::vector<uint32_t> nodeColorData; // Optional average color of every node of geometryData (createTree64NodeColors), for traversals that stop above the voxels. Empty if not computed.
         VoxelBatch chunkQueue;
         uint32_t LOD;
+        uint64_t revision = 0; // Changes every time the utils functions change the chunk's data (bumpChunkRevision), so copies of it know they are outdated.
     };
     
     struct Scene {
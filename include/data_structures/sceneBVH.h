@@ -0,0 +1,50 @@
+#ifndef SCENE_BVH_H
+#define SCENE_BVH_H
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "core/math.h"
+
+namespace projv {
+    constexpr uint32_t SCENE_BVH_END = 0xFFFFFFFF; // Marks the end of the traversal and inner nodes in GPUSceneBVHNode.
+
+    struct SceneBVHNode { // Only exists during runtime. A node of the CPU side tree over the chunks of a scene.
+        core::vec3 boundsMin;
+        core::vec3 boundsMax;
+        int parent; // -1 for the root.
+        int left; // -1 for leaves.
+        int right; // -1 for leaves.
+        uint32_t chunkID; // Only used by leaves.
+        uint32_t chunkIndex; // Index of the chunk in Scene::chunks (and of its header on the GPU), only used by leaves.
+    };
+
+    struct SceneBVH { // Only exists during runtime. A bounding volume hierarchy over the chunk bounds of a scene, with one chunk per leaf.
+        std::vector<SceneBVHNode> nodes; // Includes unused nodes, see freeNodes.
+        std::vector<int> freeNodes; // Unused entries of nodes, reused by the next insertion.
+        int root = -1; // -1 when the scene has no chunks.
+        std::unordered_map<uint32_t, int> leafOfChunk; // chunkID -> leaf node.
+    };
+
+    #pragma pack(push, 1)
+    struct GPUSceneBVHNode { // Not designed to be user interfacable on CPU. Depth first, so a hit inner node continues with the next node. 2 RGBA32U texels.
+        float minX;
+        float minY;
+        float minZ;
+        uint32_t skipIndex; // Node to continue with when this node is missed or done, SCENE_BVH_END after the last one.
+        float maxX;
+        float maxY;
+        float maxZ;
+        uint32_t headerIndex; // Chunk header of a leaf, SCENE_BVH_END for inner nodes.
+    };
+
+    struct GPUVisibleChunk { // Not designed to be user interfacable on CPU. An entry of the front to back list of chunks in view, see createVisibleChunkList. 1 RGBA32U texel.
+        uint32_t headerIndex;
+        float distance; // Distance from the camera to the chunk's bounds, 0 when the camera is inside. No ray from the camera enters the chunk any closer.
+        uint32_t padding[2];
+    };
+    #pragma pack(pop)
+}
+
+#endif
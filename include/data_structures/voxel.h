@@ -20,6 +20,21 @@ namespace projv{
     };
 
     using VoxelBatch = std::vector<Voxel>;
+
+    // Which batch's color is kept when both batches of a set operation contain a voxel at the same position.
+    enum class VoxelColorPrecedence {
+        KeepA,
+        KeepB
+    };
+
+    /**
+     * @brief A VoxelBatch stored as columns. Passes that only need positions (moving, sorting keys, removing) don't touch the colors.
+     * @struct ColumnarVoxelBatch
+     */
+    struct ColumnarVoxelBatch {
+        std::vector<uint32_t> ZOrderPositions;
+        std::vector<Color> colors; // Same length as ZOrderPositions.
+    };
 }
 
 #endif
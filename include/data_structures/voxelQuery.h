@@ -0,0 +1,35 @@
+#ifndef VOXEL_QUERY_H
+#define VOXEL_QUERY_H
+
+#include <stdint.h>
+#include "core/math.h"
+#include "data_structures/color.h"
+#include "data_structures/nodeStructure.h"
+
+namespace projv {
+    /**
+     * @brief Remembers where the previous point query ended, so the next one can skip the chunk lookup and start below the root.
+     * Reset it (cursor = VoxelQueryCursor()) after chunks were edited, added or removed.
+     * @struct VoxelQueryCursor
+     */
+    struct VoxelQueryCursor {
+        uint32_t chunkIndex = UINT32_MAX; // Chunk of the previous query, it is tried before the SceneBVH.
+        int levelsOfDepth = 0; // Levels of that chunk's tree64.
+        Tree64Path path; // Nodes down to the previous query's cell in that chunk.
+    };
+
+    /**
+     * @brief The result of a point query.
+     * @struct VoxelQueryResult
+     */
+    struct VoxelQueryResult {
+        bool solid;
+        uint32_t chunkIndex; // Index of the chunk in Scene::chunks, UINT32_MAX when no chunk contains the position.
+        core::ivec3 voxelPosition; // Position of the voxel in the chunk's grid.
+        uint32_t ZOrder; // Z-Order of the voxel in the chunk.
+        uint32_t voxelTypeDataIndex; // Index of the voxel in voxelTypeData (in voxels, not uint32_t's), UINT32_MAX when it isn't solid or isn't there.
+        Color color; // Black when voxelTypeDataIndex is UINT32_MAX.
+    };
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef VOXEL_REGION_H
+#define VOXEL_REGION_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "core/math.h"
+
+namespace projv {
+    enum class VoxelRegionShape {
+        Box,
+        Sphere,
+        Frustum
+    };
+
+    // How a box lies relative to a VoxelRegion, see classifyBoundsInVoxelRegion.
+    enum class VoxelRegionOverlap {
+        Outside,
+        Partial,
+        Inside
+    };
+
+    /**
+     * @brief A region of space to enumerate voxels in, create it with createBoxVoxelRegion, createSphereVoxelRegion or createFrustumVoxelRegion.
+     * @struct VoxelRegion
+     */
+    struct VoxelRegion {
+        VoxelRegionShape shape;
+        core::vec3 boundsMin; // Box corners.
+        core::vec3 boundsMax;
+        core::vec3 center; // Sphere center and radius.
+        float radius;
+        std::array<core::vec4, 6> planes; // Frustum planes facing inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0 for all of them.
+    };
+
+    /**
+     * @brief The cells of one chunk found by findVoxelsInRegion.
+     * @struct ChunkRegionCells
+     */
+    struct ChunkRegionCells {
+        uint32_t chunkIndex; // Index of the chunk in Scene::chunks.
+        std::vector<uint32_t> ZOrders; // Z-Orders of the cells at the queried level, ascending.
+    };
+}
+
+#endif
@@ -4,12 +4,17 @@
 #include <vector>
 #include <iostream>
 #include <type_traits>
+#include <array>
 
 #include "data_structures/constructedRenderer.h"
 #include "data_structures/gpuData.h"
 #include "data_structures/scene.h"
+#include "data_structures/gpuSceneLayout.h"
 
 #include "core/log.h"
+#include "utils/voxel_management.h"
+#include "utils/scene_bvh.h"
+#include "utils/gpu_scene_layout.h"
 
 #include "bgfx/bgfx.h"
 
@@ -67,7 +72,7 @@ namespace projv::graphics {
 
     /**
      * Creates a bgfx::TextureHandle from an std::vector<uint32_t>. It is row-major, RGBA32U. Examples of how to read from it can be found in the uint tree64s(int index); function in the tree64 traversal shader.
-     * @param data The std::vector<uint32_t>& to create the texture based on. It is copied by bgfx.
+     * @param data The std::vector<uint32_t>& to create the texture based on. It is padded with zeros to the size of the texture and copied by bgfx.
      * @return Returns a bgfx::TextureHandle for the texture created from the data.
      */
     bgfx::TextureHandle createArbitraryTexture(std::vector<uint32_t>& data);
@@ -79,12 +84,60 @@ namespace projv::graphics {
      */
     bgfx::TextureHandle createHeaderTexture(std::vector<projv::GPUChunkHeader>& headers);
 
+    /**
+     * Creates a bgfx::TextureHandle from the serialized scene BVH (see createGPUSceneBVH). It is row-major, RGBA32U with 2 texels per node. Examples of how to read from it can be found in the SceneBVHNode sceneBVHNodes(uint nodeIndex); function in the tree64 traversal shader.
+     * @param nodes The nodes to create the texture from. They are copied by bgfx.
+     * @return Returns a bgfx::TextureHandle for the texture created from the nodes.
+     */
+    bgfx::TextureHandle createSceneBVHTexture(const std::vector<projv::GPUSceneBVHNode>& nodes);
+
+    /**
+     * Creates the texture holding the front to back list of visible chunks. It is RGBA32U with 1 texel per chunk (see GPUVisibleChunk) after a first
+     * texel holding the number of entries, in rows of up to 4096 texels. Examples of how to read from it can be found in the rayVisibleChunksIntersect function in the tree64 traversal shader.
+     * Until the first updateVisibleChunkTexture every chunk is listed in header order.
+     * @param chunkCount The number of chunk headers, the most chunks the list can hold.
+     * @return Returns a bgfx::TextureHandle for the created texture. Throws std::invalid_argument if the list doesn't fit in the GPU's maxTextureSize.
+     */
+    bgfx::TextureHandle createVisibleChunkTexture(uint32_t chunkCount);
+
+    /**
+     * Uploads this frame's visible chunk list (see createVisibleChunkList) into gpuData's visible chunk texture. Only the texels in use are updated.
+     * @param gpuData The resources created by createTexturesForScene.
+     * @param visibleChunks The visible chunks, front to back. Can't hold more chunks than the uploaded scene has.
+     */
+    void updateVisibleChunkTexture(GPUData& gpuData, const std::vector<projv::GPUVisibleChunk>& visibleChunks);
+
     /**
      * Creates a projv::GPUData with all of the resources needed to pass a projv::Scene to the GPU.
+     * Chunks with node colors (Chunk::nodeColorData) get them uploaded too, so the shader can stop rays above their voxels (RayQuery.finishLOD).
      * @param scene A projv::Scene& containing the entire scene to be rendered.
+     * @param implicitVoxelAttributes Whether to upload the implicit attribute layout (see addAttributeOffsetsTree64) instead of voxelTypeData. The shader's VOXEL_ATTRIBUTE_INDEXING must match. (false by default)
+     * @param sceneBVH A hierarchy over the scene's chunks that is kept up to date with updateSceneBVH. When nullptr, one is built for the upload. (nullptr by default)
      * @return Returns a projv::GPUData containing all of the created resources for rendering.
      */
-    GPUData createTexturesForScene(projv::Scene& scene);
+    GPUData createTexturesForScene(projv::Scene& scene, bool implicitVoxelAttributes = false, const projv::SceneBVH* sceneBVH = nullptr);
+
+    /**
+     * Creates a projv::GPUData whose tree64, voxel type and node color textures persist, with each chunk placed in its own texels by a GPUSceneLayout.
+     * Unlike the other createTexturesForScene, the scene can then be kept up to date with updateTexturesForScene, which only uploads what changed.
+     * @param scene A projv::Scene& containing the entire scene to be rendered.
+     * @param layout A layout from createGPUSceneLayout that nothing was placed in yet. Its maxTextureRows is lowered to the GPU's maxTextureSize. Whether it places the implicit attribute layout must match the shader's VOXEL_ATTRIBUTE_INDEXING.
+     * @param sceneBVH A hierarchy over the scene's chunks that is kept up to date with updateSceneBVH. When nullptr, one is built for the upload. (nullptr by default)
+     * @return Returns a projv::GPUData containing all of the created resources for rendering.
+     */
+    GPUData createTexturesForScene(projv::Scene& scene, projv::GPUSceneLayout& layout, const projv::SceneBVH* sceneBVH = nullptr);
+
+    /**
+     * Uploads the chunks that were added or changed since the last upload into textures created by createTexturesForScene with a layout. Each chunk is written with bgfx::updateTexture2D
+     * into the texels updateGPUSceneLayout gave it, and only the headers that changed are rewritten. A texture that ran out of space is created again with more rows and refilled from the scene.
+     * The scene BVH texture is created again, and the header and visible chunk textures too when the number of chunks changed.
+     * @param gpuData The resources created by createTexturesForScene with the same layout.
+     * @param layout The layout the textures were created with.
+     * @param scene The scene, with chunks added, removed, changed or reordered since the last upload. Chunks edited in place must be marked with markGPUChunkChanged.
+     * @param sceneBVH A hierarchy over the scene's chunks that is kept up to date with updateSceneBVH. When nullptr, one is built for the upload. (nullptr by default)
+     * @return The number of bytes of chunk data and headers uploaded.
+     */
+    size_t updateTexturesForScene(GPUData& gpuData, projv::GPUSceneLayout& layout, projv::Scene& scene, const projv::SceneBVH* sceneBVH = nullptr);
 }
 
 #endif
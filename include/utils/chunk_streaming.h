@@ -0,0 +1,115 @@
+#ifndef PROJECTV_CHUNK_STREAMING_H
+#define PROJECTV_CHUNK_STREAMING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <stdexcept>
+
+#include "data_structures/chunkStreaming.h"
+#include "data_structures/scene.h"
+#include "data_structures/voxelRegion.h"
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/voxel_io.h"
+#include "utils/voxel_math.h"
+
+namespace projv::utils {
+
+    /**
+     * Streams the chunks of a scene on disk in and out of a Scene as the camera moves. Chunks are read with loadChunkFromDisk on background threads, nearest to the
+     * camera's predicted path first, and the chunks that have been out of view the longest are evicted when a RAM or GPU budget would be exceeded.
+     * The streamer owns which chunks are in the scene, the chunks themselves may be edited.
+     */
+    class ChunkStreamer {
+        public:
+            /**
+            * Reads the chunk headers of a scene and starts the loading threads. No chunk is loaded until the first update.
+            * @param sceneFileDirectory The directory of the scene, as written by writeSceneToDisk.
+            * @param settings The distances, budgets and threads to stream with.
+            */
+            ChunkStreamer(const std::string& sceneFileDirectory, const ChunkStreamingSettings& settings = ChunkStreamingSettings());
+
+            /**
+            * Stops the loading threads. Chunks being read are finished first.
+            */
+            ~ChunkStreamer();
+
+            ChunkStreamer(const ChunkStreamer&) = delete;
+            ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+            /**
+            * Moves the chunks that finished loading into the scene, evicts chunks over the budgets and queues the next chunks to load. Call once per frame, it never waits for the disk.
+            * Chunks are appended to and removed from scene.chunks, so bring the SceneBVH (updateSceneBVH) and GPU data up to date when it returns true.
+            * @param scene The scene to stream into. Must only hold chunks added by this streamer.
+            * @param cameraPosition The position of the camera in world space.
+            * @param cameraVelocity The velocity of the camera in world units per second, used to load the chunks it is moving towards first.
+            * @param viewProjection The camera's projection matrix multiplied by its view matrix. Chunks in view are never evicted.
+            * @param homogeneousDepth True if the projection maps depth to -1 to 1 (OpenGL), false for 0 to 1.
+            * @return True if chunks were added to or removed from the scene.
+            */
+            bool update(Scene& scene, core::vec3 cameraPosition, core::vec3 cameraVelocity, const core::mat4& viewProjection, bool homogeneousDepth);
+
+            /**
+            * Gets the headers of every chunk of the scene on disk, resident or not.
+            * @return The headers, in the order of headers.json.
+            */
+            const std::vector<ChunkHeader>& getChunkHeaders() const;
+
+            /**
+            * Gets what the streamer holds and has done.
+            * @return The chunk counts and bytes.
+            */
+            ChunkStreamingStatistics getStatistics() const;
+
+        private:
+            enum class StreamedChunkState {
+                OnDisk,
+                Queued, // In loadQueue.
+                Loading, // Being read by a loading thread.
+                Resident // In the scene.
+            };
+
+            struct StreamedChunk {
+                StreamedChunkState state;
+                size_t ramBytes; // Estimated from the file sizes until the chunk is resident.
+                size_t gpuBytes; // Estimated from the file sizes until the chunk is resident.
+                uint64_t lastVisibleFrame;
+                float distance; // Distance of the chunk's bounds to the camera's predicted path in the last update.
+            };
+
+            void loadChunks();
+            bool evictChunk(Scene& scene, float fartherThan);
+
+            std::string sceneFileDirectory;
+            ChunkStreamingSettings settings;
+            std::vector<ChunkHeader> chunkHeaders;
+            std::vector<StreamedChunk> streamedChunks; // Indexed like chunkHeaders.
+            uint64_t frame = 0;
+            size_t residentChunks = 0;
+            size_t residentRAMBytes = 0;
+            size_t residentGPUBytes = 0;
+            size_t loadedChunks = 0;
+            size_t evictedChunks = 0;
+
+            mutable std::mutex mutex; // Guards the states of streamedChunks, the pending counters, loadQueue, finishedChunks and stopping.
+            size_t pendingChunks = 0; // Queued or loading.
+            size_t pendingRAMBytes = 0;
+            size_t pendingGPUBytes = 0;
+            std::condition_variable loadRequested;
+            std::deque<size_t> loadQueue; // Chunks to read, nearest first.
+            std::vector<std::pair<size_t, Chunk>> finishedChunks; // Chunks read but not in the scene yet.
+            bool stopping = false;
+            std::vector<std::thread> loadingThreads;
+    };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PROJECTV_CPU_RENDERER_H
+#define PROJECTV_CPU_RENDERER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <array>
+#include <string>
+#include <string.h>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <math.h>
+#include <algorithm>
+
+#include "data_structures/cpuRender.h"
+#include "data_structures/camera.h"
+#include "data_structures/scene.h"
+#include "data_structures/sceneBVH.h"
+#include "data_structures/ray.h"
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/scene_bvh.h"
+
+namespace projv::utils {
+    /**
+     * Renders a scene on the CPU without a GPU or a window. Primary rays are lit by the sun and the sky and followed for settings.bounces bounces, the same way path_trace.frag does.
+     * The image is split into tiles that the worker threads take from their own queues, and threads that run out of tiles steal them from the others.
+     * @param scene The scene to render, for example one loaded with loadSceneFromDisk.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param camera The camera to render from, with its position in world space.
+     * @param settings The resolution, samples and lighting of the render.
+     * @return The image in linear radiance, write it with writeCPUImageToPNG or writeCPUImageToEXR.
+     */
+    CPUImage renderSceneOnCPU(const Scene& scene, const SceneBVH& sceneBVH, const Camera& camera, const CPURenderSettings& settings = CPURenderSettings());
+
+    /**
+     * Renders a scene on the CPU, building the SceneBVH for it first. See the overload taking a SceneBVH.
+     * @param scene The scene to render, for example one loaded with loadSceneFromDisk.
+     * @param camera The camera to render from, with its position in world space.
+     * @param settings The resolution, samples and lighting of the render.
+     * @return The image in linear radiance.
+     */
+    CPUImage renderSceneOnCPU(const Scene& scene, const Camera& camera, const CPURenderSettings& settings = CPURenderSettings());
+
+    /**
+     * Writes an image as an 8 bit RGB PNG, tone mapped and gamma corrected like post_and_display.frag.
+     * @param image The image to write.
+     * @param filePath The path of the PNG file, missing directories are created.
+     * @return True if the file was written.
+     */
+    bool writeCPUImageToPNG(const CPUImage& image, const std::string& filePath);
+
+    /**
+     * Writes an image as an uncompressed 32 bit float OpenEXR file, keeping the linear radiance for comparing renders.
+     * @param image The image to write.
+     * @param filePath The path of the EXR file, missing directories are created.
+     * @return True if the file was written.
+     */
+    bool writeCPUImageToEXR(const CPUImage& image, const std::string& filePath);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef PROJECTV_GPU_SCENE_LAYOUT_H
+#define PROJECTV_GPU_SCENE_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+
+#include "data_structures/gpuSceneLayout.h"
+#include "data_structures/scene.h"
+#include "core/log.h"
+#include "utils/voxel_management.h"
+
+namespace projv::utils {
+    /**
+     * Creates a free list over the texels of a texture, with every texel free.
+     * @param capacity The number of texels in the texture.
+     * @return The allocator.
+     */
+    TexelAllocator createTexelAllocator(uint32_t capacity);
+
+    /**
+     * Allocates a range of texels from the smallest free block it fits in, the lowest one if several fit equally well.
+     * @param allocator The allocator to allocate from.
+     * @param texelCount The number of texels to allocate. Must not be 0.
+     * @return The first texel of the range, or UINT32_MAX if no free block is large enough.
+     */
+    uint32_t allocateTexels(TexelAllocator& allocator, uint32_t texelCount);
+
+    /**
+     * Frees a range allocated with allocateTexels, merging it with the free blocks next to it.
+     * @param allocator The allocator the range was allocated from.
+     * @param firstTexel The first texel of the range, as returned by allocateTexels.
+     */
+    void freeTexels(TexelAllocator& allocator, uint32_t firstTexel);
+
+    /**
+     * Adds free texels to the end of an allocator, after its texture has been made larger. Allocations stay where they are.
+     * @param allocator The allocator to grow.
+     * @param capacity The new number of texels. Must not be below the current capacity.
+     */
+    void growTexelAllocator(TexelAllocator& allocator, uint32_t capacity);
+
+    /**
+     * Gets the number of texels allocated.
+     * @param allocator The allocator.
+     * @return The texels in all allocations.
+     */
+    uint32_t getAllocatedTexelCount(const TexelAllocator& allocator);
+
+    /**
+     * Gets the largest range allocateTexels can currently return.
+     * @param allocator The allocator.
+     * @return The texels in the largest free block, 0 if the allocator is full.
+     */
+    uint32_t getLargestFreeTexelBlock(const TexelAllocator& allocator);
+
+    /**
+     * Splits a range of a row-major texture into the rectangles bgfx::updateTexture2D can write: the rest of the first row, the full rows and the start of the last row.
+     * @param range The texels, counted from the top left texel.
+     * @param textureWidth The texels per row of the texture.
+     * @return At most 3 rectangles, covering the range in order. Empty for an empty range.
+     */
+    std::vector<TextureRectangle> getTexelRangeRectangles(TexelRange range, uint32_t textureWidth);
+
+    /**
+     * Gets the number of texels a chunk's data takes up in a scene texture. Chunks without a color for every node take up no node color texels.
+     * @param chunk The chunk.
+     * @param texture The scene texture.
+     * @param implicitVoxelAttributes Whether the implicit attribute layout is placed instead of voxelTypeData.
+     * @return The number of texels.
+     */
+    uint32_t getChunkTexelCount(const Chunk& chunk, GPUSceneTexture texture, bool implicitVoxelAttributes);
+
+    /**
+     * Creates the bookkeeping of empty persistent scene textures. Nothing is placed until the first updateGPUSceneLayout.
+     * @param settings The texture width, rows and voxel attribute layout.
+     * @return The layout.
+     */
+    GPUSceneLayout createGPUSceneLayout(const GPUSceneLayoutSettings& settings = GPUSceneLayoutSettings());
+
+    /**
+     * Makes the next updateGPUSceneLayout place a chunk's data again. Chunks changed by the utils functions get a new revision (bumpChunkRevision) and are found without it,
+     * as are chunks whose data changed size or whose LOD changed. Chunks whose vectors were changed directly without bumpChunkRevision are not.
+     * @param layout The layout.
+     * @param chunkID The chunk that changed.
+     */
+    void markGPUChunkChanged(GPUSceneLayout& layout, uint32_t chunkID);
+
+    /**
+     * Brings the layout up to date with a scene. Removed and changed chunks free their texels first, then new and changed chunks are allocated,
+     * growing a texture (doubling its rows) when a chunk doesn't fit. Chunks that didn't change keep their texels, so only their headers can change.
+     * The headers are written in the order of scene.chunks, the order the scene BVH and visible chunk list index them in.
+     * @param layout The layout to update.
+     * @param scene The scene. Chunk IDs must be unique.
+     * @return The texels and headers to upload. A chunk that doesn't fit in settings.maxTextureRows throws std::invalid_argument and leaves the layout as it was.
+     */
+    GPUSceneLayoutUpdate updateGPUSceneLayout(GPUSceneLayout& layout, const Scene& scene);
+
+    /**
+     * Gets the rows a scene texture needs to hold the layout.
+     * @param layout The layout.
+     * @param texture The scene texture.
+     * @return The rows, settings.textureWidth texels each.
+     */
+    uint32_t getGPUSceneTextureRows(const GPUSceneLayout& layout, GPUSceneTexture texture);
+}
+
+#endif
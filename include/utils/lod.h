@@ -6,11 +6,42 @@
 #include <iostream>
 #include <chrono>
 #include <math.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <tuple>
+#include <stdexcept>
 
 #include "data_structures/scene.h"
+#include "data_structures/lodScheduling.h"
+#include "core/math.h"
 #include "utils/voxel_io.h"
+#include "utils/voxel_math.h"
+#include "utils/voxel_management.h"
 
 namespace projv::utils {
+    /**
+     * Lowers the detail of a chunk in memory by removing the deepest levels of its tree64. Each LOD removes one level, so the resolution drops by 4 on every axis.
+     * A lowered voxel is set if any of the voxels it covers was set and takes their rounded average color (see mergeVoxelTypeDataLevels).
+     * The header's resolution and voxelScale are changed to match, its scale stays the same. Node colors of the kept nodes are kept as they are,
+     * and a lowered voxel takes the color of the node it was, so lowering an already lowered chunk still averages the full voxels.
+     * @param chunk The chunk to lower. Its tree64 must be breadth first, as createTree64 writes it.
+     * @param targetLOD The LOD to lower the chunk to. Must not be below the chunk's LOD and must leave the tree64 at least one level.
+     */
+    void reduceChunkLOD(Chunk& chunk, uint32_t targetLOD);
+
+    /**
+     * Gets the lowest detail a chunk can be lowered to while keeping one tree64 level.
+     * @param chunk The chunk, at any LOD.
+     * @return The highest LOD reduceChunkLOD accepts for the chunk.
+     */
+    uint32_t getChunkMaxLOD(const Chunk& chunk);
+
     /**
      * Updates the LOD of a chunk and re-reads the full resolution version if necessary.
      * @param chunk The chunk data to be updated.
@@ -19,6 +50,75 @@ namespace projv::utils {
      * @param forceReload Whether to force reload the chunk from disk. (false by default)
      */
     void updateLOD(Chunk& chunk, uint32_t targetLOD, const std::string& sceneFilePath, bool forceReload = false); // LOD
+
+    /**
+     * Picks a LOD for every chunk of a scene each frame from the size its voxels take up on the screen, and changes the LODs on background threads.
+     * Finished changes are swapped into the scene by update, so rendering never sees a half changed chunk. Raising the detail re-reads the levels it needs from disk (loadChunkFromDiskAtLOD),
+     * so edits that weren't written to disk are lost when a chunk is lowered and raised again.
+     */
+    class LODScheduler {
+        public:
+            /**
+            * Starts the threads that change LODs.
+            * @param sceneFileDirectory The directory of the scene the chunks are read from when their detail is raised.
+            * @param settings The target voxel size, hysteresis, time budget and threads.
+            */
+            LODScheduler(const std::string& sceneFileDirectory, const LODSchedulerSettings& settings = LODSchedulerSettings());
+
+            /**
+            * Stops the threads. Changes that are running are finished first, the rest are dropped.
+            */
+            ~LODScheduler();
+
+            LODScheduler(const LODScheduler&) = delete;
+            LODScheduler& operator=(const LODScheduler&) = delete;
+
+            /**
+            * Swaps the finished LOD changes into the scene and queues changes for the chunks whose voxels became too big or too small on the screen. Call once per frame.
+            * Chunks must not be edited while a change for them is pending, the change would undo the edit.
+            * @param scene The scene to change the LODs of. Chunks may be added and removed between updates.
+            * @param cameraPosition The position of the camera in world space.
+            * @param fov The vertical field of view of the camera in degrees.
+            * @param screenHeight The height of the rendered image in pixels.
+            * @return True if a chunk's data was replaced, the scene has to be uploaded again.
+            */
+            bool update(Scene& scene, core::vec3 cameraPosition, float fov, uint32_t screenHeight);
+
+            /**
+            * Gets the number of LOD changes pending and done, and the time spent on them.
+            * @return The statistics.
+            */
+            LODSchedulerStatistics getStatistics() const;
+
+        private:
+            struct LODTransition {
+                uint32_t chunkID;
+                uint32_t sourceLOD; // The chunk's LOD when the change was queued, the result is dropped if it changed since.
+                uint32_t targetLOD;
+                Chunk chunk; // A copy of the chunk when lowering, only its header when raising. Holds the result once done.
+                bool failed;
+            };
+
+            void runTransitions();
+
+            std::string sceneFileDirectory;
+            LODSchedulerSettings settings;
+            std::unordered_set<uint32_t> chunkIDsOnDisk;
+            std::unordered_set<uint32_t> failedChunkIDs; // Chunks whose LOD change threw, never scheduled again.
+
+            mutable std::mutex mutex; // Guards the queues, the time budget, the pending chunks, the statistics and stopping. Only update changes the pending chunks and counters.
+            std::unordered_set<uint32_t> pendingChunkIDs;
+            size_t completedTransitions = 0;
+            size_t discardedTransitions = 0;
+            float transitionMilliseconds = 0.0f;
+            std::condition_variable transitionRequested;
+            std::deque<LODTransition> queuedTransitions;
+            std::vector<LODTransition> finishedTransitions;
+            float timeBudgetLeft = 0.0f; // Milliseconds the threads may still spend, negative after overrunning the budget.
+            float millisecondsSinceUpdate = 0.0f;
+            bool stopping = false;
+            std::vector<std::thread> transitionThreads;
+    };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,73 @@
+#ifndef PROJECTV_OCCLUSION_CULLING_H
+#define PROJECTV_OCCLUSION_CULLING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <math.h>
+
+#include "data_structures/occlusion.h"
+#include "data_structures/scene.h"
+#include "data_structures/sceneBVH.h"
+#include "core/math.h"
+#include "utils/voxel_math.h"
+
+namespace projv::utils {
+    /**
+     * Finds boxes of a chunk that are completely solid, to hide the chunks behind it. Fully solid cells of the tree64 are merged into as few boxes
+     * as possible and the biggest ones are kept. Meant to run once when a chunk is loaded or changed, not every frame.
+     * @param chunk The chunk to find occluders in.
+     * @param level The smallest cells to build the boxes from, 1 for 4x4x4 voxels, 2 for 16x16x16 voxels and so on.
+     * @param maxOccluders The most boxes to return.
+     * @return The boxes in world space, biggest first.
+     */
+    std::vector<OccluderBox> findChunkOccluders(const Chunk& chunk, int level = 1, size_t maxOccluders = 32);
+
+    /**
+     * Resizes an occlusion buffer if needed and clears it for a camera.
+     * @param buffer The buffer to clear.
+     * @param width The width of the buffer in pixels.
+     * @param height The height of the buffer in pixels.
+     * @param viewProjection The camera's projection matrix multiplied by its view matrix. Its depth has to grow with the distance (no reversed depth).
+     * @param cameraPosition The position of the camera in world space.
+     */
+    void clearOcclusionBuffer(OcclusionBuffer& buffer, int width, int height, const core::mat4& viewProjection, core::vec3 cameraPosition);
+
+    /**
+     * Draws an occluder into an occlusion buffer. Only pixels the box covers completely are written, each with the farthest depth the box can have
+     * in that pixel, so the buffer never hides more than the box does. Boxes crossing the camera's near plane are skipped.
+     * @param buffer The buffer to draw into, see clearOcclusionBuffer.
+     * @param occluder The box in world space.
+     */
+    void rasterizeOccluder(OcclusionBuffer& buffer, const OccluderBox& occluder);
+
+    /**
+     * Checks if a box is hidden behind the occluders drawn into an occlusion buffer.
+     * @param buffer The buffer the occluders were drawn into.
+     * @param boundsMin The minimum corner of the box in world space.
+     * @param boundsMax The maximum corner of the box in world space.
+     * @return True if every pixel the box could cover has an occluder closer than the box's closest point.
+     */
+    bool isBoxOccluded(const OcclusionBuffer& buffer, core::vec3 boundsMin, core::vec3 boundsMax);
+
+    /**
+     * Removes the chunks hidden behind closer chunks from a front to back visible chunk list (see createVisibleChunkList). The occluders of the nearest
+     * chunks are drawn into the buffer, then every chunk's bounds are tested against it.
+     * @param scene The scene the list was made for.
+     * @param chunkOccluders The occluders of every chunk, indexed like Scene::chunks (see findChunkOccluders).
+     * @param visibleChunks The visible chunks, front to back.
+     * @param viewProjection The camera's projection matrix multiplied by its view matrix.
+     * @param cameraPosition The position of the camera in world space.
+     * @param buffer The buffer to draw the occluders into, reused between frames.
+     * @param settings The resolution of the buffer and how many chunks draw their occluders.
+     * @return The chunks that aren't hidden, still front to back.
+     */
+    std::vector<GPUVisibleChunk> removeOccludedChunks(const Scene& scene, const std::vector<std::vector<OccluderBox>>& chunkOccluders, const std::vector<GPUVisibleChunk>& visibleChunks,
+                                                      const core::mat4& viewProjection, core::vec3 cameraPosition, OcclusionBuffer& buffer, const OcclusionCullingSettings& settings = OcclusionCullingSettings());
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PROJECTV_SCENE_BVH_H
+#define PROJECTV_SCENE_BVH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "data_structures/sceneBVH.h"
+#include "data_structures/scene.h"
+#include "data_structures/ray.h"
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/tree64_raycast.h"
+#include "utils/voxel_math.h"
+
+namespace projv::utils {
+    /**
+     * Builds a bounding volume hierarchy over the chunks of a scene, splitting the chunks in half along the longest axis of their centers at every level.
+     * A chunk's bounds go from its position to its position + scale, the same box the shaders use.
+     * @param scene The scene to build the hierarchy for.
+     * @return The hierarchy, with one chunk per leaf.
+     */
+    SceneBVH createSceneBVH(const Scene& scene);
+
+    /**
+     * Adds a chunk to a SceneBVH without rebuilding it. The chunk is placed next to the node whose bounds grow the least, and the bounds above it are refit.
+     * @param sceneBVH The hierarchy to add the chunk to.
+     * @param chunkHeader The header of the chunk, its chunkID must not be in the hierarchy yet.
+     * @param chunkIndex The index of the chunk in Scene::chunks.
+     */
+    void insertChunkIntoSceneBVH(SceneBVH& sceneBVH, const ChunkHeader& chunkHeader, uint32_t chunkIndex);
+
+    /**
+     * Removes a chunk from a SceneBVH without rebuilding it. Its sibling takes the place of their parent and the bounds above it are refit.
+     * @param sceneBVH The hierarchy to remove the chunk from.
+     * @param chunkID The ID of the chunk to remove.
+     * @return True if the chunk was in the hierarchy.
+     */
+    bool removeChunkFromSceneBVH(SceneBVH& sceneBVH, uint32_t chunkID);
+
+    /**
+     * Brings a SceneBVH up to date with a scene after chunks were streamed in or out or moved. Chunks that are gone are removed, new chunks inserted,
+     * moved chunks refit, and the chunk indices of every leaf updated. Only the changed chunks touch the tree.
+     * @param sceneBVH The hierarchy to update.
+     * @param scene The scene it should match.
+     */
+    void updateSceneBVH(SceneBVH& sceneBVH, const Scene& scene);
+
+    /**
+     * Serializes a SceneBVH into the layout read by the shaders. Nodes are stored depth first with a skip index, so the GPU walks the tree without a stack.
+     * A scene without chunks gives a single node that every ray misses.
+     * @param sceneBVH The hierarchy to serialize.
+     * @return The nodes, 2 RGBA32U texels each.
+     */
+    std::vector<GPUSceneBVHNode> createGPUSceneBVH(const SceneBVH& sceneBVH);
+
+    /**
+     * Casts a world space ray through a scene, only visiting chunks whose bounds the ray reaches before the closest hit found so far. Closer nodes are visited first.
+     * @param scene The scene to cast the ray through. A chunk the ray reaches whose resolution isn't a power of 4 throws std::invalid_argument (see castRayThroughChunk).
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param ray The ray in world space.
+     * @param maxSteps The number of empty cells the ray may step through in each chunk before it counts as a miss.
+     * @return The closest hit and the chunk it's in.
+     */
+    SceneRayHit castRayThroughScene(const Scene& scene, const SceneBVH& sceneBVH, const Ray& ray, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Finds the chunk containing a world space position. A chunk contains its minimum corner but not its maximum one, like its voxels do.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param worldPosition The position in world space.
+     * @return The index of the chunk in Scene::chunks, UINT32_MAX when no chunk contains the position.
+     */
+    uint32_t findChunkInSceneBVH(const SceneBVH& sceneBVH, core::vec3 worldPosition);
+
+    /**
+     * Finds every chunk whose bounds overlap a region.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param region The region in world space.
+     * @return The indices of the chunks in Scene::chunks, ascending.
+     */
+    std::vector<uint32_t> findChunksInSceneBVH(const SceneBVH& sceneBVH, const VoxelRegion& region);
+
+    /**
+     * Frustum culls the chunks of a scene against a camera and sorts the ones in view front to back. Meant to run every frame, the list is uploaded
+     * with updateVisibleChunkTexture so camera rays can stop at the first chunk that starts behind their closest hit.
+     * @param scene The scene the hierarchy was built over.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param viewProjection The camera's projection matrix multiplied by its view matrix.
+     * @param cameraPosition The position of the camera in world space.
+     * @param homogeneousDepth True if viewProjection maps depth to -1 to 1 (OpenGL, glm::perspective), false if it maps it to 0 to 1.
+     * @return One entry per chunk in view, ordered by the distance from the camera to the chunk's bounds.
+     */
+    std::vector<GPUVisibleChunk> createVisibleChunkList(const Scene& scene, const SceneBVH& sceneBVH, const core::mat4& viewProjection, core::vec3 cameraPosition, bool homogeneousDepth);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PROJECTV_TREE64_CSG_H
+#define PROJECTV_TREE64_CSG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "data_structures/nodeStructure.h"
+#include "data_structures/voxel.h"
+#include "data_structures/scene.h"
+#include "core/log.h"
+#include "utils/voxel_math.h"
+#include "utils/voxel_management.h"
+
+namespace projv::utils {
+    /**
+     * Combines two tree64s with a boolean operation without expanding them to voxels. Both trees are walked together from the root, and a subtree
+     * that only one side has is copied or dropped as a whole. A subtree that is completely solid on one side is resolved without descending into the other side
+     * when the colors of the solid side are the ones kept. The trees must use the regular format (no attribute offsets, see addAttributeOffsetsTree64) and share a resolution.
+     * @param tree64A The serialized tree64 of the first operand, as created by createTree64.
+     * @param voxelTypeDataA The voxelTypeData of the first operand, sorted by Z-Order.
+     * @param tree64B The serialized tree64 of the second operand.
+     * @param voxelTypeDataB The voxelTypeData of the second operand, sorted by Z-Order.
+     * @param gridResolution The resolution both trees were created with.
+     * @param operation The boolean operation to apply.
+     * @param colorPrecedence Which operand's color a voxel in both trees keeps. Ignored by Subtract.
+     * @return The combined tree64, its voxelTypeData and the number of node pairs visited.
+     */
+    Tree64CSGResult applyCSGToTree64(const std::vector<uint32_t>& tree64A, const std::vector<uint32_t>& voxelTypeDataA, const std::vector<uint32_t>& tree64B, const std::vector<uint32_t>& voxelTypeDataB, int gridResolution, Tree64CSGOperation operation, VoxelColorPrecedence colorPrecedence = VoxelColorPrecedence::KeepB);
+
+    /**
+     * Combines another chunk into a chunk using applyCSGToTree64. Both chunks must be at LOD 0 and have the same resolution.
+     * The chunks are combined in their own voxel space, their positions are not taken into account. Node colors are recomputed if the chunk has them.
+     * @param chunk The chunk to combine into, it's the first operand.
+     * @param otherChunk The second operand.
+     * @param operation The boolean operation to apply.
+     * @param colorPrecedence Which chunk's color a voxel in both chunks keeps.
+     */
+    void applyCSGToChunk(Chunk& chunk, const Chunk& otherChunk, Tree64CSGOperation operation, VoxelColorPrecedence colorPrecedence = VoxelColorPrecedence::KeepB);
+}
+
+#endif
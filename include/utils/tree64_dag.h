@@ -0,0 +1,26 @@
+#ifndef PROJECTV_TREE64_DAG_H
+#define PROJECTV_TREE64_DAG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include <array>
+#include <chrono>
+
+#include "data_structures/nodeStructure.h"
+#include "core/log.h"
+#include "utils/voxel_math.h"
+
+namespace projv::utils {
+    /**
+     * Merges identical subtrees of a tree64 into a directed acyclic graph. Subtrees are hash consed bottom up on their valid masks, leaf flag and the identity of their children,
+     * and parents with identical children share one stored block of siblings. The result uses the regular tree64 node format and is laid out level by level,
+     * so every relative pointer still points forward and the existing traversal code reads it unchanged. In place edits (setVoxelInTree64, clearVoxelInTree64) do not support DAGs.
+     * @param tree64 The serialized tree64 to compress, as created by createTree64.
+     * @return The DAG and its compression statistics.
+     */
+    Tree64DAG createTree64DAG(const std::vector<uint32_t>& tree64);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef PROJECTV_TREE64_LAYOUT_H
+#define PROJECTV_TREE64_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include "data_structures/nodeStructure.h"
+#include "data_structures/ray.h"
+#include "core/log.h"
+#include "utils/voxel_math.h"
+#include "utils/tree64_raycast.h"
+
+namespace projv::utils {
+    /**
+     * Stores the nodes of a tree64 in another order, rewriting the relative pointers to match. Blocks of siblings stay together and every child still comes after its parent,
+     * so the traversal code on the CPU and the GPU reads the result unchanged. Parents of leaves keep their Z-Order, so attribute offsets (addAttributeOffsetsTree64) stay valid.
+     * In place edits (setVoxelInTree64, clearVoxelInTree64) and LOD changes expect BreadthFirst, reorder back to it before using them.
+     * @param tree64 The serialized tree64, in any order. Must be a tree, not a DAG, with a single root (see countTree64Roots), throws std::invalid_argument otherwise.
+     * @param order The order to store the nodes in. BreadthFirst gives the same result as createTree64.
+     * @return The reordered tree64. Nodes that can't be reached from the root are dropped.
+     */
+    std::vector<uint32_t> reorderTree64(const std::vector<uint32_t>& tree64, Tree64NodeOrder order);
+
+    /**
+     * Casts rays through a tree64 one after another and counts the cache misses their node reads would cause in a simulated set associative cache.
+     * The cache is shared by all rays, like on a single core, and starts out empty. Comparing node orders with the same rays shows which keeps traversal in cache.
+     * @param tree64 The serialized tree64, in any order.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Can be empty.
+     * @param gridResolution The resolution the tree64 was created with.
+     * @param rays The rays in the tree64's grid space.
+     * @param rayCount The number of rays.
+     * @param settings The size and shape of the simulated cache.
+     * @return The node reads, cache lines touched and cache misses of all rays.
+     */
+    Tree64CacheStatistics measureTree64CacheMisses(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, size_t rayCount,
+                                                   const Tree64CacheSettings& settings = Tree64CacheSettings());
+}
+
+#endif
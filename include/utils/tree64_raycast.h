@@ -0,0 +1,103 @@
+#ifndef PROJECTV_TREE64_RAYCAST_H
+#define PROJECTV_TREE64_RAYCAST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <algorithm>
+
+#include "data_structures/ray.h"
+#include "data_structures/nodeStructure.h"
+#include "data_structures/scene.h"
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/voxel_math.h"
+
+namespace projv::utils {
+    constexpr uint32_t DEFAULT_MAX_RAY_STEPS = 1024; // Empty cells a ray may step through before it counts as a miss.
+    constexpr size_t RAY_PACKET_SIZE = 8; // Rays traced together by castRayPacketThroughTree64.
+
+    /**
+     * Casts a ray through a tree64 on the CPU. Empty space is skipped a whole node at a time, and only the part of the path below the node the ray moved out of is walked again.
+     * Reads the same geometryData and voxelTypeData layout as the GPU traversal, attribute offsets (addAttributeOffsetsTree64) are ignored.
+     * @param tree64 The serialized tree64, as created by createTree64.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Can be empty if the voxel's index isn't needed.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ray The ray, in the tree64's grid space where every voxel has a size of 1.
+     * @param maxSteps The number of empty cells the ray may step through before it counts as a miss.
+     * @return The hit voxel, the distance to it, the normal of the face it was hit on and the number of steps taken.
+     */
+    RayHit castRayThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Casts a ray through a tree64 like castRayThroughTree64 but stops LOD levels above the voxels, hitting the first node of that level the ray enters.
+     * Hits the same cells as casting through the tree64 lowered with reduceChunkLOD, without making a lowered copy. The hit node is shaded with its node color (createTree64NodeColors).
+     * @param tree64 The serialized tree64, as created by createTree64.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Only read for hits at LOD 0, can be empty otherwise.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ray The ray, in the tree64's grid space where every voxel has a size of 1.
+     * @param LOD The number of levels above the voxels to stop at, clamped to the level below the root. 0 is the same as castRayThroughTree64.
+     * @param maxSteps The number of empty cells the ray may step through before it counts as a miss.
+     * @return The hit, with nodeIndex set to the hit node and voxelPosition to the voxel of the node the ray entered first. Hits at LOD 0 are voxel hits.
+     */
+    RayHit castRayThroughTree64AtLOD(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, uint32_t LOD, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Casts a ray through a tree64 like castRayThroughTree64 and records every node it reads. Meant for studying memory access patterns (see measureTree64CacheMisses), not for rendering.
+     * @param tree64 The serialized tree64, in any node order.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Can be empty if the voxel's index isn't needed.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ray The ray, in the tree64's grid space where every voxel has a size of 1.
+     * @param visitedNodes Receives the index of every node read, in the order they were read. Indices are appended, the vector isn't cleared.
+     * @param maxSteps The number of empty cells the ray may step through before it counts as a miss.
+     * @return The same hit as castRayThroughTree64.
+     */
+    RayHit traceRayThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, std::vector<uint32_t>& visitedNodes, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Casts RAY_PACKET_SIZE rays through a tree64 together. Every ray walks its own path, while the stepping from cell to cell is done for all of them at once with AVX2 when the CPU supports it.
+     * The results are identical to castRayThroughTree64.
+     * @param tree64 The serialized tree64, as created by createTree64.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Can be empty if the voxels' indices aren't needed.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param rays RAY_PACKET_SIZE rays in the tree64's grid space.
+     * @param hits Receives RAY_PACKET_SIZE results.
+     * @param maxSteps The number of empty cells each ray may step through before it counts as a miss.
+     */
+    void castRayPacketThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, RayHit* hits, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Casts any number of rays through a tree64 in packets, spread over several threads.
+     * @param tree64 The serialized tree64, as created by createTree64.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Can be empty if the voxels' indices aren't needed.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param rays The rays in the tree64's grid space.
+     * @param hits Receives one result per ray.
+     * @param rayCount The number of rays.
+     * @param maxSteps The number of empty cells each ray may step through before it counts as a miss.
+     * @param threadCount The number of threads to use, 0 uses every hardware thread.
+     */
+    void castRaysThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, RayHit* hits, size_t rayCount, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS, int threadCount = 0);
+
+    /**
+     * Casts a world space ray through a chunk, using its position and scale the same way castRayThroughTree64 in the shaders does.
+     * @param chunk The chunk to cast the ray through. Its resolution must be a power of 4, throws std::invalid_argument otherwise.
+     * @param ray The ray in world space.
+     * @param maxSteps The number of empty cells the ray may step through before it counts as a miss.
+     * @return The hit, with the distance in world space along the ray. The voxel position stays in the chunk's grid.
+     */
+    RayHit castRayThroughChunk(const Chunk& chunk, const Ray& ray, uint32_t maxSteps = DEFAULT_MAX_RAY_STEPS);
+
+    /**
+     * Returns the name of the packet tracing kernel picked for this CPU ("AVX2" or "scalar").
+     * @return The name of the kernel.
+     */
+    const char* getRayPacketKernelName();
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef PROJECTV_VOXEL_COLLISION_H
+#define PROJECTV_VOXEL_COLLISION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <math.h>
+
+#include "data_structures/collision.h"
+#include "data_structures/scene.h"
+#include "data_structures/sceneBVH.h"
+#include "data_structures/nodeStructure.h"
+#include "core/math.h"
+#include "utils/voxel_math.h"
+#include "utils/scene_bvh.h"
+
+namespace projv::utils {
+    /**
+     * Sweeps an axis aligned box through a tree64 and finds the first voxel it touches. Nodes the swept box can't reach, or only reaches after
+     * the closest hit so far, are skipped whole, and the remaining children are visited closest first.
+     * Only overlap counts as touching, so a box resting on voxels can slide along them.
+     * @param tree64 The serialized tree64.
+     * @param gridResolution The resolution the tree64 was created with.
+     * @param boxMin The minimum corner of the box in the tree64's grid space, where every voxel has a size of 1.
+     * @param boxMax The maximum corner of the box in the tree64's grid space.
+     * @param displacement How far the box moves, in the tree64's grid space.
+     * @return The time of impact and contact normal, chunkIndex is 0.
+     */
+    SweepHit sweepAABBThroughTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::vec3 boxMin, core::vec3 boxMax, core::vec3 displacement);
+
+    /**
+     * Sweeps a capsule through a tree64 and finds the first voxel it touches. Nodes are skipped using the capsule's bounding box like
+     * sweepAABBThroughTree64, voxels are tested against the capsule itself.
+     * @param tree64 The serialized tree64.
+     * @param gridResolution The resolution the tree64 was created with.
+     * @param pointA One end of the capsule's segment in the tree64's grid space.
+     * @param pointB The other end of the capsule's segment.
+     * @param radius The radius of the capsule in the tree64's grid space.
+     * @param displacement How far the capsule moves, in the tree64's grid space.
+     * @return The time of impact and contact normal, chunkIndex is 0.
+     */
+    SweepHit sweepCapsuleThroughTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::vec3 pointA, core::vec3 pointB, float radius, core::vec3 displacement);
+
+    /**
+     * Sweeps an axis aligned box through a scene. Only chunks whose bounds the swept box overlaps are tested, closest first.
+     * @param scene The scene to sweep through.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param boxMin The minimum corner of the box in world space.
+     * @param boxMax The maximum corner of the box in world space.
+     * @param displacement How far the box moves in world space.
+     * @return The time of impact, contact normal and the hit voxel.
+     */
+    SweepHit sweepAABBThroughScene(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 boxMin, core::vec3 boxMax, core::vec3 displacement);
+
+    /**
+     * Sweeps a capsule through a scene. See sweepAABBThroughScene.
+     * @param scene The scene to sweep through.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param pointA One end of the capsule's segment in world space.
+     * @param pointB The other end of the capsule's segment.
+     * @param radius The radius of the capsule.
+     * @param displacement How far the capsule moves in world space.
+     * @return The time of impact, contact normal and the hit voxel.
+     */
+    SweepHit sweepCapsuleThroughScene(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 pointA, core::vec3 pointB, float radius, core::vec3 displacement);
+
+    /**
+     * Checks if any voxel of one placed tree64 overlaps any voxel of another. Both hierarchies are descended together and node pairs whose
+     * oriented boxes are separated are skipped, stopping at the first overlapping voxel pair. Touching voxels don't overlap.
+     * @param tree64A The first serialized tree64.
+     * @param gridResolutionA The resolution the first tree64 was created with.
+     * @param transformA Where the first tree64 is in the world.
+     * @param tree64B The second serialized tree64.
+     * @param gridResolutionB The resolution the second tree64 was created with.
+     * @param transformB Where the second tree64 is in the world.
+     * @return True if the objects overlap.
+     */
+    bool areTree64sOverlapping(const std::vector<uint32_t>& tree64A, int gridResolutionA, const VoxelObjectTransform& transformA,
+                               const std::vector<uint32_t>& tree64B, int gridResolutionB, const VoxelObjectTransform& transformB);
+
+    /**
+     * Finds every pair of overlapping voxels between two placed tree64s, with a contact point, normal and depth for each. See areTree64sOverlapping.
+     * @param tree64A The first serialized tree64.
+     * @param gridResolutionA The resolution the first tree64 was created with.
+     * @param transformA Where the first tree64 is in the world.
+     * @param tree64B The second serialized tree64.
+     * @param gridResolutionB The resolution the second tree64 was created with.
+     * @param transformB Where the second tree64 is in the world.
+     * @param pairs Receives the overlapping voxel pairs. The normals push the first object out of the second.
+     */
+    void findOverlappingVoxelsTree64(const std::vector<uint32_t>& tree64A, int gridResolutionA, const VoxelObjectTransform& transformA,
+                                     const std::vector<uint32_t>& tree64B, int gridResolutionB, const VoxelObjectTransform& transformB, std::vector<VoxelOverlapPair>& pairs);
+}
+
+#endif
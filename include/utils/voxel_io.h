@@ -12,8 +12,14 @@
 #include "nlohmann/json.hpp"
 #include "data_structures/scene.h"
 #include "voxel_math.h"
+#include "voxel_management.h"
 
 namespace projv::utils {
+    // Ends the level table appended to the tree64 and voxelTypeData files of a chunk. The table lists where every tree64 level ends (in nodes) in the tree64 file, after the node colors,
+    // and where the voxelTypeData of every LOD ends (in uint32_t's after LOD 0's) in the voxelTypeData file. It is followed by its length (size_t) and this value.
+    // Readers that don't know about it read the leading count and data and ignore the rest.
+    const uint32_t CHUNK_LEVEL_TABLE_MAGIC = 0x4C564C54;
+
     /**
      * Writes an std::vector<uint32_t> to a file directory.
      * @param vector An std::vector<uint32_t> to be written to the file in fileDirectory.
@@ -46,12 +52,23 @@ namespace projv::utils {
      * Loads a chunk from disk given the scene file directory and chunk header.
      * @param sceneFileDirectory The directory of the scene file.
      * @param chunkHeader The header of the chunk to be loaded.
-     * @return A chunkData object containing the loaded chunk data.
+     * @return A chunkData object containing the loaded chunk data. Its node colors are read with it, or computed for files written without them.
      */
     Chunk loadChunkFromDisk(std::string sceneFileDirectory, ChunkHeader chunkHeader);
 
+    /**
+     * Loads a chunk from disk at a lower detail, reading only the first levels of its tree64 and the stored voxelTypeData of that LOD.
+     * Chunks written before level tables and node colors were stored are read whole and lowered in memory instead.
+     * @param sceneFileDirectory The directory of the scene file.
+     * @param chunkHeader The header of the chunk to be loaded, only its chunkID is used.
+     * @param LOD The LOD to load, each LOD is one tree64 level less (see reduceChunkLOD). Must leave at least one level.
+     * @return The chunk at the LOD, with its header's resolution and voxelScale lowered to match. Its node colors and voxel colors match lowering the full chunk with reduceChunkLOD.
+     */
+    Chunk loadChunkFromDiskAtLOD(std::string sceneFileDirectory, ChunkHeader chunkHeader, uint32_t LOD);
+
     /**
      * Writes a chunk to disk given the scene file directory and chunk data.
+     * Breadth first tree64s are written with their node colors, a level table and the voxelTypeData of every lower LOD, so loadChunkFromDiskAtLOD can read just the part it needs.
      * @param sceneFileDirectory The directory of the scene file.
      * @param chunk The chunk data to be written.
      */
@@ -71,6 +88,11 @@ namespace projv::utils {
      */
     void writeSceneToDisk(std::string sceneFileDirectory, Scene& scene);
 
+    /**
+     * Loads the headers of every chunk of a scene without loading the chunks.
+     * @param sceneFileDirectory The directory of the scene file.
+     * @return The chunk headers, in the order they are stored.
+     */
     std::vector<ChunkHeader> loadChunkHeadersFromDisk(std::string sceneFileDirectory);
 
     std::vector<ChunkHeader> getChunkHeadersFromScene(Scene& scene);
@@ -4,12 +4,18 @@
 #include <vector>
 #include <stdint.h>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
 #include <math.h>
 #include <unordered_map>
 #include <chrono>
 #include <algorithm>
 #include <bitset>
 #include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <string>
 
 #include "data_structures/voxel.h"
 #include "data_structures/nodeStructure.h"
@@ -19,6 +25,9 @@
 #include "voxel_math.h"
 
 namespace projv::utils {
+    // uint32_t's per voxel in the implicit attribute layout ([color][normal]), voxelTypeData uses 3 ([ZOrder][color][normal]).
+    constexpr int VOXEL_ATTRIBUTE_SLICES = 2;
+
     /**
      * Initiates an empty grid of voxel's of size resolution.
      * @param size A power of 2 size of the voxel grid.
@@ -48,6 +57,13 @@ namespace projv::utils {
      */
     Chunk createChunk(ChunkHeader chunkHeader);
 
+    /**
+     * Gives a chunk a new revision after its tree64, voxelTypeData or node colors changed. Revisions come from one counter shared by every chunk,
+     * so no two versions of chunk data have the same one. The utils functions that change chunk data call it, code changing the vectors itself has to as well.
+     * @param chunk The chunk that changed.
+     */
+    void bumpChunkRevision(Chunk& chunk);
+
     /**
      * Calculates the world-space size (scale) of a chunk from its voxel scale and resolution.
      * @param voxelScale The size of a single voxel in world units.
@@ -56,6 +72,173 @@ namespace projv::utils {
      */
     float createChunkScaleFromVoxelScaleAndResolution(float voxelScale, int resolutionPowerOf2);
 
+    /**
+     * Builds the serialized tree64 of a sorted VoxelGrid on a single thread.
+     * @param voxels The VoxelGrid to build from, sorted by Z-Order.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @return The serialized tree64, 3 uint32_t per node.
+     */
+    std::vector<uint32_t> createTree64(VoxelGrid& voxels, int gridResolution);
+
+    /**
+     * Builds the serialized tree64 of a sorted VoxelGrid on a pool of worker threads.
+     * Each child of the root covers a contiguous Z-Order range of the voxels, so those subtrees are built independently and then stitched together.
+     * The output is bit-identical to createTree64.
+     * @param voxels The VoxelGrid to build from, sorted by Z-Order.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @param threadCount The number of threads to use. 0 uses std::thread::hardware_concurrency().
+     * @return The serialized tree64, 3 uint32_t per node.
+     */
+    std::vector<uint32_t> createTree64Parallel(VoxelGrid& voxels, int gridResolution, int threadCount = 0);
+
+    /**
+     * Returns the Z-Order of a Morton code, allowing the streaming tree64 builder to read plain Morton codes.
+     * @param ZOrderPosition The Morton code.
+     * @return The Morton code.
+     */
+    inline uint32_t getMortonCode(uint32_t ZOrderPosition) {
+        return ZOrderPosition;
+    }
+
+    /**
+     * Returns the Z-Order of a voxel, allowing the streaming tree64 builder to read voxels.
+     * @param voxel The voxel.
+     * @return The voxel's ZOrderPosition.
+     */
+    inline uint32_t getMortonCode(const Voxel& voxel) {
+        return voxel.ZOrderPosition;
+    }
+
+    /**
+     * Measures how many nodes each level of a tree64 built from a sorted stream of Morton codes will hold, without building it.
+     * writeTree64 reads the stream again, so the iterators must be forward iterators (input iterators can only be read once).
+     * @param first The first element of the stream, either uint32_t Morton codes or Voxels. Must be sorted by Z-Order ascending.
+     * @param last One past the last element of the stream.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @return The Tree64Layout of the stream. The serialized tree64 takes up nodeCount * 3 uint32_t.
+     */
+    template <typename MortonIterator>
+    Tree64Layout measureTree64(MortonIterator first, MortonIterator last, int gridResolution) {
+        static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<MortonIterator>::iterator_category>::value,
+                      "measureTree64: The stream is read again by writeTree64, it needs forward iterators");
+        Tree64Layout layout = {};
+        layout.levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(layout.levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("measureTree64: Resolution " + std::to_string(gridResolution) + " needs more levels than a 32 bit Z-Order can hold");
+        }
+
+        std::array<uint32_t, MAX_TREE64_LEVELS + 1> lastKeys = {};
+        bool firstCode = true;
+        for(; first != last; ++first) {
+            uint32_t ZOrder = getMortonCode(*first);
+            for(int level = layout.levelsOfDepth; level >= 1; level--) {
+                uint32_t key = ZOrder >> (6 * level);
+                if(firstCode || key != lastKeys[level]) { // A new key on this level is a new node on this level and every level below it.
+                    for(int lowerLevel = level; lowerLevel >= 1; lowerLevel--) {
+                        lastKeys[lowerLevel] = ZOrder >> (6 * lowerLevel);
+                        layout.levelNodeCounts[lowerLevel]++;
+                    }
+                    break;
+                }
+            }
+            firstCode = false;
+        }
+
+        for(int level = 1; level <= layout.levelsOfDepth; level++) {
+            layout.nodeCount += layout.levelNodeCounts[level];
+        }
+        return layout;
+    }
+
+    /**
+     * Writes the serialized tree64 of a sorted stream of Morton codes directly into a caller-provided buffer, in a second pass over the stream measureTree64 read.
+     * Nodes are placed at their final breadth first position and their relative pointers are computed as they are created, no intermediate levels are stored.
+     * The output is bit-identical to createTree64.
+     * @param first The first element of the stream, either uint32_t Morton codes or Voxels. Must be a forward iterator over the same sorted stream that was measured.
+     * @param last One past the last element of the stream.
+     * @param layout The layout returned by measureTree64 for this stream.
+     * @param buffer The buffer to write the tree64 to.
+     * @param bufferSize The number of uint32_t the buffer can hold, at least layout.nodeCount * 3.
+     * @return The number of uint32_t written.
+     */
+    template <typename MortonIterator>
+    size_t writeTree64(MortonIterator first, MortonIterator last, const Tree64Layout& layout, uint32_t* buffer, size_t bufferSize) {
+        static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<MortonIterator>::iterator_category>::value,
+                      "writeTree64: The stream was already read by measureTree64, it needs forward iterators");
+        if(bufferSize < layout.nodeCount * 3) {
+            throw std::invalid_argument("writeTree64: Buffer holds " + std::to_string(bufferSize) + " uint32_t but the tree64 needs " + std::to_string(layout.nodeCount * 3));
+        }
+
+        // The root level comes first, then every level below it, so each level starts where the one above it ends.
+        int levelsOfDepth = layout.levelsOfDepth;
+        std::array<size_t, MAX_TREE64_LEVELS + 2> nextNodeIndex = {};
+        for(int level = levelsOfDepth - 1; level >= 1; level--) {
+            nextNodeIndex[level] = nextNodeIndex[level + 1] + layout.levelNodeCounts[level + 1];
+        }
+        nextNodeIndex[levelsOfDepth] = 0;
+        uint32_t rootLevelNodes = uint32_t(layout.levelNodeCounts[levelsOfDepth]);
+
+        std::array<uint32_t, MAX_TREE64_LEVELS + 1> openKeys = {};
+        std::array<size_t, MAX_TREE64_LEVELS + 2> openNodes = {};
+        bool firstCode = true;
+        bool childPointerTooLarge = false;
+        for(; first != last; ++first) {
+            uint32_t ZOrder = getMortonCode(*first);
+
+            // Finds the highest level where this code starts a new node.
+            int changedLevel = 0;
+            for(int level = levelsOfDepth; level >= 1; level--) {
+                if(firstCode || (ZOrder >> (6 * level)) != openKeys[level]) {
+                    changedLevel = level;
+                    break;
+                }
+            }
+            firstCode = false;
+
+            // Opens the new nodes top down. Their first child is always the next node to be opened on the level below.
+            for(int level = changedLevel; level >= 1; level--) {
+                size_t node = nextNodeIndex[level]++;
+                openKeys[level] = ZOrder >> (6 * level);
+                openNodes[level] = node;
+                buffer[node * 3] = 0;
+                buffer[node * 3 + 1] = 0;
+                if(level == 1) {
+                    buffer[node * 3 + 2] = 0b1; // Parents of leaves have a leaf flag and no pointer.
+                } else {
+                    uint32_t childPointer = uint32_t(nextNodeIndex[level - 1]) + 1 - rootLevelNodes - uint32_t(node); // Same arithmetic as addPointersTree64.
+                    if(childPointer > 0b01111111111111111111111111111111) {
+                        childPointerTooLarge = true;
+                    }
+                    buffer[node * 3 + 2] = childPointer << 1;
+                }
+
+                if(level < levelsOfDepth) { // Marks the new node as valid in its parent.
+                    uint32_t relativeZOrder = (ZOrder >> (6 * level)) % 64;
+                    size_t parent = openNodes[level + 1];
+                    buffer[parent * 3 + (relativeZOrder < 32 ? 0 : 1)] |= 1u << (31 - (relativeZOrder % 32));
+                }
+            }
+
+            // Marks the leaf as valid in its parent.
+            uint32_t relativeZOrder = ZOrder % 64;
+            buffer[openNodes[1] * 3 + (relativeZOrder < 32 ? 0 : 1)] |= 1u << (31 - (relativeZOrder % 32));
+        }
+
+        if(childPointerTooLarge) {
+            core::error("writeTree64: Child pointer too large (exceeds 31 bits)! Tree64 may be corrupted. Consider reducing data size or increasing resolution levels");
+        }
+        return layout.nodeCount * 3;
+    }
+
+    /**
+     * Builds the serialized tree64 of a sorted VoxelGrid with measureTree64 and writeTree64, allocating the output exactly once.
+     * The output is bit-identical to createTree64.
+     * @param voxels The VoxelGrid to build from, sorted by Z-Order.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @return The serialized tree64, 3 uint32_t per node.
+     */
+    std::vector<uint32_t> createTree64Streaming(VoxelGrid& voxels, int gridResolution);
+
     /**
      * Adds a voxel to a voxel batch.
      * @param voxel The voxel to add.
@@ -87,7 +270,7 @@ namespace projv::utils {
     void addVoxelBatchAToVoxelBatchB(VoxelBatch& voxelBatchA, VoxelBatch& voxelBatchB, core::ivec3 voxelBatchAPosition = {0, 0, 0});
 
     /**
-     * Updates a Chunk's internal voxel representation using its current VoxelBatch.
+     * Updates a Chunk's internal voxel representation using its current VoxelBatch. The chunk's node colors are computed too.
      * @param chunk The Chunk to update.
      * @param clearBatch Whether to clear the VoxelBatch after the update.
      */
@@ -95,12 +278,215 @@ namespace projv::utils {
 
     /**
      * Removes voxel data from voxelBatchB that overlaps with voxelBatchA, using an optional position offset.
+     * voxelBatchB keeps its order. It's processed with a linear merge when it's sorted by Z-Order, and a binary search per voxel otherwise.
      * @param voxelBatchA The VoxelBatch containing voxels to remove.
      * @param voxelBatchB The VoxelBatch from which voxels will be removed.
      * @param positionOffset An optional positional offset to apply when comparing voxels.
      */
     void removeVoxelBatchAFromVoxelBatchB(VoxelBatch& voxelBatchA, VoxelBatch& voxelBatchB, core::ivec3 positionOffset = {0, 0, 0});
 
+    /**
+     * Serializes a color into the 10 bit per channel format used by voxelTypeData.
+     * @param color The color to serialize.
+     * @return The serialized color.
+     */
+    uint32_t serializeColor(Color color);
+
+    /**
+     * Deserializes a color from the 10 bit per channel format used by voxelTypeData.
+     * @param serializedColor The serialized color.
+     * @return The 8 bit per channel color.
+     */
+    Color unserializeColor(uint32_t serializedColor);
+
+    /**
+     * Serializes a normal into the sign and 9 bit magnitude per axis format used by voxelTypeData.
+     * @param normal The normal to serialize.
+     * @return The serialized normal.
+     */
+    uint32_t serializeNormal(core::vec3 normal);
+
+    /**
+     * Sets a single leaf of a tree64 in place. Only the nodes on the path from the root to the leaf are rewritten,
+     * missing nodes are spliced in at their breadth first position and the relative pointers of the nodes they displace are fixed up.
+     * @param tree64 The serialized tree64 to edit. May be empty.
+     * @param gridResolution The resolution the tree64 was built with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ZOrder The Z-Order of the leaf to set. Must lie inside the tree64.
+     * @param nodeColors Colors to keep aligned with the nodes (createTree64NodeColors), spliced nodes get a 0 entry. See updateTree64NodeColors for their values. (nullptr by default)
+     * @return True if the leaf was empty before.
+     */
+    bool setVoxelInTree64(std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder, std::vector<uint32_t>* nodeColors = nullptr);
+
+    /**
+     * Clears a single leaf of a tree64 in place. Nodes left without children are removed and the relative pointers of the nodes before them are fixed up.
+     * @param tree64 The serialized tree64 to edit. Becomes empty when its last leaf is cleared.
+     * @param gridResolution The resolution the tree64 was built with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ZOrder The Z-Order of the leaf to clear.
+     * @param nodeColors Colors to keep aligned with the nodes (createTree64NodeColors), the entries of removed nodes are erased with them. (nullptr by default)
+     * @return True if the leaf was set before.
+     */
+    bool clearVoxelInTree64(std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder, std::vector<uint32_t>* nodeColors = nullptr);
+
+    /**
+     * Inserts a voxel into sorted voxelTypeData, or overwrites its color if it is already there.
+     * @param voxelTypeData The voxelTypeData to edit, sorted by Z-Order.
+     * @param voxel The voxel to insert.
+     */
+    void setVoxelInVoxelTypeData(std::vector<uint32_t>& voxelTypeData, const Voxel& voxel);
+
+    /**
+     * Erases a voxel from sorted voxelTypeData.
+     * @param voxelTypeData The voxelTypeData to edit, sorted by Z-Order.
+     * @param ZOrder The Z-Order of the voxel to erase.
+     * @return True if the voxel was found and erased.
+     */
+    bool eraseVoxelFromVoxelTypeData(std::vector<uint32_t>& voxelTypeData, uint32_t ZOrder);
+
+    /**
+     * Applies voxel edits to a chunk's geometryData and voxelTypeData in place, without rebuilding them. Clears are applied before sets.
+     * The result matches rebuilding the chunk with updateChunkFromItsVoxelBatch at the chunk's current resolution. If the chunk has node colors, only the ones on the edited paths are recomputed (see updateTree64NodeColors).
+     * updateChunkFromItsVoxelBatch rounds resolutions to a power of 2, chunks it builds at 8, 32, 128 or 512 have several tree64 roots and can only be rebuilt.
+     * @param chunk The chunk to edit. Must be at LOD 0 and have a power of 4 resolution, throws std::invalid_argument otherwise.
+     * @param voxelsToSet The voxels to add, or recolor if they already exist.
+     * @param voxelsToClear The voxels to remove. Only their ZOrderPosition is used.
+     */
+    void applyVoxelEditsToChunk(Chunk& chunk, const VoxelBatch& voxelsToSet, const VoxelBatch& voxelsToClear);
+
+    /**
+     * Writes an attribute base offset into the pointer of every parent of leaves, turning a tree64 into the implicit attribute layout.
+     * The attribute index of a leaf is then its parent's offset plus the number of valid siblings before it, so no Z-Order column or search is needed.
+     * Parents of leaves are stored in Z-Order, so the offsets follow the order of voxelTypeData.
+     * @param tree64 The serialized tree64 to modify. Must be a tree, not a DAG, as every parent of leaves needs its own offset.
+     */
+    void addAttributeOffsetsTree64(std::vector<uint32_t>& tree64);
+
+    /**
+     * Creates the attribute data of the implicit attribute layout by dropping the Z-Order column of voxelTypeData.
+     * @param voxelTypeData The voxelTypeData of a chunk, sorted by Z-Order.
+     * @return VOXEL_ATTRIBUTE_SLICES uint32_t's per voxel ([color][normal]), in the same order as voxelTypeData.
+     */
+    std::vector<uint32_t> createVoxelAttributeData(const std::vector<uint32_t>& voxelTypeData);
+
+    /**
+     * Finds the attribute index of a voxel in a tree64 with attribute offsets.
+     * @param tree64 The serialized tree64, after addAttributeOffsetsTree64.
+     * @param gridResolution The resolution the tree64 was built with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param ZOrder The Z-Order of the voxel.
+     * @return The index of the voxel in the attribute data (in voxels, not uint32_t's), or UINT32_MAX if the voxel is empty.
+     */
+    uint32_t findVoxelAttributeIndexTree64(const std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder);
+
+    /**
+     * Decodes the implicit attribute layout back into regular voxelTypeData.
+     * @param tree64 The serialized tree64, after addAttributeOffsetsTree64.
+     * @param voxelAttributeData The attribute data, as created by createVoxelAttributeData.
+     * @return The voxelTypeData ([ZOrder][color][normal] per voxel, sorted by Z-Order).
+     */
+    std::vector<uint32_t> createVoxelTypeDataFromAttributeData(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelAttributeData);
+
+    /**
+     * Sorts voxels by Z-Order with a stable LSD radix sort, split across threads. Only as many 9 bit passes as the largest Z-Order needs are run (3 for a 512^3 grid).
+     * @param voxels The voxels to sort.
+     * @param threadCount The number of threads to use. 0 uses std::thread::hardware_concurrency(). Small inputs always use one.
+     */
+    void radixSortVoxels(std::vector<Voxel>& voxels, int threadCount = 0);
+
+    /**
+     * Sorts voxels by Z-Order and removes duplicates. Of several voxels at the same position, the one that came last in the input is kept.
+     * @param voxels The voxels to sort and deduplicate.
+     * @param threadCount The number of threads to use. 0 uses std::thread::hardware_concurrency(). Small inputs always use one.
+     */
+    void sortAndDeduplicateVoxels(std::vector<Voxel>& voxels, int threadCount = 0);
+
+    /**
+     * Converts a VoxelBatch into a ColumnarVoxelBatch.
+     * @param voxelBatch The VoxelBatch to convert.
+     * @return The same voxels stored as columns.
+     */
+    ColumnarVoxelBatch createColumnarVoxelBatch(const VoxelBatch& voxelBatch);
+
+    /**
+     * Converts a ColumnarVoxelBatch back into a VoxelBatch.
+     * @param columnarVoxelBatch The ColumnarVoxelBatch to convert.
+     * @return The same voxels as a VoxelBatch.
+     */
+    VoxelBatch createVoxelBatchFromColumnarVoxelBatch(const ColumnarVoxelBatch& columnarVoxelBatch);
+
+    /**
+     * Copies all voxels from a ColumnarVoxelBatch to a Chunk's queue.
+     * @param columnarVoxelBatch The source ColumnarVoxelBatch.
+     * @param chunk The target Chunk.
+     */
+    void moveVoxelBatchToChunk(const ColumnarVoxelBatch& columnarVoxelBatch, Chunk& chunk);
+
+    /**
+     * Merges voxels from one ColumnarVoxelBatch into another, moving them by an offset and clamping them to 0-511 with SIMD kernels.
+     * @param voxelBatchA The ColumnarVoxelBatch to merge from.
+     * @param voxelBatchB The ColumnarVoxelBatch to merge into.
+     * @param voxelBatchAPosition The offset to move voxelBatchA's voxels by.
+     */
+    void addVoxelBatchAToVoxelBatchB(const ColumnarVoxelBatch& voxelBatchA, ColumnarVoxelBatch& voxelBatchB, core::ivec3 voxelBatchAPosition = {0, 0, 0});
+
+    /**
+     * Removes voxels found in one ColumnarVoxelBatch from another. Only the Z-Order columns are read.
+     * @param voxelBatchA The ColumnarVoxelBatch containing voxels to remove.
+     * @param voxelBatchB The ColumnarVoxelBatch from which voxels will be removed.
+     * @param positionOffset The offset to move voxelBatchA's voxels by before comparing.
+     */
+    void removeVoxelBatchAFromVoxelBatchB(const ColumnarVoxelBatch& voxelBatchA, ColumnarVoxelBatch& voxelBatchB, core::ivec3 positionOffset = {0, 0, 0});
+
+    /**
+     * Sorts a ColumnarVoxelBatch by Z-Order with the same stable radix sort as radixSortVoxels.
+     * The passes only move the Z-Order column and a 32 bit index per voxel, the colors are gathered once at the end.
+     * @param voxelBatch The ColumnarVoxelBatch to sort.
+     * @param threadCount The number of threads to use. 0 uses std::thread::hardware_concurrency().
+     */
+    void radixSortVoxels(ColumnarVoxelBatch& voxelBatch, int threadCount = 0);
+
+    /**
+     * Sorts a ColumnarVoxelBatch by Z-Order and removes duplicates, keeping the last one written like sortAndDeduplicateVoxels.
+     * @param voxelBatch The ColumnarVoxelBatch to sort and deduplicate.
+     * @param threadCount The number of threads to use. 0 uses std::thread::hardware_concurrency().
+     */
+    void sortAndDeduplicateVoxels(ColumnarVoxelBatch& voxelBatch, int threadCount = 0);
+
+    /**
+     * Moves every voxel of a batch by an offset and sorts the result by Z-Order. Voxels that end up outside of the Z-Order range (0-1023 per axis) are dropped.
+     * @param voxelBatch The voxels to move.
+     * @param offset The offset to move them by.
+     * @return The moved voxels, sorted by Z-Order.
+     */
+    VoxelBatch createMovedVoxelBatch(const VoxelBatch& voxelBatch, core::ivec3 offset);
+
+    /**
+     * Merges two Z-Order sorted batches without duplicates into their union in linear time.
+     * @param voxelBatchA A VoxelBatch sorted by Z-Order without duplicates.
+     * @param voxelBatchB A VoxelBatch sorted by Z-Order without duplicates.
+     * @param colorPrecedence Whose color to keep where both batches have a voxel. (voxelBatchB by default)
+     * @param voxelBatchBOffset Moves voxelBatchB before merging, see createMovedVoxelBatch. Costs a sort of voxelBatchB when not zero.
+     * @return The union, sorted by Z-Order without duplicates.
+     */
+    VoxelBatch createVoxelBatchUnion(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, VoxelColorPrecedence colorPrecedence = VoxelColorPrecedence::KeepB, core::ivec3 voxelBatchBOffset = {0, 0, 0});
+
+    /**
+     * Removes the voxels of one Z-Order sorted batch from another in linear time.
+     * @param voxelBatchA A VoxelBatch sorted by Z-Order without duplicates.
+     * @param voxelBatchB The voxels to remove, sorted by Z-Order without duplicates.
+     * @param voxelBatchBOffset Moves voxelBatchB before subtracting, see createMovedVoxelBatch. Costs a sort of voxelBatchB when not zero.
+     * @return The voxels of voxelBatchA that aren't in voxelBatchB, sorted by Z-Order.
+     */
+    VoxelBatch createVoxelBatchDifference(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, core::ivec3 voxelBatchBOffset = {0, 0, 0});
+
+    /**
+     * Keeps only the voxels two Z-Order sorted batches have in common, in linear time.
+     * @param voxelBatchA A VoxelBatch sorted by Z-Order without duplicates.
+     * @param voxelBatchB A VoxelBatch sorted by Z-Order without duplicates.
+     * @param colorPrecedence Whose color to keep. (voxelBatchA by default)
+     * @param voxelBatchBOffset Moves voxelBatchB before intersecting, see createMovedVoxelBatch. Costs a sort of voxelBatchB when not zero.
+     * @return The intersection, sorted by Z-Order.
+     */
+    VoxelBatch createVoxelBatchIntersection(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, VoxelColorPrecedence colorPrecedence = VoxelColorPrecedence::KeepA, core::ivec3 voxelBatchBOffset = {0, 0, 0});
+
     /**
      * Creates a Voxel with the specified color and position.
      * @param color The color to assign to the voxel.
@@ -3,9 +3,17 @@
 
 #include <array>
 #include <stdint.h>
+#include <stddef.h>
 #include <iostream>
 #include <map>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <stdexcept>
 #include "core/math.h"
+#include "data_structures/nodeStructure.h"
+#include "data_structures/voxelRegion.h"
 //#include "robin.h"
 
 namespace projv::utils {
@@ -38,6 +46,259 @@ namespace projv::utils {
      * @return Returns an std::array<int, 3> containg the 3D point given from the Z-Order index.
      */
     core::ivec3 reverseZOrderIndex(uint64_t z_order);
+
+    /**
+     * Creates the Z-Order Indices of many points at once. Uses AVX2 or BMI2 when the CPU supports them.
+     * @param positions The points to encode, each axis in the range 0-1023.
+     * @param zOrders Where to write the Z-Orders, count of them.
+     * @param count The number of points.
+     */
+    void createZOrderIndexBatch(const core::ivec3* positions, uint32_t* zOrders, size_t count);
+
+    /**
+     * Creates the 3D points of many Z-Order Indices at once. Uses AVX2 or BMI2 when the CPU supports them.
+     * @param zOrders The Z-Orders to decode.
+     * @param positions Where to write the points, count of them.
+     * @param count The number of Z-Orders.
+     */
+    void reverseZOrderIndexBatch(const uint32_t* zOrders, core::ivec3* positions, size_t count);
+
+    /**
+     * Moves many Z-Order Indices by an offset at once, clamping each axis to the range 0-maxCoordinate. Uses AVX2 or BMI2 when the CPU supports them.
+     * @param zOrders The Z-Orders to move.
+     * @param translatedZOrders Where to write the moved Z-Orders, count of them. May be zOrders itself.
+     * @param count The number of Z-Orders.
+     * @param offset The offset to add to every position.
+     * @param maxCoordinate The largest coordinate allowed on each axis, at most 1023.
+     */
+    void translateZOrderIndexBatch(const uint32_t* zOrders, uint32_t* translatedZOrders, size_t count, core::ivec3 offset, int maxCoordinate);
+
+    /**
+     * Gets the name of the batch Z-Order kernels picked for this CPU.
+     * @return "AVX2", "BMI2" or "scalar".
+     */
+    const char* getZOrderBatchKernelName();
+
+    /**
+     * Creates a VoxelRegion covering an axis aligned box.
+     * @param boundsMin The minimum corner of the box.
+     * @param boundsMax The maximum corner of the box.
+     * @return The region.
+     */
+    VoxelRegion createBoxVoxelRegion(core::vec3 boundsMin, core::vec3 boundsMax);
+
+    /**
+     * Creates a VoxelRegion covering a sphere.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @return The region.
+     */
+    VoxelRegion createSphereVoxelRegion(core::vec3 center, float radius);
+
+    /**
+     * Creates a VoxelRegion covering the view frustum of a camera.
+     * @param viewProjection The projection matrix multiplied by the view matrix.
+     * @param homogeneousDepth True if the projection maps depth to -1 to 1 (OpenGL), false for 0 to 1. Same as core::projectionMatrix.
+     * @return The region.
+     */
+    VoxelRegion createFrustumVoxelRegion(const core::mat4& viewProjection, bool homogeneousDepth);
+
+    /**
+     * Moves a world space VoxelRegion into the grid of a chunk, where every voxel has a size of 1 and the chunk starts at 0.
+     * @param region The region in world space.
+     * @param chunkPosition The position of the chunk.
+     * @param voxelSize The size of one voxel of the chunk, its scale divided by its resolution.
+     * @return The region in the chunk's grid.
+     */
+    VoxelRegion transformVoxelRegionToGrid(const VoxelRegion& region, core::vec3 chunkPosition, float voxelSize);
+
+    /**
+     * Checks how a box lies relative to a region. Frustums are tested plane by plane, so boxes near their edges may be Partial while being outside.
+     * @param region The region.
+     * @param boundsMin The minimum corner of the box.
+     * @param boundsMax The maximum corner of the box.
+     * @return Outside if the box and the region don't overlap (only touching counts as outside), Inside if the box lies completely within the region, Partial otherwise.
+     */
+    VoxelRegionOverlap classifyBoundsInVoxelRegion(const VoxelRegion& region, core::vec3 boundsMin, core::vec3 boundsMax);
+
+    /**
+     * Calculates how many levels a tree64 of a resolution has, the root level and the parents of the leaves included.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @return The number of levels, matching createTree64.
+     */
+    inline int getTree64LevelsOfDepth(int gridResolution) {
+        return std::max(1, int(log10(gridResolution)/log10(4)));
+    }
+
+    /**
+     * Checks whether a tree64 of a resolution has a single root. createTree64 rounds its levels down, so resolutions between powers of 4 (8, 32, 128, 512)
+     * get one root per non-empty block of 4^levels voxels, and the roots don't record which block they are.
+     * @param gridResolution The resolution of the grid along one axis.
+     * @return True if the levels of the resolution cover it, which they do for every power of 4.
+     */
+    inline bool hasSingleTree64Root(int gridResolution) {
+        return int64_t(gridResolution) <= (int64_t(1) << (2 * getTree64LevelsOfDepth(gridResolution)));
+    }
+
+    /**
+     * Combines both valid masks of a tree64 node into one 64 bit mask. Z-Order 0 is the leftmost bit.
+     * @param node A pointer to the first uint32_t of the node.
+     * @return The combined valid mask.
+     */
+    inline uint64_t getTree64ValidMask(const uint32_t* node) {
+        return (uint64_t(node[0]) << 32) | uint64_t(node[1]);
+    }
+
+    /**
+     * Checks if the child at a Z-Order in its parent is valid.
+     * @param validMask The combined valid mask of the parent.
+     * @param zOrderInParent The Z-Order of the child in its parent (0-63).
+     * @return True if the child is valid.
+     */
+    inline bool isTree64ChildValid(uint64_t validMask, uint32_t zOrderInParent) {
+        return (validMask >> (63 - zOrderInParent)) & 1ull;
+    }
+
+    /**
+     * Counts the valid children before a Z-Order in a parent. This is the child's offset from the parent's first child.
+     * @param validMask The combined valid mask of the parent.
+     * @param zOrderInParent The Z-Order of the child in its parent (0-63).
+     * @return The number of valid children before zOrderInParent.
+     */
+    inline uint32_t countTree64SiblingsBefore(uint64_t validMask, uint32_t zOrderInParent) {
+        return zOrderInParent == 0 ? 0 : uint32_t(__builtin_popcountll(validMask >> (64 - zOrderInParent)));
+    }
+
+    /**
+     * Checks the leaf flag of a tree64 node.
+     * @param node A pointer to the first uint32_t of the node.
+     * @return True if the children of the node are leaves.
+     */
+    inline bool isTree64LeafParent(const uint32_t* node) {
+        return (node[2] & 0b1) != 0;
+    }
+
+    /**
+     * Reads the relative pointer of a tree64 node. The first child is at the node's index plus the pointer.
+     * @param node A pointer to the first uint32_t of the node.
+     * @return The relative pointer.
+     */
+    inline uint32_t getTree64ChildPointer(const uint32_t* node) {
+        return node[2] >> 1;
+    }
+
+    /**
+     * Finds where a child sits inside its parent.
+     * @param zOrderInParent The Z-Order of the child in its parent (0-63).
+     * @return The position of the child in child cells, 0-3 on every axis.
+     */
+    inline core::ivec3 getTree64ChildOffset(uint32_t zOrderInParent) {
+        return core::ivec3(
+            int((zOrderInParent & 1) | ((zOrderInParent >> 2) & 2)),
+            int(((zOrderInParent >> 1) & 1) | ((zOrderInParent >> 3) & 2)),
+            int(((zOrderInParent >> 2) & 1) | ((zOrderInParent >> 4) & 2)));
+    }
+
+    /**
+     * Walks a tree64 down to the cell of a Z-Order, starting from the deepest node the path shares with the previous cell instead of the root.
+     * @param tree64 A pointer to the first uint32_t of the tree64, it must not be empty.
+     * @param levelsOfDepth The levels of the tree64 (getTree64LevelsOfDepth).
+     * @param path The path of the previous lookup, a default constructed path starts at the root. Updated to the new cell.
+     * @param ZOrder The Z-Order of the cell to look up.
+     * @param visitNode Called with the index of every node that is read, in order. Used to record memory accesses, see measureTree64CacheMisses.
+     * @return levelsOfDepth if the voxel is set, otherwise the depth of the node whose child towards the cell is empty.
+     */
+    template <typename NodeVisitor>
+    inline int descendTree64Path(const uint32_t* tree64, int levelsOfDepth, Tree64Path& path, uint32_t ZOrder, NodeVisitor&& visitNode) {
+        uint32_t changedBits = path.ZOrder ^ ZOrder;
+        if(changedBits != 0) {
+            int changedDepth = levelsOfDepth - 1 - (31 - __builtin_clz(changedBits)) / 6;
+            path.depth = std::min(path.depth, std::max(changedDepth, 0));
+        }
+        path.ZOrder = ZOrder;
+
+        for(int depth = path.depth; ; depth++) {
+            visitNode(path.nodes[depth]);
+            const uint32_t* node = tree64 + size_t(path.nodes[depth]) * 3;
+            uint32_t zOrderInParent = (ZOrder >> (6 * (levelsOfDepth - 1 - depth))) & 63;
+            uint64_t validMask = getTree64ValidMask(node);
+            path.depth = depth;
+            if(!isTree64ChildValid(validMask, zOrderInParent)) {
+                return depth;
+            }
+            if(depth == levelsOfDepth - 1) {
+                return levelsOfDepth;
+            }
+            path.nodes[depth + 1] = path.nodes[depth] + getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+        }
+    }
+
+    /**
+     * Walks a tree64 down to the cell of a Z-Order, starting from the deepest node the path shares with the previous cell instead of the root.
+     * @param tree64 A pointer to the first uint32_t of the tree64, it must not be empty.
+     * @param levelsOfDepth The levels of the tree64 (getTree64LevelsOfDepth).
+     * @param path The path of the previous lookup, a default constructed path starts at the root. Updated to the new cell.
+     * @param ZOrder The Z-Order of the cell to look up.
+     * @return levelsOfDepth if the voxel is set, otherwise the depth of the node whose child towards the cell is empty.
+     */
+    inline int descendTree64Path(const uint32_t* tree64, int levelsOfDepth, Tree64Path& path, uint32_t ZOrder) {
+        return descendTree64Path(tree64, levelsOfDepth, path, ZOrder, [](uint32_t) {});
+    }
+
+    /**
+     * Finds where every level of a breadth first tree64 ends. The first levels of such a tree64 are a prefix of it, see truncateTree64Levels.
+     * @param tree64 The serialized tree64, stored breadth first as createTree64 writes it. Can be empty. Throws std::invalid_argument if it has more than one root (countTree64Roots).
+     * @param levelsOfDepth The levels of the tree64 (getTree64LevelsOfDepth).
+     * @return The number of nodes up to the end of each level, starting with the root's level. Empty if the tree64 is.
+     */
+    std::vector<size_t> findTree64LevelEnds(const std::vector<uint32_t>& tree64, int levelsOfDepth);
+
+    /**
+     * Cuts the deepest levels off a breadth first tree64, making the nodes of the last kept level the parents of the leaves.
+     * A child node only exists if part of it is set, so a cut voxel is set if any voxel below it was.
+     * @param tree64 The serialized tree64, stored breadth first. Its attribute offsets are dropped.
+     * @param levelEnds The level ends of the tree64 (findTree64LevelEnds).
+     * @param keptLevels The number of levels to keep, at least 1.
+     */
+    void truncateTree64Levels(std::vector<uint32_t>& tree64, const std::vector<size_t>& levelEnds, int keptLevels);
+
+    /**
+     * Merges the voxels of voxelTypeData to a resolution 4 times lower per axis for each removed level, matching truncateTree64Levels.
+     * A merged voxel takes the rounded average color of the voxels it covers (as createTree64NodeColors averages them) and the normal of the first of them in Z-Order.
+     * @param voxelTypeData The voxelTypeData, sorted by Z-Order.
+     * @param removedLevels The number of tree64 levels removed.
+     * @return The merged voxelTypeData, sorted by Z-Order.
+     */
+    std::vector<uint32_t> mergeVoxelTypeDataLevels(const std::vector<uint32_t>& voxelTypeData, uint32_t removedLevels);
+
+    /**
+     * Counts the roots of a tree64. Resolutions that aren't a power of 4 get one root per non-empty block of the top level (see hasSingleTree64Root).
+     * Every other node is the child of exactly one node, so the roots are the nodes left over.
+     * @param tree64 The serialized tree64, in any node order. Must be a tree without unused nodes, as createTree64 and the edits leave it.
+     * @return The number of roots, 0 for an empty tree64.
+     */
+    size_t countTree64Roots(const std::vector<uint32_t>& tree64);
+
+    /**
+     * Computes a representative color for every node of a tree64, the average color of all the voxels below it, so a traversal can stop above the voxels and still shade what it hit.
+     * Colors only depend on the voxels below a node, so they stay valid for the nodes truncateTree64Levels keeps.
+     * @param tree64 The serialized tree64, in any node order.
+     * @param voxelTypeData The voxelTypeData of the tree64, sorted by Z-Order. Voxels missing from the tree64 are skipped.
+     * @return One serialized color (10 bits per channel, like voxelTypeData) per node, at the node's index. Nodes without voxels below them get 0.
+     * Empty if the tree64 is or if it has more than one root (countTree64Roots), whose roots don't record which voxels are below them. Such chunks go without node colors.
+     */
+    std::vector<uint32_t> createTree64NodeColors(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData);
+
+    /**
+     * Recomputes the colors of the nodes on the paths to edited voxels, the only ones an edit changes. Each node is recomputed once, reusing the sums of the edited nodes below it.
+     * The result matches createTree64NodeColors, as long as every voxel of voxelTypeData is set in the tree64.
+     * @param tree64 The edited tree64, stored breadth first.
+     * @param voxelTypeData The edited voxelTypeData, sorted by Z-Order.
+     * @param levelsOfDepth The levels of the tree64 (getTree64LevelsOfDepth).
+     * @param ZOrders The Z-Orders of the set, cleared and recolored voxels. Paths end at the deepest node still in the tree64.
+     * @param nodeColors The node colors, kept aligned with the tree64's nodes during the edits (see setVoxelInTree64). Must have one color per node.
+     */
+    void updateTree64NodeColors(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int levelsOfDepth, const std::vector<uint32_t>& ZOrders, std::vector<uint32_t>& nodeColors);
 }
 
 #endif
@@ -0,0 +1,99 @@
+#ifndef PROJECTV_VOXEL_QUERY_H
+#define PROJECTV_VOXEL_QUERY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <math.h>
+#include <algorithm>
+#include <exception>
+
+#include "data_structures/voxelQuery.h"
+#include "data_structures/voxelRegion.h"
+#include "data_structures/scene.h"
+#include "data_structures/sceneBVH.h"
+#include "core/math.h"
+#include "core/log.h"
+#include "utils/voxel_math.h"
+#include "utils/voxel_management.h"
+#include "utils/scene_bvh.h"
+
+namespace projv::utils {
+    /**
+     * Checks if a voxel of a tree64 is set, starting from the node the path shares with the previously looked up voxel.
+     * @param tree64 The serialized tree64.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param voxelPosition The position of the voxel in the tree64's grid.
+     * @param path The path of the previous lookup in the same tree64, a default constructed path starts at the root.
+     * @return True if the voxel is set. Positions outside of the tree64 are empty.
+     */
+    bool isVoxelSolidInTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::ivec3 voxelPosition, Tree64Path& path);
+
+    /**
+     * Checks if the voxel at a world space position is solid. Queries close to the previous one through the same cursor reuse its chunk and the top of its path.
+     * @param scene The scene to query.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param worldPosition The position in world space.
+     * @param cursor The cursor of the previous query, use one cursor per thread.
+     * @return True if a chunk contains the position and its voxel there is set. A chunk whose resolution isn't a power of 4 throws std::invalid_argument instead.
+     */
+    bool isSolid(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 worldPosition, VoxelQueryCursor& cursor);
+
+    /**
+     * Looks up the voxel at a world space position, including its color. See isSolid.
+     * @param scene The scene to query.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param worldPosition The position in world space.
+     * @param cursor The cursor of the previous query, use one cursor per thread.
+     * @return The chunk, position and color of the voxel.
+     */
+    VoxelQueryResult getVoxel(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 worldPosition, VoxelQueryCursor& cursor);
+
+    /**
+     * Runs isSolid for many positions, spread over several threads. Every thread walks its share of the positions in order with its own cursor,
+     * so positions close to their neighbours in the array are the fastest. An exception thrown by a query is rethrown once every thread has finished.
+     * @param scene The scene to query.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param worldPositions The positions in world space.
+     * @param solid Receives 1 for every solid position and 0 for every empty one.
+     * @param count The number of positions.
+     * @param threadCount The number of threads to use, 0 uses every hardware thread.
+     */
+    void isSolidBatch(const Scene& scene, const SceneBVH& sceneBVH, const core::vec3* worldPositions, uint8_t* solid, size_t count, int threadCount = 0);
+
+    /**
+     * Runs getVoxel for many positions, spread over several threads. See isSolidBatch.
+     * @param scene The scene to query.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param worldPositions The positions in world space.
+     * @param results Receives one result per position.
+     * @param count The number of positions.
+     * @param threadCount The number of threads to use, 0 uses every hardware thread.
+     */
+    void getVoxelBatch(const Scene& scene, const SceneBVH& sceneBVH, const core::vec3* worldPositions, VoxelQueryResult* results, size_t count, int threadCount = 0);
+
+    /**
+     * Finds every set cell of a tree64 at a level that overlaps a region. Subtrees completely inside the region are taken without testing their cells,
+     * and subtrees outside of it are skipped at the coarsest level possible, so the work grows with the region instead of the tree64.
+     * @param tree64 The serialized tree64.
+     * @param gridResolution The resolution the tree64 was created with. Must be a power of 4 (see hasSingleTree64Root), throws std::invalid_argument otherwise.
+     * @param region The region in the tree64's grid space where every voxel has a size of 1 (see transformVoxelRegionToGrid).
+     * @param ZOrders Receives the Z-Orders of the found cells in ascending order. A cell at level L covers the voxels whose Z-Order shifted right by 6 * L equals it.
+     * @param level 0 finds voxels, 1 the parents of the leaves (4x4x4 voxels each), up to getTree64LevelsOfDepth(gridResolution) for the root.
+     */
+    void findVoxelsInRegionTree64(const std::vector<uint32_t>& tree64, int gridResolution, const VoxelRegion& region, std::vector<uint32_t>& ZOrders, int level = 0);
+
+    /**
+     * Finds every solid voxel, or every occupied cell at a coarser level, of a scene that overlaps a world space region. See findVoxelsInRegionTree64.
+     * @param scene The scene to search. A chunk overlapping the region whose resolution isn't a power of 4 throws std::invalid_argument.
+     * @param sceneBVH The hierarchy over the scene's chunks, it must be up to date (see updateSceneBVH).
+     * @param region The region in world space, created with createBoxVoxelRegion, createSphereVoxelRegion or createFrustumVoxelRegion.
+     * @param level 0 finds voxels, 1 the parents of the leaves (4x4x4 voxels each) and so on.
+     * @return The found cells of every chunk that has any, ordered by chunk index.
+     */
+    std::vector<ChunkRegionCells> findVoxelsInRegion(const Scene& scene, const SceneBVH& sceneBVH, const VoxelRegion& region, int level = 0);
+}
+
+#endif
@@ -54,13 +54,14 @@ namespace projv::graphics {
         if(maxTextureSize < textureHeight) {
             textureHeight = maxTextureSize;
         }
-        int pixelSize = data.size() / 4;
+        int pixelSize = (data.size() + 3) / 4;
         int dataWidth = (pixelSize / textureHeight);
         core::info("createArbitraryTexture: Creating texture with height {}px", textureHeight);
         core::info("createArbitraryTexture: Creating texture with width {}px", dataWidth);
         if(pixelSize % textureHeight != 0) {
             dataWidth += 1;
         } 
+        data.resize(size_t(dataWidth) * textureHeight * 4); // The copy covers the whole texture.
         const bgfx::Memory* dataMemory = bgfx::copy(data.data(), dataWidth * textureHeight * sizeof(uint32_t) * 4);
         bgfx::TextureHandle dataTexture = bgfx::createTexture2D(dataWidth, textureHeight, false, 1, bgfx::TextureFormat::RGBA32U, BGFX_TEXTURE_NONE|BGFX_SAMPLER_POINT, dataMemory);
         return dataTexture;
@@ -211,10 +212,51 @@ namespace projv::graphics {
         return headerTexture;
     }
 
-    GPUData createTexturesForScene(projv::Scene& scene) {
+    bgfx::TextureHandle createSceneBVHTexture(const std::vector<projv::GPUSceneBVHNode>& nodes) {
+        int textureWidth = 4096;
+        int maxTextureSize = bgfx::getCaps()->limits.maxTextureSize;
+        if(maxTextureSize < textureWidth) {
+            textureWidth = maxTextureSize;
+        }
+        // Each node is 2 texels, rows are kept even so a node never wraps.
+        int texelCount = nodes.size() * 2;
+        int textureHeight = (texelCount + textureWidth - 1) / textureWidth;
+        if(textureHeight == 1) {
+            textureWidth = texelCount;
+        }
+        std::vector<projv::GPUSceneBVHNode> paddedNodes(size_t(textureWidth) * textureHeight / 2);
+        std::copy(nodes.begin(), nodes.end(), paddedNodes.begin());
+        core::info("createSceneBVHTexture: Creating {}x{}px texture for {} nodes", textureWidth, textureHeight, nodes.size());
+
+        const bgfx::Memory* nodeMemory = bgfx::copy(paddedNodes.data(), paddedNodes.size() * sizeof(projv::GPUSceneBVHNode));
+        return bgfx::createTexture2D(textureWidth, textureHeight, false, 1, bgfx::TextureFormat::RGBA32U, BGFX_TEXTURE_NONE|BGFX_SAMPLER_POINT, nodeMemory);
+    }
+
+    void createSceneSamplers(GPUData& gpuData) {
+        gpuData.tree64Sampler = bgfx::createUniform("tree64Data", bgfx::UniformType::Sampler);
+        gpuData.voxelTypeDataSampler = bgfx::createUniform("voxelTypeData", bgfx::UniformType::Sampler);
+        gpuData.headerSampler = bgfx::createUniform("headerData", bgfx::UniformType::Sampler);
+        gpuData.sceneBVHSampler = bgfx::createUniform("sceneBVHData", bgfx::UniformType::Sampler);
+        gpuData.visibleChunkSampler = bgfx::createUniform("visibleChunkData", bgfx::UniformType::Sampler);
+        gpuData.nodeColorSampler = bgfx::createUniform("nodeColorData", bgfx::UniformType::Sampler);
+    }
+
+    bgfx::TextureHandle createSceneBVHTextureForScene(const projv::Scene& scene, const projv::SceneBVH* sceneBVH) {
+        projv::SceneBVH builtSceneBVH;
+        if(sceneBVH == nullptr) {
+            builtSceneBVH = utils::createSceneBVH(scene);
+            sceneBVH = &builtSceneBVH;
+        }
+        std::vector<projv::GPUSceneBVHNode> sceneBVHNodes = utils::createGPUSceneBVH(*sceneBVH);
+        core::info("createTexturesForScene: Creating scene BVH texture ({} nodes)", sceneBVHNodes.size());
+        return createSceneBVHTexture(sceneBVHNodes);
+    }
+
+    GPUData createTexturesForScene(projv::Scene& scene, bool implicitVoxelAttributes, const projv::SceneBVH* sceneBVH) {
         GPUData gpuData;
         std::vector<uint32_t> tree64Data;
         std::vector<uint32_t> voxelTypeData;
+        std::vector<uint32_t> nodeColorData;
         std::vector<projv::GPUChunkHeader> gpuChunkHeaderData;
         // Combine the voxelTypeData, tree64, and headers for each chunk into just 3 vectors.
         for(size_t i = 0; i < scene.chunks.size(); i++) {
@@ -222,15 +264,29 @@ namespace projv::graphics {
             int tree64StartIndex = tree64Data.size();
             int voxelTypeDataStartIndex = voxelTypeData.size();
 
-            tree64Data.insert(tree64Data.end(), scene.chunks[i].geometryData.begin(), scene.chunks[i].geometryData.end());
-            for(size_t j = 0; j < scene.chunks[i].geometryData.size(); j++) {
-                //tree64Data.emplace_back(scene.chunks[i].geometryData[j]);
+            if(implicitVoxelAttributes) {
+                // The chunk keeps its regular format, offsets are only written into the uploaded copy.
+                std::vector<uint32_t> geometryData = scene.chunks[i].geometryData;
+                utils::addAttributeOffsetsTree64(geometryData);
+                std::vector<uint32_t> voxelAttributeData = utils::createVoxelAttributeData(scene.chunks[i].voxelTypeData);
+                tree64Data.insert(tree64Data.end(), geometryData.begin(), geometryData.end());
+                voxelTypeData.insert(voxelTypeData.end(), voxelAttributeData.begin(), voxelAttributeData.end());
+            } else {
+                tree64Data.insert(tree64Data.end(), scene.chunks[i].geometryData.begin(), scene.chunks[i].geometryData.end());
+                voxelTypeData.insert(voxelTypeData.end(), scene.chunks[i].voxelTypeData.begin(), scene.chunks[i].voxelTypeData.end());
             }
-            voxelTypeData.insert(voxelTypeData.end(), scene.chunks[i].voxelTypeData.begin(), scene.chunks[i].voxelTypeData.end());
 
             int tree64EndIndex = tree64Data.size();
             int voxelTypeDataEndIndex = voxelTypeData.size();
 
+            // Chunks without a color for every node can't be cut off above their voxels, the shader always descends to their voxels.
+            const std::vector<uint32_t>& chunkNodeColors = scene.chunks[i].nodeColorData;
+            uint32_t nodeColorStartIndex = UINT32_MAX;
+            if(!chunkNodeColors.empty() && chunkNodeColors.size() * 3 == scene.chunks[i].geometryData.size()) {
+                nodeColorStartIndex = uint32_t(nodeColorData.size());
+                nodeColorData.insert(nodeColorData.end(), chunkNodeColors.begin(), chunkNodeColors.end());
+            }
+
             projv::GPUChunkHeader gpuChunkHeader;
             gpuChunkHeader.chunkID = scene.chunks[i].header.chunkID;
             gpuChunkHeader.geometryStartIndex = tree64StartIndex / 3;
@@ -242,8 +298,8 @@ namespace projv::graphics {
             gpuChunkHeader.positionZ = scene.chunks[i].header.position.z;
             gpuChunkHeader.resolution = scene.chunks[i].header.resolution;
             gpuChunkHeader.scale = scene.chunks[i].header.scale;
-            gpuChunkHeader.padding[0] = 0;
-            gpuChunkHeader.padding[1] = 0;
+            gpuChunkHeader.nodeColorStartIndex = nodeColorStartIndex;
+            gpuChunkHeader.padding = 0;
 
             gpuChunkHeaderData.emplace_back(gpuChunkHeader);
         }
@@ -254,11 +310,167 @@ namespace projv::graphics {
         gpuData.voxelTypeDataTexture = createArbitraryTexture(voxelTypeData);
         core::info("createTexturesForScene: Creating chunk header texture ({} chunks)", gpuChunkHeaderData.size());
         gpuData.headerTexture = createHeaderTexture(gpuChunkHeaderData);
+        core::info("createTexturesForScene: Creating node color texture ({} values)", nodeColorData.size());
+        if(nodeColorData.empty()) {
+            nodeColorData.emplace_back(0); // Textures can't be empty, no header points at it.
+        }
+        gpuData.nodeColorTexture = createArbitraryTexture(nodeColorData);
+        gpuData.sceneBVHTexture = createSceneBVHTextureForScene(scene, sceneBVH);
+        gpuData.visibleChunkTexture = createVisibleChunkTexture(uint32_t(gpuChunkHeaderData.size()));
+        gpuData.visibleChunkCapacity = uint32_t(gpuChunkHeaderData.size());
+        createSceneSamplers(gpuData);
 
-        gpuData.tree64Sampler = bgfx::createUniform("tree64Data", bgfx::UniformType::Sampler);
-        gpuData.voxelTypeDataSampler = bgfx::createUniform("voxelTypeData", bgfx::UniformType::Sampler);
-        gpuData.headerSampler = bgfx::createUniform("headerData", bgfx::UniformType::Sampler);
+        return gpuData;
+    }
+
+    // Textures created with data are immutable in bgfx, the persistent scene textures are created empty and filled with bgfx::updateTexture2D.
+    bgfx::TextureHandle createUpdatableTexture(uint32_t textureWidth, uint32_t textureHeight) {
+        return bgfx::createTexture2D(uint16_t(textureWidth), uint16_t(textureHeight), false, 1, bgfx::TextureFormat::RGBA32U, BGFX_TEXTURE_NONE|BGFX_SAMPLER_POINT);
+    }
+
+    // The texels of a chunk in a scene texture, 4 uint32_t's each, packed the way the shader reads them.
+    std::vector<uint32_t> createChunkTexels(const projv::Chunk& chunk, projv::GPUSceneTexture texture, bool implicitVoxelAttributes, uint32_t texelCount) {
+        std::vector<uint32_t> texels(size_t(texelCount) * 4, 0);
+        if(texture == projv::GPUSceneTexture::Tree64) {
+            const std::vector<uint32_t>* geometryData = &chunk.geometryData;
+            std::vector<uint32_t> geometryDataWithOffsets;
+            if(implicitVoxelAttributes) {
+                // The chunk keeps its regular format, offsets are only written into the uploaded copy.
+                geometryDataWithOffsets = chunk.geometryData;
+                utils::addAttributeOffsetsTree64(geometryDataWithOffsets);
+                geometryData = &geometryDataWithOffsets;
+            }
+            for(size_t i = 0; i < geometryData->size() / 3; i++) {
+                std::copy(geometryData->begin() + i * 3, geometryData->begin() + i * 3 + 3, texels.begin() + i * 4);
+            }
+        } else if(texture == projv::GPUSceneTexture::VoxelTypeData && implicitVoxelAttributes) {
+            std::vector<uint32_t> voxelAttributeData = utils::createVoxelAttributeData(chunk.voxelTypeData);
+            std::copy(voxelAttributeData.begin(), voxelAttributeData.end(), texels.begin());
+        } else {
+            const std::vector<uint32_t>& values = texture == projv::GPUSceneTexture::VoxelTypeData ? chunk.voxelTypeData : chunk.nodeColorData;
+            std::copy(values.begin(), values.end(), texels.begin());
+        }
+        return texels;
+    }
 
+    // Writes texels into a range of a texture, one bgfx::updateTexture2D per rectangle of the range.
+    size_t uploadTexelRange(bgfx::TextureHandle texture, uint32_t textureWidth, projv::TexelRange range, const uint32_t* texels) {
+        constexpr uint32_t texelBytes = sizeof(uint32_t) * 4;
+        for(const projv::TextureRectangle& rectangle : utils::getTexelRangeRectangles(range, textureWidth)) {
+            const bgfx::Memory* texelMemory = bgfx::copy(texels + size_t(rectangle.firstTexel) * 4, rectangle.width * rectangle.height * texelBytes);
+            bgfx::updateTexture2D(texture, 0, 0, uint16_t(rectangle.x), uint16_t(rectangle.y), uint16_t(rectangle.width), uint16_t(rectangle.height), texelMemory);
+        }
+        return size_t(range.count) * texelBytes;
+    }
+
+    // The visible chunk list wraps into rows of up to 4096 texels, the shader reads the width with textureSize.
+    uint32_t getVisibleChunkTextureWidth(uint32_t chunkCount) {
+        uint64_t texelCount = uint64_t(chunkCount) + 1;
+        uint64_t maxTextureSize = bgfx::getCaps()->limits.maxTextureSize;
+        uint64_t textureWidth = std::min({texelCount, uint64_t(4096), maxTextureSize});
+        uint64_t textureHeight = (texelCount + textureWidth - 1) / textureWidth;
+        if(textureHeight > maxTextureSize) {
+            throw std::invalid_argument("createVisibleChunkTexture: " + std::to_string(chunkCount) + " chunks need a " + std::to_string(textureWidth) + "x" + std::to_string(textureHeight) +
+                                        " texture, more than the GPU's maxTextureSize (" + std::to_string(maxTextureSize) + ")");
+        }
+        return uint32_t(textureWidth);
+    }
+
+    bgfx::TextureHandle createVisibleChunkTexture(uint32_t chunkCount) {
+        uint32_t textureWidth = getVisibleChunkTextureWidth(chunkCount);
+        uint32_t textureHeight = uint32_t((uint64_t(chunkCount) + textureWidth) / textureWidth);
+        std::vector<projv::GPUVisibleChunk> texels(size_t(chunkCount) + 1);
+        texels[0] = {chunkCount, 0.0f, {0, 0}};
+        for(uint32_t i = 0; i < chunkCount; i++) {
+            texels[i + 1] = {i, 0.0f, {0, 0}};
+        }
+        // Created without data so updateVisibleChunkTexture can write into it, bgfx textures made from memory are immutable.
+        bgfx::TextureHandle texture = createUpdatableTexture(textureWidth, textureHeight);
+        uploadTexelRange(texture, textureWidth, {0, uint32_t(texels.size())}, reinterpret_cast<const uint32_t*>(texels.data()));
+        return texture;
+    }
+
+    void updateVisibleChunkTexture(GPUData& gpuData, const std::vector<projv::GPUVisibleChunk>& visibleChunks) {
+        if(visibleChunks.size() > gpuData.visibleChunkCapacity) {
+            throw std::invalid_argument("updateVisibleChunkTexture: " + std::to_string(visibleChunks.size()) + " visible chunks don't fit in a texture made for " + std::to_string(gpuData.visibleChunkCapacity));
+        }
+        std::vector<projv::GPUVisibleChunk> texels(visibleChunks.size() + 1);
+        texels[0] = {uint32_t(visibleChunks.size()), 0.0f, {0, 0}};
+        std::copy(visibleChunks.begin(), visibleChunks.end(), texels.begin() + 1);
+        uploadTexelRange(gpuData.visibleChunkTexture, getVisibleChunkTextureWidth(gpuData.visibleChunkCapacity), {0, uint32_t(texels.size())}, reinterpret_cast<const uint32_t*>(texels.data()));
+    }
+
+    GPUData createTexturesForScene(projv::Scene& scene, projv::GPUSceneLayout& layout, const projv::SceneBVH* sceneBVH) {
+        if(!layout.placements.empty()) {
+            throw std::invalid_argument("createTexturesForScene: The layout already placed chunks in other textures");
+        }
+        uint32_t maxTextureSize = bgfx::getCaps()->limits.maxTextureSize;
+        layout.settings.maxTextureRows = std::min(layout.settings.maxTextureRows, maxTextureSize);
+        if(layout.settings.textureWidth > maxTextureSize || layout.settings.initialTextureRows > layout.settings.maxTextureRows) {
+            throw std::invalid_argument("createTexturesForScene: Scene textures of " + std::to_string(layout.settings.textureWidth) + "x" + std::to_string(layout.settings.initialTextureRows) +
+                                        " texels are larger than the GPU's maxTextureSize (" + std::to_string(maxTextureSize) + ")");
+        }
+
+        GPUData gpuData;
+        gpuData.tree64Texture = createUpdatableTexture(layout.settings.textureWidth, utils::getGPUSceneTextureRows(layout, projv::GPUSceneTexture::Tree64));
+        gpuData.voxelTypeDataTexture = createUpdatableTexture(layout.settings.textureWidth, utils::getGPUSceneTextureRows(layout, projv::GPUSceneTexture::VoxelTypeData));
+        gpuData.nodeColorTexture = createUpdatableTexture(layout.settings.textureWidth, utils::getGPUSceneTextureRows(layout, projv::GPUSceneTexture::NodeColor));
+        gpuData.headerTexture = BGFX_INVALID_HANDLE;
+        gpuData.sceneBVHTexture = BGFX_INVALID_HANDLE;
+        gpuData.visibleChunkTexture = BGFX_INVALID_HANDLE;
+        gpuData.visibleChunkCapacity = 0;
+        createSceneSamplers(gpuData);
+
+        size_t uploadedBytes = updateTexturesForScene(gpuData, layout, scene, sceneBVH);
+        core::info("createTexturesForScene: Uploaded {} chunks into {}px wide scene textures ({} bytes)", scene.chunks.size(), layout.settings.textureWidth, uploadedBytes);
         return gpuData;
     }
+
+    size_t updateTexturesForScene(GPUData& gpuData, projv::GPUSceneLayout& layout, projv::Scene& scene, const projv::SceneBVH* sceneBVH) {
+        projv::GPUSceneLayoutUpdate update = utils::updateGPUSceneLayout(layout, scene);
+        std::array<bgfx::TextureHandle*, projv::GPU_SCENE_TEXTURE_COUNT> textures = {&gpuData.tree64Texture, &gpuData.voxelTypeDataTexture, &gpuData.nodeColorTexture};
+        for(uint32_t texture = 0; texture < projv::GPU_SCENE_TEXTURE_COUNT; texture++) {
+            if(update.resizedTextures[texture]) {
+                bgfx::destroy(*textures[texture]);
+                *textures[texture] = createUpdatableTexture(layout.settings.textureWidth, utils::getGPUSceneTextureRows(layout, projv::GPUSceneTexture(texture)));
+            }
+        }
+
+        size_t uploadedBytes = 0;
+        for(const projv::GPUTextureWrite& write : update.writes) {
+            std::vector<uint32_t> texels = createChunkTexels(scene.chunks[write.chunkIndex], write.texture, layout.settings.implicitVoxelAttributes, write.range.count);
+            uploadedBytes += uploadTexelRange(*textures[size_t(write.texture)], layout.settings.textureWidth, write.range, texels.data());
+        }
+
+        // The header texture is one row of 3 texels per chunk. A scene without chunks keeps one zeroed header, textures can't be empty.
+        uint32_t headerCount = uint32_t(layout.headers.size());
+        if(update.headerCountChanged || !bgfx::isValid(gpuData.headerTexture)) {
+            uint32_t maxTextureSize = bgfx::getCaps()->limits.maxTextureSize;
+            if(uint64_t(std::max(headerCount, 1u)) * 3 > maxTextureSize) {
+                throw std::invalid_argument("updateTexturesForScene: The header texture of " + std::to_string(headerCount) + " chunks is " + std::to_string(uint64_t(headerCount) * 3) +
+                                            " texels wide, more than the GPU's maxTextureSize (" + std::to_string(maxTextureSize) + ")");
+            }
+            getVisibleChunkTextureWidth(headerCount);
+            if(bgfx::isValid(gpuData.headerTexture)) {
+                bgfx::destroy(gpuData.headerTexture);
+                bgfx::destroy(gpuData.visibleChunkTexture);
+            }
+            std::vector<projv::GPUChunkHeader> headers = layout.headers;
+            headers.resize(std::max(headerCount, 1u), projv::GPUChunkHeader{});
+            gpuData.headerTexture = createUpdatableTexture(uint32_t(headers.size()) * 3, 1);
+            uploadedBytes += uploadTexelRange(gpuData.headerTexture, uint32_t(headers.size()) * 3, {0, uint32_t(headers.size()) * 3}, reinterpret_cast<const uint32_t*>(headers.data()));
+            gpuData.visibleChunkTexture = createVisibleChunkTexture(headerCount);
+            gpuData.visibleChunkCapacity = headerCount;
+        } else if(update.changedHeaders.count > 0) {
+            projv::TexelRange changedTexels = {update.changedHeaders.first * 3, update.changedHeaders.count * 3};
+            uploadedBytes += uploadTexelRange(gpuData.headerTexture, headerCount * 3, changedTexels, reinterpret_cast<const uint32_t*>(layout.headers.data() + update.changedHeaders.first));
+        }
+
+        if(bgfx::isValid(gpuData.sceneBVHTexture)) {
+            bgfx::destroy(gpuData.sceneBVHTexture);
+        }
+        gpuData.sceneBVHTexture = createSceneBVHTextureForScene(scene, sceneBVH);
+        core::info("updateTexturesForScene: Uploaded {} chunk ranges and {} headers ({} bytes)", update.writes.size(), update.changedHeaders.count, uploadedBytes);
+        return uploadedBytes;
+    }
 }
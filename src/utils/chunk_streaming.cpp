@@ -0,0 +1,231 @@
+#include "utils/chunk_streaming.h"
+
+namespace projv::utils {
+    // Bytes of the LOD 0 data of a chunk file, from its leading element count. The level table and lower LODs after it aren't loaded.
+    size_t getChunkFileDataSize(const std::string& filePath) {
+        std::ifstream inFile(filePath, std::ios::binary);
+        size_t size = 0;
+        if(!inFile.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+            return 0;
+        }
+        return size * sizeof(uint32_t);
+    }
+
+    size_t getChunkRAMBytes(const Chunk& chunk) {
+        return sizeof(Chunk) + (chunk.geometryData.capacity() + chunk.voxelTypeData.capacity() + chunk.nodeColorData.capacity()) * sizeof(uint32_t);
+    }
+
+    // What createTexturesForScene uploads for the chunk.
+    size_t getChunkGPUBytes(const Chunk& chunk) {
+        return sizeof(GPUChunkHeader) + (chunk.geometryData.size() + chunk.voxelTypeData.size() + chunk.nodeColorData.size()) * sizeof(uint32_t);
+    }
+
+    float getBoundsDistanceToPoint(core::vec3 boundsMin, core::vec3 boundsMax, core::vec3 point) {
+        return core::length(point - core::clamp(point, boundsMin, boundsMax));
+    }
+
+    // The distance to a point moving along a line is convex in time, so a ternary search finds the closest approach.
+    float getBoundsDistanceToSegment(core::vec3 boundsMin, core::vec3 boundsMax, core::vec3 segmentStart, core::vec3 segmentEnd) {
+        float low = 0.0f;
+        float high = 1.0f;
+        for(int i = 0; i < 32; i++) {
+            float lowThird = low + (high - low) / 3.0f;
+            float highThird = high - (high - low) / 3.0f;
+            float lowDistance = getBoundsDistanceToPoint(boundsMin, boundsMax, segmentStart + (segmentEnd - segmentStart) * lowThird);
+            float highDistance = getBoundsDistanceToPoint(boundsMin, boundsMax, segmentStart + (segmentEnd - segmentStart) * highThird);
+            if(lowDistance > highDistance) {
+                low = lowThird;
+            } else {
+                high = highThird;
+            }
+        }
+        return getBoundsDistanceToPoint(boundsMin, boundsMax, segmentStart + (segmentEnd - segmentStart) * ((low + high) * 0.5f));
+    }
+
+    ChunkStreamer::ChunkStreamer(const std::string& sceneFileDirectory, const ChunkStreamingSettings& settings) : sceneFileDirectory(sceneFileDirectory), settings(settings) {
+        if(settings.threadCount == 0) {
+            throw std::invalid_argument("ChunkStreamer: At least one loading thread is needed");
+        }
+        chunkHeaders = loadChunkHeadersFromDisk(sceneFileDirectory);
+        streamedChunks.resize(chunkHeaders.size());
+        for(size_t i = 0; i < chunkHeaders.size(); i++) {
+            std::string chunkFileName = std::to_string(chunkHeaders[i].chunkID) + ".bin";
+            size_t tree64Bytes = getChunkFileDataSize(sceneFileDirectory + "/tree64/" + chunkFileName);
+            size_t nodeColorBytes = tree64Bytes / 3; // loadChunkFromDisk computes one color per node.
+            size_t chunkBytes = tree64Bytes + nodeColorBytes + getChunkFileDataSize(sceneFileDirectory + "/voxelTypeData/" + chunkFileName);
+            streamedChunks[i] = {StreamedChunkState::OnDisk, sizeof(Chunk) + chunkBytes, sizeof(GPUChunkHeader) + chunkBytes, 0, INFINITY};
+        }
+        core::info("ChunkStreamer: Streaming {} chunks from {} with {} loading threads", chunkHeaders.size(), sceneFileDirectory, settings.threadCount);
+
+        for(uint32_t i = 0; i < settings.threadCount; i++) {
+            loadingThreads.emplace_back(&ChunkStreamer::loadChunks, this);
+        }
+    }
+
+    ChunkStreamer::~ChunkStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        loadRequested.notify_all();
+        for(std::thread& thread : loadingThreads) {
+            thread.join();
+        }
+    }
+
+    void ChunkStreamer::loadChunks() {
+        while(true) {
+            size_t chunkIndex;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                loadRequested.wait(lock, [this] { return stopping || !loadQueue.empty(); });
+                if(stopping) {
+                    return;
+                }
+                chunkIndex = loadQueue.front();
+                loadQueue.pop_front();
+                streamedChunks[chunkIndex].state = StreamedChunkState::Loading;
+            }
+            Chunk chunk = loadChunkFromDisk(sceneFileDirectory, chunkHeaders[chunkIndex]);
+            std::lock_guard<std::mutex> lock(mutex);
+            finishedChunks.emplace_back(chunkIndex, std::move(chunk));
+        }
+    }
+
+    // Evicts the chunk that has been out of view the longest, the farthest one if several left view at once. Chunks in view this frame and chunks no farther than fartherThan stay.
+    // Must be called with the mutex locked.
+    bool ChunkStreamer::evictChunk(Scene& scene, float fartherThan) {
+        size_t evictedIndex = SIZE_MAX;
+        for(size_t i = 0; i < streamedChunks.size(); i++) {
+            const StreamedChunk& streamedChunk = streamedChunks[i];
+            if(streamedChunk.state != StreamedChunkState::Resident || streamedChunk.lastVisibleFrame == frame || !(streamedChunk.distance > fartherThan)) {
+                continue;
+            }
+            if(evictedIndex == SIZE_MAX || streamedChunk.lastVisibleFrame < streamedChunks[evictedIndex].lastVisibleFrame ||
+               (streamedChunk.lastVisibleFrame == streamedChunks[evictedIndex].lastVisibleFrame && streamedChunk.distance > streamedChunks[evictedIndex].distance)) {
+                evictedIndex = i;
+            }
+        }
+        if(evictedIndex == SIZE_MAX) {
+            return false;
+        }
+
+        uint32_t chunkID = chunkHeaders[evictedIndex].chunkID;
+        auto it = std::find_if(scene.chunks.begin(), scene.chunks.end(), [chunkID](const Chunk& chunk) { return chunk.header.chunkID == chunkID; });
+        if(it != scene.chunks.end()) {
+            *it = std::move(scene.chunks.back());
+            scene.chunks.pop_back();
+        } else {
+            core::warn("ChunkStreamer: Chunk {} was removed from the scene by something other than the streamer", chunkID);
+        }
+        StreamedChunk& streamedChunk = streamedChunks[evictedIndex];
+        residentChunks--;
+        residentRAMBytes -= streamedChunk.ramBytes;
+        residentGPUBytes -= streamedChunk.gpuBytes;
+        streamedChunk.state = StreamedChunkState::OnDisk;
+        evictedChunks++;
+        return true;
+    }
+
+    bool ChunkStreamer::update(Scene& scene, core::vec3 cameraPosition, core::vec3 cameraVelocity, const core::mat4& viewProjection, bool homogeneousDepth) {
+        frame++;
+        bool sceneChanged = false;
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // Chunks read since the last update join the scene, with their actual sizes in place of the estimates.
+        for(std::pair<size_t, Chunk>& finishedChunk : finishedChunks) {
+            StreamedChunk& streamedChunk = streamedChunks[finishedChunk.first];
+            pendingChunks--;
+            pendingRAMBytes -= streamedChunk.ramBytes;
+            pendingGPUBytes -= streamedChunk.gpuBytes;
+            streamedChunk.state = StreamedChunkState::Resident;
+            streamedChunk.ramBytes = getChunkRAMBytes(finishedChunk.second);
+            streamedChunk.gpuBytes = getChunkGPUBytes(finishedChunk.second);
+            residentChunks++;
+            residentRAMBytes += streamedChunk.ramBytes;
+            residentGPUBytes += streamedChunk.gpuBytes;
+            loadedChunks++;
+            scene.chunks.emplace_back(std::move(finishedChunk.second));
+            sceneChanged = true;
+        }
+        finishedChunks.clear();
+
+        // Queued chunks are ordered again below, the camera may have turned since.
+        for(size_t chunkIndex : loadQueue) {
+            StreamedChunk& streamedChunk = streamedChunks[chunkIndex];
+            streamedChunk.state = StreamedChunkState::OnDisk;
+            pendingChunks--;
+            pendingRAMBytes -= streamedChunk.ramBytes;
+            pendingGPUBytes -= streamedChunk.gpuBytes;
+        }
+        loadQueue.clear();
+
+        VoxelRegion frustum = createFrustumVoxelRegion(viewProjection, homogeneousDepth);
+        core::vec3 predictedPosition = cameraPosition + cameraVelocity * settings.predictionTime;
+        std::vector<size_t> candidates;
+        for(size_t i = 0; i < chunkHeaders.size(); i++) {
+            StreamedChunk& streamedChunk = streamedChunks[i];
+            core::vec3 boundsMin = chunkHeaders[i].position;
+            core::vec3 boundsMax = chunkHeaders[i].position + core::vec3(chunkHeaders[i].scale);
+            streamedChunk.distance = getBoundsDistanceToSegment(boundsMin, boundsMax, cameraPosition, predictedPosition);
+            if(streamedChunk.state == StreamedChunkState::Resident && classifyBoundsInVoxelRegion(frustum, boundsMin, boundsMax) != VoxelRegionOverlap::Outside) {
+                streamedChunk.lastVisibleFrame = frame;
+            }
+            if(streamedChunk.state == StreamedChunkState::OnDisk && streamedChunk.distance <= settings.loadDistance) {
+                candidates.emplace_back(i);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](size_t a, size_t b) { return streamedChunks[a].distance < streamedChunks[b].distance; });
+
+        // Loads that finished bigger than estimated can leave the budgets exceeded.
+        while((residentRAMBytes + pendingRAMBytes > settings.ramBudget || residentGPUBytes + pendingGPUBytes > settings.gpuBudget) && evictChunk(scene, -INFINITY)) {
+            sceneChanged = true;
+        }
+
+        // Nearest chunks first. A chunk only makes room by evicting chunks farther away than itself, so near chunks can't push each other out every frame.
+        for(size_t chunkIndex : candidates) {
+            if(pendingChunks >= settings.maxQueuedChunks) {
+                break;
+            }
+            StreamedChunk& streamedChunk = streamedChunks[chunkIndex];
+            bool fits = true;
+            while(residentRAMBytes + pendingRAMBytes + streamedChunk.ramBytes > settings.ramBudget || residentGPUBytes + pendingGPUBytes + streamedChunk.gpuBytes > settings.gpuBudget) {
+                if(!evictChunk(scene, streamedChunk.distance)) {
+                    fits = false;
+                    break;
+                }
+                sceneChanged = true;
+            }
+            if(!fits) {
+                break; // Farther chunks wouldn't fit either.
+            }
+            streamedChunk.state = StreamedChunkState::Queued;
+            pendingChunks++;
+            pendingRAMBytes += streamedChunk.ramBytes;
+            pendingGPUBytes += streamedChunk.gpuBytes;
+            loadQueue.emplace_back(chunkIndex);
+        }
+        bool loadsQueued = !loadQueue.empty();
+        lock.unlock();
+        if(loadsQueued) {
+            loadRequested.notify_all();
+        }
+        return sceneChanged;
+    }
+
+    const std::vector<ChunkHeader>& ChunkStreamer::getChunkHeaders() const {
+        return chunkHeaders;
+    }
+
+    ChunkStreamingStatistics ChunkStreamer::getStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        ChunkStreamingStatistics statistics;
+        statistics.residentChunks = residentChunks;
+        statistics.loadingChunks = pendingChunks;
+        statistics.residentRAMBytes = residentRAMBytes;
+        statistics.residentGPUBytes = residentGPUBytes;
+        statistics.loadedChunks = loadedChunks;
+        statistics.evictedChunks = evictedChunks;
+        return statistics;
+    }
+}
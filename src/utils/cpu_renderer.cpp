@@ -0,0 +1,436 @@
+#include "utils/cpu_renderer.h"
+
+namespace projv::utils {
+    constexpr float PI = 3.14159265f;
+    constexpr float SUN_SOLID_ANGLE = PI / 1200.0f; // Same sun as path_trace.frag.
+    constexpr float SPECULAR_CHANCE = 0.6f;
+    constexpr float SPECULAR_SMOOTHNESS = 21.0f;
+    constexpr float DIFFUSE_CHANCE = 1.0f;
+    constexpr float SPECULAR_F0 = 0.4f;
+
+    struct CPURenderContext { // What every tile of a render shares.
+        const Scene* scene;
+        const SceneBVH* sceneBVH;
+        const CPURenderSettings* settings;
+        core::vec3 cameraPosition;
+        core::vec3 forward;
+        core::vec3 right;
+        core::vec3 up;
+        float cosSunThetaMax;
+    };
+
+    struct TileQueue {
+        std::mutex mutex;
+        std::deque<uint32_t> tiles;
+    };
+
+    // PCG hash, used to give every pixel its own random sequence so renders don't depend on the thread that ran a tile.
+    uint32_t hashUint32(uint32_t value) {
+        uint32_t state = value * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    struct RandomSequence {
+        uint32_t state;
+
+        float next() {
+            state = hashUint32(state);
+            return float(state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    core::vec3 reflectDirection(core::vec3 direction, core::vec3 normal) {
+        return direction - 2.0f * core::dot(normal, direction) * normal;
+    }
+
+    float fresnelSchlick(float cosTheta, float F0) {
+        return F0 + (1.0f - F0) * powf(1.0f - cosTheta, 5.0f);
+    }
+
+    float specularBRDF(core::vec3 incomingDirection, core::vec3 outgoingDirection, core::vec3 normal) {
+        float cosineBetweenPerfectAndActual = std::max(0.0f, core::dot(outgoingDirection, reflectDirection(incomingDirection, normal)));
+        return (SPECULAR_SMOOTHNESS + 1.0f) / (2.0f * PI) * powf(cosineBetweenPerfectAndActual, SPECULAR_SMOOTHNESS);
+    }
+
+    // Builds the basis path_trace.frag samples hemispheres in, with N as the z axis.
+    core::vec3 rotateToBasis(core::vec3 localDirection, core::vec3 N) {
+        core::vec3 T = fabsf(N.z) < 0.999f ? core::normalize(core::cross(core::vec3(0.0f, 0.0f, 1.0f), N)) : core::normalize(core::cross(core::vec3(0.0f, 1.0f, 0.0f), N));
+        core::vec3 B = core::cross(N, T);
+        return T * localDirection.x + B * localDirection.y + N * localDirection.z;
+    }
+
+    core::vec3 getVoxelAlbedo(const Chunk& chunk, const RayHit& hit) {
+        if(hit.voxelTypeDataIndex == UINT32_MAX) {
+            return core::vec3(1.0f);
+        }
+        uint32_t serializedColor = chunk.voxelTypeData[size_t(hit.voxelTypeDataIndex) * 3 + 1];
+        return core::vec3(float((serializedColor >> 20) & 0x3FF), float((serializedColor >> 10) & 0x3FF), float(serializedColor & 0x3FF)) / 1023.0f;
+    }
+
+    // One sample of the radiance coming back along a camera ray, following castRay in path_trace.frag.
+    core::vec3 traceCPURenderSample(const CPURenderContext& context, Ray ray, RandomSequence& random) {
+        const CPURenderSettings& settings = *context.settings;
+        float mixtureValue = SPECULAR_CHANCE / (DIFFUSE_CHANCE + SPECULAR_CHANCE);
+        float pdfNEE = 1.0f / SUN_SOLID_ANGLE;
+
+        core::vec3 radiance(0.0f);
+        core::vec3 throughput(1.0f);
+        float balanceHeuristicBRDF = 1.0f;
+        for(uint32_t step = 0; step < settings.bounces + 1; step++) {
+            SceneRayHit sceneHit = castRayThroughScene(*context.scene, *context.sceneBVH, ray, settings.maxRaySteps);
+            const RayHit& hit = sceneHit.voxelHit;
+            if(!hit.hit || hit.distance <= 0.0f) { // Ray hits the sky, rays starting inside a voxel do too like on the GPU.
+                if(core::dot(settings.sunDirection, ray.direction) >= context.cosSunThetaMax) {
+                    radiance += balanceHeuristicBRDF * throughput * settings.sunRadiance;
+                } else {
+                    radiance += throughput * settings.skyRadiance;
+                }
+                break;
+            }
+            core::vec3 normal = core::vec3(hit.normal);
+            core::vec3 intersectPoint = ray.origin + ray.direction * hit.distance + normal * 0.01f;
+            core::vec3 albedo = getVoxelAlbedo(context.scene->chunks[sceneHit.chunkIndex], hit);
+            core::vec3 perfectReflection = reflectDirection(ray.direction, normal);
+
+            // Pick diffuse or specular and sample the next direction around the normal or the mirror direction.
+            bool doSpecular = random.next() <= mixtureValue;
+            float phi = random.next() * 2.0f * PI;
+            float randomTheta = random.next();
+            float cosTheta = doSpecular ? powf(randomTheta, 1.0f / (SPECULAR_SMOOTHNESS + 1.0f)) : sqrtf(1.0f - randomTheta);
+            float sinTheta = sqrtf(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+            core::vec3 N = doSpecular ? core::normalize(perfectReflection) : normal;
+            core::vec3 nextDirection = rotateToBasis(core::vec3(cosf(phi) * sinTheta, sinf(phi) * sinTheta, cosTheta), N);
+
+            float cosThetaBetweenNextDirectionAndNormal = core::dot(nextDirection, normal);
+            if(cosThetaBetweenNextDirectionAndNormal <= 0.0f) {
+                break;
+            }
+            float pdfBRDF = doSpecular
+                ? std::max(0.001f, mixtureValue * (SPECULAR_SMOOTHNESS + 1.0f) / (2.0f * PI) * powf(std::max(0.0f, core::dot(perfectReflection, nextDirection)), SPECULAR_SMOOTHNESS))
+                : std::max(0.001f, cosThetaBetweenNextDirectionAndNormal / PI * (1.0f - mixtureValue));
+            core::vec3 diffuseTerm = albedo / PI * cosThetaBetweenNextDirectionAndNormal;
+            core::vec3 specularTerm = albedo * specularBRDF(ray.direction, nextDirection, normal) * fresnelSchlick(cosThetaBetweenNextDirectionAndNormal, SPECULAR_F0);
+            core::vec3 BRDF = diffuseTerm + core::max(core::vec3(0.0f), specularTerm);
+
+            // Next event estimation, sample a direction in the cone of the sun and cast a shadow ray.
+            float cosThetaNEE = context.cosSunThetaMax + (1.0f - context.cosSunThetaMax) * random.next();
+            float sinThetaNEE = sqrtf(std::max(0.0f, 1.0f - cosThetaNEE * cosThetaNEE));
+            float phiNEE = 2.0f * PI * random.next();
+            core::vec3 sunTangent = core::normalize(core::cross(core::vec3(0.0f, 1.0f, 0.0f), settings.sunDirection));
+            core::vec3 sunBitangent = core::cross(settings.sunDirection, sunTangent);
+            core::vec3 NEEDirection = sunTangent * (cosf(phiNEE) * sinThetaNEE) + sunBitangent * (sinf(phiNEE) * sinThetaNEE) + settings.sunDirection * cosThetaNEE;
+            float cosThetaSurface = core::dot(normal, NEEDirection);
+            if(cosThetaSurface > 0.0f) {
+                core::vec3 diffuseTermNEE = albedo / PI * cosThetaSurface;
+                core::vec3 specularTermNEE = core::max(core::vec3(0.0f), albedo * specularBRDF(ray.direction, NEEDirection, normal) * fresnelSchlick(cosThetaSurface, SPECULAR_F0));
+                float pdfBRDFforNEE = doSpecular
+                    ? std::max(0.00001f, mixtureValue * (SPECULAR_SMOOTHNESS + 1.0f) / (2.0f * PI) * powf(std::max(0.0f, core::dot(perfectReflection, NEEDirection)), SPECULAR_SMOOTHNESS))
+                    : std::max(0.00001f, cosThetaSurface / PI * (1.0f - mixtureValue));
+                Ray NEERay = {intersectPoint + normal * 0.0001f, NEEDirection};
+                if(!castRayThroughScene(*context.scene, *context.sceneBVH, NEERay, settings.maxRaySteps).voxelHit.hit) {
+                    float balanceHeuristicNEE = pdfNEE * pdfNEE / (pdfNEE * pdfNEE + pdfBRDFforNEE * pdfBRDFforNEE);
+                    radiance += core::max(core::vec3(0.0f), balanceHeuristicNEE * settings.sunRadiance * (throughput * (diffuseTermNEE + specularTermNEE)) / pdfNEE);
+                }
+            }
+
+            balanceHeuristicBRDF = pdfBRDF * pdfBRDF / (pdfNEE * pdfNEE + pdfBRDF * pdfBRDF);
+            throughput *= core::max(core::vec3(0.0f), BRDF / pdfBRDF);
+            ray.origin = intersectPoint + normal * 0.0001f;
+            ray.direction = nextDirection;
+        }
+        return radiance;
+    }
+
+    void renderCPUTile(const CPURenderContext& context, CPUImage& image, uint32_t tile, int tilesPerRow) {
+        const CPURenderSettings& settings = *context.settings;
+        int tileX = int(tile % uint32_t(tilesPerRow)) * settings.tileSize;
+        int tileY = int(tile / uint32_t(tilesPerRow)) * settings.tileSize;
+        int tileEndX = std::min(image.width, tileX + settings.tileSize);
+        int tileEndY = std::min(image.height, tileY + settings.tileSize);
+        float aspectRatio = float(image.width) / float(image.height);
+        float scale = tanf(core::radians(settings.fov * 0.5f));
+        uint32_t seedHash = hashUint32(settings.seed);
+
+        for(int y = tileY; y < tileEndY; y++) {
+            for(int x = tileX; x < tileEndX; x++) {
+                size_t pixelIndex = size_t(y) * image.width + x;
+                RandomSequence random = {hashUint32(uint32_t(pixelIndex) ^ seedHash)};
+                core::vec3 pixelRadiance(0.0f);
+                for(uint32_t sample = 0; sample < settings.samplesPerPixel; sample++) {
+                    // Jitter inside the pixel so the samples also anti alias the image.
+                    float pixelX = ((x + random.next()) / image.width * 2.0f - 1.0f) * scale * aspectRatio;
+                    float pixelY = (1.0f - (y + random.next()) / image.height * 2.0f) * scale;
+                    Ray ray = {context.cameraPosition, core::normalize(pixelX * context.right + pixelY * context.up + context.forward)};
+                    core::vec3 sampleRadiance = traceCPURenderSample(context, ray, random);
+                    pixelRadiance += core::clamp(sampleRadiance, core::vec3(0.0f), core::vec3(settings.maxSampleRadiance));
+                }
+                pixelRadiance /= float(settings.samplesPerPixel);
+                image.pixels[pixelIndex * 3 + 0] = pixelRadiance.x;
+                image.pixels[pixelIndex * 3 + 1] = pixelRadiance.y;
+                image.pixels[pixelIndex * 3 + 2] = pixelRadiance.z;
+            }
+        }
+    }
+
+    CPUImage renderSceneOnCPU(const Scene& scene, const SceneBVH& sceneBVH, const Camera& camera, const CPURenderSettings& settings) {
+        if(settings.width <= 0 || settings.height <= 0 || settings.tileSize <= 0 || settings.samplesPerPixel == 0) {
+            throw std::invalid_argument("renderSceneOnCPU: Width, height, tile size and samples per pixel must be above 0");
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+
+        CPURenderContext context;
+        context.scene = &scene;
+        context.sceneBVH = &sceneBVH;
+        context.settings = &settings;
+        context.cameraPosition = core::vec3(camera.position[0], camera.position[1], camera.position[2]);
+        context.forward = core::normalize(core::vec3(camera.direction[0], camera.direction[1], camera.direction[2]));
+        context.right = core::normalize(core::cross(context.forward, core::vec3(camera.up[0], camera.up[1], camera.up[2])));
+        context.up = core::cross(context.right, context.forward);
+        context.cosSunThetaMax = 1.0f - SUN_SOLID_ANGLE / (2.0f * PI);
+
+        CPUImage image;
+        image.width = settings.width;
+        image.height = settings.height;
+        image.pixels.assign(size_t(image.width) * image.height * 3, 0.0f);
+
+        int tilesPerRow = (image.width + settings.tileSize - 1) / settings.tileSize;
+        int tilesPerColumn = (image.height + settings.tileSize - 1) / settings.tileSize;
+        uint32_t tileCount = uint32_t(tilesPerRow * tilesPerColumn);
+        unsigned int workerCount = settings.threadCount > 0 ? settings.threadCount : std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::max(1u, std::min(workerCount, tileCount));
+
+        // Every worker starts with a run of neighbouring tiles. Workers take tiles from the front of their own queue and, once it's empty,
+        // steal from the back of the others, so a thread stuck on an expensive part of the image doesn't hold up the render.
+        std::vector<TileQueue> tileQueues(workerCount);
+        for(uint32_t tile = 0; tile < tileCount; tile++) {
+            tileQueues[size_t(tile) * workerCount / tileCount].tiles.push_back(tile);
+        }
+        std::atomic<uint32_t> stolenTiles(0);
+        auto renderTiles = [&](unsigned int worker) {
+            while(true) {
+                uint32_t tile = UINT32_MAX;
+                {
+                    std::lock_guard<std::mutex> lock(tileQueues[worker].mutex);
+                    if(!tileQueues[worker].tiles.empty()) {
+                        tile = tileQueues[worker].tiles.front();
+                        tileQueues[worker].tiles.pop_front();
+                    }
+                }
+                for(unsigned int i = 1; i < workerCount && tile == UINT32_MAX; i++) {
+                    TileQueue& victim = tileQueues[(worker + i) % workerCount];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if(!victim.tiles.empty()) {
+                        tile = victim.tiles.back();
+                        victim.tiles.pop_back();
+                        stolenTiles++;
+                    }
+                }
+                if(tile == UINT32_MAX) { // No tiles are added during a render, so every queue being empty means we're done.
+                    break;
+                }
+                renderCPUTile(context, image, tile, tilesPerRow);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < workerCount; i++) {
+            workers.emplace_back(renderTiles, i);
+        }
+        renderTiles(0); // The calling thread works too.
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("renderSceneOnCPU: Rendered {}x{} at {} samples per pixel with {} threads in {:.2f}ms ({} tiles, {} stolen)", image.width, image.height, settings.samplesPerPixel, workerCount, elapsed, tileCount, stolenTiles.load());
+        return image;
+    }
+
+    CPUImage renderSceneOnCPU(const Scene& scene, const Camera& camera, const CPURenderSettings& settings) {
+        SceneBVH sceneBVH = createSceneBVH(scene);
+        return renderSceneOnCPU(scene, sceneBVH, camera, settings);
+    }
+
+    bool openImageFile(std::ofstream& outFile, const std::string& filePath, const char* functionName) {
+        std::filesystem::path pathDirectory = std::filesystem::path(filePath).parent_path();
+        if(!pathDirectory.empty() && !std::filesystem::exists(pathDirectory)) {
+            std::filesystem::create_directories(pathDirectory);
+        }
+        outFile.open(filePath, std::ios::binary);
+        if(!outFile) {
+            core::error("{}: Failed to open file for writing: {} (permission denied or path does not exist)", functionName, filePath);
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t updateCRC32(uint32_t crc, const uint8_t* data, size_t size) {
+        static const std::array<uint32_t, 256> CRC32_TABLE = []() {
+            std::array<uint32_t, 256> table;
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t value = i;
+                for(int bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                }
+                table[i] = value;
+            }
+            return table;
+        }();
+        crc = ~crc;
+        for(size_t i = 0; i < size; i++) {
+            crc = CRC32_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void appendUint32BigEndian(std::vector<uint8_t>& bytes, uint32_t value) {
+        bytes.push_back(uint8_t(value >> 24));
+        bytes.push_back(uint8_t(value >> 16));
+        bytes.push_back(uint8_t(value >> 8));
+        bytes.push_back(uint8_t(value));
+    }
+
+    void appendPNGChunk(std::vector<uint8_t>& file, const char* type, const std::vector<uint8_t>& data) {
+        appendUint32BigEndian(file, uint32_t(data.size()));
+        size_t typeStart = file.size();
+        file.insert(file.end(), type, type + 4);
+        file.insert(file.end(), data.begin(), data.end());
+        appendUint32BigEndian(file, updateCRC32(0, file.data() + typeStart, file.size() - typeStart));
+    }
+
+    // ACES approximation and gamma from post_and_display.frag.
+    uint8_t toneMapChannel(float radiance) {
+        float x = std::max(0.0f, radiance);
+        float mapped = std::clamp((x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f), 0.0f, 1.0f);
+        return uint8_t(lroundf(powf(mapped, 1.0f / 3.2f) * 255.0f));
+    }
+
+    bool writeCPUImageToPNG(const CPUImage& image, const std::string& filePath) {
+        if(image.width <= 0 || image.height <= 0 || image.pixels.size() != size_t(image.width) * image.height * 3) {
+            throw std::invalid_argument("writeCPUImageToPNG: Image size doesn't match its pixels");
+        }
+        // Every row starts with filter type 0, the rows are stored in the zlib stream without compression.
+        size_t rowSize = size_t(image.width) * 3 + 1;
+        std::vector<uint8_t> rows(rowSize * image.height);
+        for(int y = 0; y < image.height; y++) {
+            rows[y * rowSize] = 0;
+            for(size_t i = 0; i < size_t(image.width) * 3; i++) {
+                rows[y * rowSize + 1 + i] = toneMapChannel(image.pixels[size_t(y) * image.width * 3 + i]);
+            }
+        }
+
+        std::vector<uint8_t> zlibStream = {0x78, 0x01};
+        size_t offset = 0;
+        do {
+            size_t blockSize = std::min<size_t>(65535, rows.size() - offset);
+            zlibStream.push_back(offset + blockSize == rows.size() ? 1 : 0); // Stored block, 1 marks the last one.
+            zlibStream.push_back(uint8_t(blockSize));
+            zlibStream.push_back(uint8_t(blockSize >> 8));
+            zlibStream.push_back(uint8_t(~blockSize));
+            zlibStream.push_back(uint8_t(~blockSize >> 8));
+            zlibStream.insert(zlibStream.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+            offset += blockSize;
+        } while(offset < rows.size());
+        uint32_t adlerA = 1;
+        uint32_t adlerB = 0;
+        for(uint8_t byte : rows) {
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        appendUint32BigEndian(zlibStream, (adlerB << 16) | adlerA);
+
+        std::vector<uint8_t> header;
+        appendUint32BigEndian(header, uint32_t(image.width));
+        appendUint32BigEndian(header, uint32_t(image.height));
+        header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bit RGB, no interlacing.
+
+        std::vector<uint8_t> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        appendPNGChunk(file, "IHDR", header);
+        appendPNGChunk(file, "IDAT", zlibStream);
+        appendPNGChunk(file, "IEND", {});
+
+        std::ofstream outFile;
+        if(!openImageFile(outFile, filePath, "writeCPUImageToPNG")) {
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char*>(file.data()), file.size());
+        return bool(outFile);
+    }
+
+    template<typename T>
+    void appendLittleEndian(std::vector<uint8_t>& bytes, T value) {
+        uint8_t valueBytes[sizeof(T)];
+        memcpy(valueBytes, &value, sizeof(T));
+        bytes.insert(bytes.end(), valueBytes, valueBytes + sizeof(T)); // OpenEXR is little endian, like every platform we build for.
+    }
+
+    void appendEXRAttribute(std::vector<uint8_t>& file, const char* name, const char* type, const std::vector<uint8_t>& value) {
+        file.insert(file.end(), name, name + strlen(name) + 1);
+        file.insert(file.end(), type, type + strlen(type) + 1);
+        appendLittleEndian<int32_t>(file, int32_t(value.size()));
+        file.insert(file.end(), value.begin(), value.end());
+    }
+
+    bool writeCPUImageToEXR(const CPUImage& image, const std::string& filePath) {
+        if(image.width <= 0 || image.height <= 0 || image.pixels.size() != size_t(image.width) * image.height * 3) {
+            throw std::invalid_argument("writeCPUImageToEXR: Image size doesn't match its pixels");
+        }
+        std::vector<uint8_t> file = {0x76, 0x2F, 0x31, 0x01, 2, 0, 0, 0}; // Magic number and version 2, single part scanline image.
+
+        std::vector<uint8_t> channels;
+        for(const char* channel : {"B", "G", "R"}) { // Channels are listed alphabetically.
+            channels.push_back(uint8_t(channel[0]));
+            channels.push_back(0);
+            appendLittleEndian<int32_t>(channels, 2); // FLOAT
+            channels.insert(channels.end(), {0, 0, 0, 0}); // pLinear and reserved.
+            appendLittleEndian<int32_t>(channels, 1);
+            appendLittleEndian<int32_t>(channels, 1);
+        }
+        channels.push_back(0);
+        std::vector<uint8_t> window;
+        appendLittleEndian<int32_t>(window, 0);
+        appendLittleEndian<int32_t>(window, 0);
+        appendLittleEndian<int32_t>(window, image.width - 1);
+        appendLittleEndian<int32_t>(window, image.height - 1);
+        std::vector<uint8_t> one;
+        appendLittleEndian<float>(one, 1.0f);
+        std::vector<uint8_t> center;
+        appendLittleEndian<float>(center, 0.0f);
+        appendLittleEndian<float>(center, 0.0f);
+
+        appendEXRAttribute(file, "channels", "chlist", channels);
+        appendEXRAttribute(file, "compression", "compression", {0}); // NO_COMPRESSION
+        appendEXRAttribute(file, "dataWindow", "box2i", window);
+        appendEXRAttribute(file, "displayWindow", "box2i", window);
+        appendEXRAttribute(file, "lineOrder", "lineOrder", {0}); // INCREASING_Y
+        appendEXRAttribute(file, "pixelAspectRatio", "float", one);
+        appendEXRAttribute(file, "screenWindowCenter", "v2f", center);
+        appendEXRAttribute(file, "screenWindowWidth", "float", one);
+        file.push_back(0);
+
+        // One scanline per block, the offset table points at each of them.
+        size_t lineSize = size_t(image.width) * 3 * sizeof(float);
+        uint64_t firstLineOffset = file.size() + size_t(image.height) * sizeof(uint64_t);
+        for(int y = 0; y < image.height; y++) {
+            appendLittleEndian<uint64_t>(file, firstLineOffset + uint64_t(y) * (lineSize + 8));
+        }
+        for(int y = 0; y < image.height; y++) {
+            appendLittleEndian<int32_t>(file, y);
+            appendLittleEndian<int32_t>(file, int32_t(lineSize));
+            for(int channel = 2; channel >= 0; channel--) {
+                for(int x = 0; x < image.width; x++) {
+                    appendLittleEndian<float>(file, image.pixels[(size_t(y) * image.width + x) * 3 + channel]);
+                }
+            }
+        }
+
+        std::ofstream outFile;
+        if(!openImageFile(outFile, filePath, "writeCPUImageToEXR")) {
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char*>(file.data()), file.size());
+        return bool(outFile);
+    }
+}
@@ -0,0 +1,315 @@
+#include "utils/gpu_scene_layout.h"
+
+namespace projv::utils {
+    TexelAllocator createTexelAllocator(uint32_t capacity) {
+        TexelAllocator allocator;
+        growTexelAllocator(allocator, capacity);
+        return allocator;
+    }
+
+    uint32_t allocateTexels(TexelAllocator& allocator, uint32_t texelCount) {
+        if(texelCount == 0) {
+            throw std::invalid_argument("allocateTexels: Can't allocate 0 texels");
+        }
+        auto bestBlock = allocator.freeBlocks.end();
+        for(auto it = allocator.freeBlocks.begin(); it != allocator.freeBlocks.end(); it++) {
+            if(it->second >= texelCount && (bestBlock == allocator.freeBlocks.end() || it->second < bestBlock->second)) {
+                bestBlock = it;
+            }
+        }
+        if(bestBlock == allocator.freeBlocks.end()) {
+            return UINT32_MAX;
+        }
+        uint32_t firstTexel = bestBlock->first;
+        uint32_t blockTexels = bestBlock->second;
+        allocator.freeBlocks.erase(bestBlock);
+        if(blockTexels > texelCount) {
+            allocator.freeBlocks[firstTexel + texelCount] = blockTexels - texelCount;
+        }
+        allocator.allocations[firstTexel] = texelCount;
+        return firstTexel;
+    }
+
+    void freeTexels(TexelAllocator& allocator, uint32_t firstTexel) {
+        auto allocation = allocator.allocations.find(firstTexel);
+        if(allocation == allocator.allocations.end()) {
+            throw std::invalid_argument("freeTexels: No allocation starts at texel " + std::to_string(firstTexel));
+        }
+        uint32_t texelCount = allocation->second;
+        allocator.allocations.erase(allocation);
+
+        auto next = allocator.freeBlocks.lower_bound(firstTexel);
+        if(next != allocator.freeBlocks.end() && next->first == firstTexel + texelCount) {
+            texelCount += next->second;
+            next = allocator.freeBlocks.erase(next);
+        }
+        if(next != allocator.freeBlocks.begin()) {
+            auto previous = std::prev(next);
+            if(previous->first + previous->second == firstTexel) {
+                previous->second += texelCount;
+                return;
+            }
+        }
+        allocator.freeBlocks[firstTexel] = texelCount;
+    }
+
+    void growTexelAllocator(TexelAllocator& allocator, uint32_t capacity) {
+        if(capacity < allocator.capacity) {
+            throw std::invalid_argument("growTexelAllocator: Can't shrink an allocator of " + std::to_string(allocator.capacity) + " texels to " + std::to_string(capacity));
+        }
+        if(capacity == allocator.capacity) {
+            return;
+        }
+        if(!allocator.freeBlocks.empty()) {
+            auto last = std::prev(allocator.freeBlocks.end());
+            if(last->first + last->second == allocator.capacity) {
+                last->second += capacity - allocator.capacity;
+                allocator.capacity = capacity;
+                return;
+            }
+        }
+        allocator.freeBlocks[allocator.capacity] = capacity - allocator.capacity;
+        allocator.capacity = capacity;
+    }
+
+    uint32_t getAllocatedTexelCount(const TexelAllocator& allocator) {
+        uint32_t texelCount = 0;
+        for(const auto& allocation : allocator.allocations) {
+            texelCount += allocation.second;
+        }
+        return texelCount;
+    }
+
+    uint32_t getLargestFreeTexelBlock(const TexelAllocator& allocator) {
+        uint32_t largestBlock = 0;
+        for(const auto& block : allocator.freeBlocks) {
+            largestBlock = std::max(largestBlock, block.second);
+        }
+        return largestBlock;
+    }
+
+    std::vector<TextureRectangle> getTexelRangeRectangles(TexelRange range, uint32_t textureWidth) {
+        std::vector<TextureRectangle> rectangles;
+        uint32_t texel = range.first;
+        uint32_t end = range.first + range.count;
+        // The rest of the first row, unless the range starts at the start of a row.
+        if(texel < end && texel % textureWidth != 0) {
+            uint32_t width = std::min(textureWidth - texel % textureWidth, end - texel);
+            rectangles.push_back({texel % textureWidth, texel / textureWidth, width, 1, texel - range.first});
+            texel += width;
+        }
+        uint32_t fullRows = (end - texel) / textureWidth;
+        if(fullRows > 0) {
+            rectangles.push_back({0, texel / textureWidth, textureWidth, fullRows, texel - range.first});
+            texel += fullRows * textureWidth;
+        }
+        if(texel < end) {
+            rectangles.push_back({0, texel / textureWidth, end - texel, 1, texel - range.first});
+        }
+        return rectangles;
+    }
+
+    // The uint32_t's of a chunk a scene texture holds, before they are packed into texels.
+    size_t getChunkValueCount(const Chunk& chunk, GPUSceneTexture texture, bool implicitVoxelAttributes) {
+        switch(texture) {
+            case GPUSceneTexture::Tree64:
+                return chunk.geometryData.size();
+            case GPUSceneTexture::VoxelTypeData:
+                return implicitVoxelAttributes ? chunk.voxelTypeData.size() / 3 * VOXEL_ATTRIBUTE_SLICES : chunk.voxelTypeData.size();
+            case GPUSceneTexture::NodeColor:
+                // Chunks without a color for every node can't be cut off above their voxels, the shader always descends to their voxels.
+                return chunk.nodeColorData.size() * 3 == chunk.geometryData.size() ? chunk.nodeColorData.size() : 0;
+        }
+        return 0;
+    }
+
+    uint32_t getChunkTexelCount(const Chunk& chunk, GPUSceneTexture texture, bool implicitVoxelAttributes) {
+        size_t valueCount = getChunkValueCount(chunk, texture, implicitVoxelAttributes);
+        size_t valuesPerTexel = texture == GPUSceneTexture::Tree64 ? 3 : 4;
+        return uint32_t((valueCount + valuesPerTexel - 1) / valuesPerTexel);
+    }
+
+    GPUSceneLayout createGPUSceneLayout(const GPUSceneLayoutSettings& settings) {
+        if(settings.textureWidth == 0 || settings.initialTextureRows == 0 || settings.initialTextureRows > settings.maxTextureRows) {
+            throw std::invalid_argument("createGPUSceneLayout: Textures need a width and between 1 and maxTextureRows (" + std::to_string(settings.maxTextureRows) + ") rows");
+        }
+        if(uint64_t(settings.textureWidth) * settings.maxTextureRows > UINT32_MAX) {
+            throw std::invalid_argument("createGPUSceneLayout: Textures of " + std::to_string(settings.textureWidth) + "x" + std::to_string(settings.maxTextureRows) + " texels can't be indexed with 32 bits");
+        }
+        GPUSceneLayout layout;
+        layout.settings = settings;
+        for(TexelAllocator& allocator : layout.allocators) {
+            allocator = createTexelAllocator(settings.textureWidth * settings.initialTextureRows);
+        }
+        return layout;
+    }
+
+    void markGPUChunkChanged(GPUSceneLayout& layout, uint32_t chunkID) {
+        layout.changedChunkIDs.insert(chunkID);
+    }
+
+    uint32_t getGPUSceneTextureRows(const GPUSceneLayout& layout, GPUSceneTexture texture) {
+        return layout.allocators[size_t(texture)].capacity / layout.settings.textureWidth;
+    }
+
+    bool isGPUChunkPlacementCurrent(const GPUChunkPlacement& placement, const Chunk& chunk, bool implicitVoxelAttributes) {
+        if(placement.LOD != chunk.LOD || placement.revision != chunk.revision) {
+            return false;
+        }
+        for(uint32_t texture = 0; texture < GPU_SCENE_TEXTURE_COUNT; texture++) {
+            if(placement.valueCounts[texture] != getChunkValueCount(chunk, GPUSceneTexture(texture), implicitVoxelAttributes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void freeGPUChunkPlacement(GPUSceneLayout& layout, const GPUChunkPlacement& placement) {
+        for(uint32_t texture = 0; texture < GPU_SCENE_TEXTURE_COUNT; texture++) {
+            if(placement.ranges[texture].count > 0) {
+                freeTexels(layout.allocators[texture], placement.ranges[texture].first);
+            }
+        }
+    }
+
+    // Doubles the texture's rows until the range fits. Returns false if the texture can't grow far enough.
+    bool allocateGrowingTexels(GPUSceneLayout& layout, uint32_t texture, uint32_t texelCount, uint32_t& firstTexel) {
+        TexelAllocator& allocator = layout.allocators[texture];
+        firstTexel = allocateTexels(allocator, texelCount);
+        while(firstTexel == UINT32_MAX) {
+            uint32_t rows = allocator.capacity / layout.settings.textureWidth;
+            uint32_t grownRows = std::min(rows * 2, layout.settings.maxTextureRows);
+            if(grownRows <= rows) {
+                return false;
+            }
+            growTexelAllocator(allocator, grownRows * layout.settings.textureWidth);
+            firstTexel = allocateTexels(allocator, texelCount);
+        }
+        return true;
+    }
+
+    GPUSceneLayoutUpdate updateGPUSceneLayout(GPUSceneLayout& layout, const Scene& scene) {
+        GPUSceneLayoutUpdate update;
+        update.resizedTextures.fill(false);
+        update.headerCountChanged = false;
+        update.changedHeaders = {0, 0};
+        bool implicitVoxelAttributes = layout.settings.implicitVoxelAttributes;
+
+        std::unordered_map<uint32_t, uint32_t> chunkIndices;
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            if(!chunkIndices.emplace(scene.chunks[i].header.chunkID, uint32_t(i)).second) {
+                throw std::invalid_argument("updateGPUSceneLayout: Chunk ID " + std::to_string(scene.chunks[i].header.chunkID) + " is used by more than one chunk");
+            }
+        }
+
+        // Chunks are placed in a copy of the layout that replaces it once every chunk fits, so a chunk that doesn't fit leaves the layout as it was.
+        // Without chunks to free or place nothing can fail, and the layout isn't copied.
+        bool placementsChange = !layout.changedChunkIDs.empty() || layout.placements.size() != scene.chunks.size();
+        for(size_t i = 0; i < scene.chunks.size() && !placementsChange; i++) {
+            auto placement = layout.placements.find(scene.chunks[i].header.chunkID);
+            placementsChange = placement == layout.placements.end() || !isGPUChunkPlacementCurrent(placement->second, scene.chunks[i], implicitVoxelAttributes);
+        }
+        GPUSceneLayout plannedLayout;
+        if(placementsChange) {
+            plannedLayout = layout;
+        }
+        GPUSceneLayout& planned = placementsChange ? plannedLayout : layout;
+
+        // Texels are freed before any are allocated, so a changed chunk can take the space it had.
+        for(auto it = planned.placements.begin(); it != planned.placements.end();) {
+            auto chunkIndex = chunkIndices.find(it->first);
+            if(chunkIndex == chunkIndices.end() || planned.changedChunkIDs.count(it->first) != 0 ||
+               !isGPUChunkPlacementCurrent(it->second, scene.chunks[chunkIndex->second], implicitVoxelAttributes)) {
+                freeGPUChunkPlacement(planned, it->second);
+                it = planned.placements.erase(it);
+            } else {
+                it++;
+            }
+        }
+        planned.changedChunkIDs.clear();
+
+        std::vector<bool> placedChunks(scene.chunks.size(), false);
+        std::array<uint32_t, GPU_SCENE_TEXTURE_COUNT> rowsBefore;
+        for(uint32_t texture = 0; texture < GPU_SCENE_TEXTURE_COUNT; texture++) {
+            rowsBefore[texture] = getGPUSceneTextureRows(planned, GPUSceneTexture(texture));
+        }
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            const Chunk& chunk = scene.chunks[i];
+            if(planned.placements.count(chunk.header.chunkID) != 0) {
+                continue;
+            }
+            GPUChunkPlacement placement;
+            placement.LOD = chunk.LOD;
+            placement.revision = chunk.revision;
+            for(uint32_t texture = 0; texture < GPU_SCENE_TEXTURE_COUNT; texture++) {
+                placement.valueCounts[texture] = getChunkValueCount(chunk, GPUSceneTexture(texture), implicitVoxelAttributes);
+                placement.ranges[texture] = {0, getChunkTexelCount(chunk, GPUSceneTexture(texture), implicitVoxelAttributes)};
+                if(placement.ranges[texture].count > 0 && !allocateGrowingTexels(planned, texture, placement.ranges[texture].count, placement.ranges[texture].first)) {
+                    throw std::invalid_argument("updateGPUSceneLayout: Chunk " + std::to_string(chunk.header.chunkID) + " doesn't fit in " + std::to_string(planned.settings.maxTextureRows) +
+                                                " rows of scene texture " + std::to_string(texture));
+                }
+            }
+            planned.placements[chunk.header.chunkID] = placement;
+            placedChunks[i] = true;
+        }
+
+        for(uint32_t texture = 0; texture < GPU_SCENE_TEXTURE_COUNT; texture++) {
+            update.resizedTextures[texture] = getGPUSceneTextureRows(planned, GPUSceneTexture(texture)) != rowsBefore[texture];
+            if(update.resizedTextures[texture]) {
+                core::info("updateGPUSceneLayout: Scene texture {} grew from {} to {} rows", texture, rowsBefore[texture], getGPUSceneTextureRows(planned, GPUSceneTexture(texture)));
+            }
+            for(size_t i = 0; i < scene.chunks.size(); i++) {
+                const TexelRange& range = planned.placements[scene.chunks[i].header.chunkID].ranges[texture];
+                if(range.count > 0 && (placedChunks[i] || update.resizedTextures[texture])) {
+                    update.writes.push_back({GPUSceneTexture(texture), uint32_t(i), range});
+                }
+            }
+        }
+
+        std::vector<GPUChunkHeader> headers(scene.chunks.size());
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            const Chunk& chunk = scene.chunks[i];
+            const GPUChunkPlacement& placement = planned.placements[chunk.header.chunkID];
+            const TexelRange& tree64Range = placement.ranges[size_t(GPUSceneTexture::Tree64)];
+            const TexelRange& voxelTypeDataRange = placement.ranges[size_t(GPUSceneTexture::VoxelTypeData)];
+            const TexelRange& nodeColorRange = placement.ranges[size_t(GPUSceneTexture::NodeColor)];
+
+            GPUChunkHeader& header = headers[i];
+            header.chunkID = chunk.header.chunkID;
+            header.geometryStartIndex = tree64Range.first;
+            header.geometryEndIndex = tree64Range.first + tree64Range.count;
+            header.voxelTypeDataStartIndex = voxelTypeDataRange.first * 4;
+            header.voxelTypeDataEndIndex = header.voxelTypeDataStartIndex + uint32_t(placement.valueCounts[size_t(GPUSceneTexture::VoxelTypeData)]);
+            header.positionX = chunk.header.position.x;
+            header.positionY = chunk.header.position.y;
+            header.positionZ = chunk.header.position.z;
+            header.resolution = chunk.header.resolution;
+            header.scale = chunk.header.scale;
+            header.nodeColorStartIndex = nodeColorRange.count > 0 ? nodeColorRange.first * 4 : UINT32_MAX;
+            header.padding = 0;
+        }
+
+        // Headers are only 3 texels each, the span from the first to the last changed one is uploaded.
+        if(headers.size() != layout.headers.size()) {
+            update.headerCountChanged = true;
+            update.changedHeaders = {0, uint32_t(headers.size())};
+        } else {
+            size_t firstChanged = headers.size();
+            size_t lastChanged = 0;
+            for(size_t i = 0; i < headers.size(); i++) {
+                if(std::memcmp(&headers[i], &layout.headers[i], sizeof(GPUChunkHeader)) != 0) {
+                    firstChanged = std::min(firstChanged, i);
+                    lastChanged = i;
+                }
+            }
+            if(firstChanged < headers.size()) {
+                update.changedHeaders = {uint32_t(firstChanged), uint32_t(lastChanged - firstChanged + 1)};
+            }
+        }
+        planned.headers = std::move(headers);
+        if(placementsChange) {
+            layout = std::move(plannedLayout);
+        }
+        return update;
+    }
+}
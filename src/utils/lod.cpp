@@ -1,6 +1,47 @@
 #include "utils/lod.h" // Ensure RuntimeChunkData is included
 
 namespace projv::utils {
+    uint32_t getChunkMaxLOD(const Chunk& chunk) {
+        return chunk.LOD + uint32_t(getTree64LevelsOfDepth(int(chunk.header.resolution)) - 1);
+    }
+
+    void reduceChunkLOD(Chunk& chunk, uint32_t targetLOD) {
+        if (targetLOD < chunk.LOD || targetLOD > getChunkMaxLOD(chunk)) {
+            throw std::invalid_argument("reduceChunkLOD: Chunk " + std::to_string(chunk.header.chunkID) + " at LOD " + std::to_string(chunk.LOD) + " can only be lowered to LODs " +
+                                        std::to_string(chunk.LOD) + " to " + std::to_string(getChunkMaxLOD(chunk)) + ", not " + std::to_string(targetLOD));
+        }
+        uint32_t removedLevels = targetLOD - chunk.LOD;
+        if (removedLevels == 0) {
+            return;
+        }
+        int levelsOfDepth = getTree64LevelsOfDepth(int(chunk.header.resolution));
+        std::vector<size_t> levelEnds = findTree64LevelEnds(chunk.geometryData, levelsOfDepth); // Throws before anything is changed if the tree64 isn't breadth first.
+        bool hasNodeColors = !chunk.nodeColorData.empty() && chunk.nodeColorData.size() * 3 == chunk.geometryData.size();
+        int keptLevels = levelsOfDepth - int(removedLevels);
+        truncateTree64Levels(chunk.geometryData, levelEnds, keptLevels);
+        chunk.geometryData.shrink_to_fit();
+        chunk.voxelTypeData = mergeVoxelTypeDataLevels(chunk.voxelTypeData, removedLevels);
+        // The kept nodes keep their colors, those still average every voxel that was below them.
+        if (hasNodeColors) {
+            // The merged voxels are the nodes of the first removed level in order. Their node colors average the full voxels even if the chunk was already lowered,
+            // where merging its voxels again would average averages.
+            size_t removedLevelStart = levelEnds[keptLevels - 1];
+            if (chunk.voxelTypeData.size() / 3 == levelEnds[keptLevels] - removedLevelStart) {
+                for (size_t i = 0; i < chunk.voxelTypeData.size() / 3; i++) {
+                    chunk.voxelTypeData[i * 3 + 1] = chunk.nodeColorData[removedLevelStart + i];
+                }
+            }
+            chunk.nodeColorData.resize(chunk.geometryData.size() / 3);
+            chunk.nodeColorData.shrink_to_fit();
+        } else {
+            chunk.nodeColorData.clear();
+        }
+        chunk.header.resolution >>= 2 * removedLevels;
+        chunk.header.voxelScale *= float(1u << (2 * removedLevels));
+        chunk.LOD = targetLOD;
+        bumpChunkRevision(chunk);
+    }
+
     void updateLOD(Chunk& chunk, uint32_t targetLOD, const std::string& sceneFilePath, bool forceReload) {
         auto start = std::chrono::high_resolution_clock::now();
         core::info("[updateLOD] Updating LOD of chunk {} to {}...", chunk.header.chunkID, targetLOD);
@@ -16,10 +57,10 @@ namespace projv::utils {
             return;
         }
 
-        // Loads the chunk if the targetLOD is a higher resolution (lower value) than the current LOD.
+        // Loads the chunk if the targetLOD is a higher resolution (lower value) than the current LOD, reading only the levels it keeps.
         Chunk chunkToBeChanged;
         if (chunk.LOD > targetLOD || forceReload) {
-            chunkToBeChanged = loadChunkFromDisk(sceneFilePath, chunk.header);
+            chunkToBeChanged = loadChunkFromDiskAtLOD(sceneFilePath, chunk.header, std::min(targetLOD, getChunkMaxLOD(chunk)));
         } else {
             chunkToBeChanged = chunk;
         }
@@ -31,58 +72,193 @@ namespace projv::utils {
             return;
         }
 
-        // Traverses the tree64 to find the parents of the leaves and removes them.
-        int depthToTheParentsOfTheLeaves = log2(chunkToBeChanged.header.resolution / pow(2, targetLOD));
-        int parentsOfTheParentsOfTheLeavesStartIndex = 0;
-        int parentsOfTheLeavesStartIndex;
-        int currentNodeIndex = 0;
-        uint32_t currentNodeData = chunkToBeChanged.geometryData[currentNodeIndex];
-        for (int i = 0; i < depthToTheParentsOfTheLeaves; i++) { // Tree traversal to find the parents of the leaves.
-            int currentNodePointer = (currentNodeData >> 9) & 0b11111111111111111111111;
-            currentNodeIndex += currentNodePointer;
-            currentNodeData = chunkToBeChanged.geometryData[currentNodeIndex];
-            if (i < depthToTheParentsOfTheLeaves - 1) {
-                parentsOfTheParentsOfTheLeavesStartIndex = currentNodeIndex;
+        // Removes the deepest levels of the tree64 and merges the voxel type data to the new resolution.
+        reduceChunkLOD(chunkToBeChanged, std::min(targetLOD, getChunkMaxLOD(chunkToBeChanged)));
+        chunk = chunkToBeChanged;
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("[updateLOD] Updated in {} ms", elapsed);
+
+        return;
+    }
+
+    LODScheduler::LODScheduler(const std::string& sceneFileDirectory, const LODSchedulerSettings& settings) : sceneFileDirectory(sceneFileDirectory), settings(settings) {
+        if (settings.threadCount == 0) {
+            throw std::invalid_argument("LODScheduler: At least one thread is needed");
+        }
+        for (const ChunkHeader& header : loadChunkHeadersFromDisk(sceneFileDirectory)) {
+            chunkIDsOnDisk.insert(header.chunkID);
+        }
+        timeBudgetLeft = settings.transitionTimeBudget;
+        for (uint32_t i = 0; i < settings.threadCount; i++) {
+            transitionThreads.emplace_back(&LODScheduler::runTransitions, this);
+        }
+    }
+
+    LODScheduler::~LODScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        transitionRequested.notify_all();
+        for (std::thread& thread : transitionThreads) {
+            thread.join();
+        }
+    }
+
+    void LODScheduler::runTransitions() {
+        while (true) {
+            LODTransition transition;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                transitionRequested.wait(lock, [this] { return stopping || (!queuedTransitions.empty() && timeBudgetLeft > 0.0f); });
+                if (stopping) {
+                    return;
+                }
+                transition = std::move(queuedTransitions.front());
+                queuedTransitions.pop_front();
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            try {
+                if (transition.targetLOD < transition.sourceLOD) {
+                    transition.chunk = loadChunkFromDiskAtLOD(sceneFileDirectory, transition.chunk.header, transition.targetLOD);
+                } else {
+                    reduceChunkLOD(transition.chunk, transition.targetLOD);
+                }
+            } catch (const std::exception& exception) { // Anything escaping this thread would terminate the program, file and allocation errors included.
+                core::error("LODScheduler: Can't change the LOD of chunk {}: {}", transition.chunkID, exception.what());
+                transition.failed = true;
             }
+            float elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            timeBudgetLeft -= elapsed;
+            millisecondsSinceUpdate += elapsed;
+            finishedTransitions.emplace_back(std::move(transition));
+        }
+    }
+
+    // Picks the LOD whose voxels cover about pixelsPerVoxel pixels, changing only once the chunk is hysteresis LODs past a boundary.
+    uint32_t pickChunkLOD(const Chunk& chunk, core::vec3 cameraPosition, float pixelsPerDistance, const LODSchedulerSettings& settings, uint32_t lowestLOD) {
+        core::vec3 boundsMin = chunk.header.position;
+        core::vec3 boundsMax = chunk.header.position + core::vec3(chunk.header.scale);
+        float distance = core::length(cameraPosition - core::clamp(cameraPosition, boundsMin, boundsMax));
+        float fullResolution = float(chunk.header.resolution) * float(1u << (2 * chunk.LOD));
+        float voxelPixels = chunk.header.scale / fullResolution * pixelsPerDistance / distance;
+        float idealLOD = log2f(settings.pixelsPerVoxel / voxelPixels) * 0.5f; // Every LOD makes voxels 4 times larger.
+
+        float currentLOD = float(chunk.LOD);
+        float targetLOD = currentLOD;
+        if (idealLOD >= currentLOD + 1.0f + settings.hysteresis) {
+            targetLOD = floorf(idealLOD - settings.hysteresis);
+        } else if (idealLOD < currentLOD - settings.hysteresis) {
+            targetLOD = floorf(idealLOD + settings.hysteresis);
         }
+        return uint32_t(std::clamp(targetLOD, 0.0f, float(lowestLOD)));
+    }
 
-        // Makes the previous leaf grandparents into leaf parents.
-        parentsOfTheLeavesStartIndex = currentNodeIndex;
-        chunkToBeChanged.geometryData.erase(chunkToBeChanged.geometryData.begin() + parentsOfTheLeavesStartIndex, chunkToBeChanged.geometryData.end()); // Deletes the parents of the leaves
-        for (size_t i = parentsOfTheParentsOfTheLeavesStartIndex; i < chunkToBeChanged.geometryData.size(); i++) { // Loops over the parents of the parents of the leaves
-            uint32_t currentNodeData = chunkToBeChanged.geometryData[i];
-            currentNodeData = currentNodeData & 0b111111111; // Clears the child pointer
-            currentNodeData = currentNodeData | 0b1; // Sets the leaf flag to 1.
-            chunkToBeChanged.geometryData[i] = currentNodeData;
+    bool LODScheduler::update(Scene& scene, core::vec3 cameraPosition, float fov, uint32_t screenHeight) {
+        std::vector<LODTransition> transitions;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            transitions.swap(finishedTransitions);
+            timeBudgetLeft = std::min(timeBudgetLeft + settings.transitionTimeBudget, settings.transitionTimeBudget);
+            transitionMilliseconds = millisecondsSinceUpdate;
+            millisecondsSinceUpdate = 0.0f;
         }
+        transitionRequested.notify_all();
 
-        // Scales the voxel type data down to the new resolution.
-        uint32_t lastZOrder = 0;
-        std::vector<uint32_t> newVoxelTypeData;
-        int resolutionScale = pow(2, targetLOD - chunkToBeChanged.LOD);
-        for (size_t i = 0; i < chunkToBeChanged.voxelTypeData.size(); i += 3) {
-            chunkToBeChanged.voxelTypeData[i] /= (resolutionScale * resolutionScale * resolutionScale);
+        std::unordered_map<uint32_t, size_t> chunkIndices;
+        for (size_t i = 0; i < scene.chunks.size(); i++) {
+            chunkIndices[scene.chunks[i].header.chunkID] = i;
+        }
 
-            uint32_t currentVoxelTypeDataZOrder = chunkToBeChanged.voxelTypeData[i];
-            if (currentVoxelTypeDataZOrder == lastZOrder && i != 0) {
+        // Swaps the finished changes in whole, chunks that changed since they were queued keep their data.
+        bool sceneChanged = false;
+        std::unique_lock<std::mutex> lock(mutex); // getStatistics reads the pending chunks and counters from other threads.
+        for (LODTransition& transition : transitions) {
+            pendingChunkIDs.erase(transition.chunkID);
+            if (transition.failed) {
+                failedChunkIDs.insert(transition.chunkID);
+                discardedTransitions++;
                 continue;
-            } else {
-                newVoxelTypeData.push_back(currentVoxelTypeDataZOrder);
-                newVoxelTypeData.push_back(chunkToBeChanged.voxelTypeData[i + 1]);
-                newVoxelTypeData.push_back(chunkToBeChanged.voxelTypeData[i + 2]);
             }
-            lastZOrder = currentVoxelTypeDataZOrder;
+            auto it = chunkIndices.find(transition.chunkID);
+            if (it == chunkIndices.end() || scene.chunks[it->second].LOD != transition.sourceLOD) {
+                discardedTransitions++;
+                continue;
+            }
+            Chunk& chunk = scene.chunks[it->second];
+            chunk.header = transition.chunk.header;
+            chunk.geometryData.swap(transition.chunk.geometryData);
+            chunk.voxelTypeData.swap(transition.chunk.voxelTypeData);
+            chunk.nodeColorData.swap(transition.chunk.nodeColorData);
+            chunk.LOD = transition.chunk.LOD;
+            bumpChunkRevision(chunk);
+            completedTransitions++;
+            sceneChanged = true;
         }
+        lock.unlock();
 
-        // Updates the chunk with the new data
-        chunkToBeChanged.voxelTypeData = newVoxelTypeData;
-        chunkToBeChanged.LOD = targetLOD;
-        chunk = chunkToBeChanged;
+        // Nearest chunks change first, their voxels are the most visible.
+        float pixelsPerDistance = float(screenHeight) / (2.0f * tanf(core::radians(fov * 0.5f)));
+        std::vector<std::tuple<float, size_t, uint32_t>> candidates; // Distance, chunk index and target LOD.
+        for (size_t i = 0; i < scene.chunks.size(); i++) {
+            const Chunk& chunk = scene.chunks[i];
+            if (pendingChunkIDs.count(chunk.header.chunkID) != 0 || failedChunkIDs.count(chunk.header.chunkID) != 0) {
+                continue;
+            }
+            uint32_t lowestLOD = std::min(settings.maxLOD, getChunkMaxLOD(chunk));
+            uint32_t targetLOD = pickChunkLOD(chunk, cameraPosition, pixelsPerDistance, settings, lowestLOD);
+            if (targetLOD < chunk.LOD && chunkIDsOnDisk.count(chunk.header.chunkID) == 0) {
+                continue; // Can't raise the detail of a chunk that was never written to disk.
+            }
+            if (targetLOD != chunk.LOD) {
+                core::vec3 center = chunk.header.position + core::vec3(chunk.header.scale * 0.5f);
+                candidates.emplace_back(core::length(center - cameraPosition), i, targetLOD);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
 
-        auto end = std::chrono::high_resolution_clock::now();
-        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
-        core::info("[updateLOD] Updated in {} ms", elapsed);
+        // Copies are made here rather than on the threads, the scene may change once update returns.
+        std::vector<LODTransition> newTransitions;
+        for (size_t i = 0; i < candidates.size() && pendingChunkIDs.size() + newTransitions.size() < settings.maxQueuedTransitions; i++) {
+            const Chunk& chunk = scene.chunks[std::get<1>(candidates[i])];
+            LODTransition transition;
+            transition.chunkID = chunk.header.chunkID;
+            transition.sourceLOD = chunk.LOD;
+            transition.targetLOD = std::get<2>(candidates[i]);
+            transition.failed = false;
+            transition.chunk.header = chunk.header;
+            transition.chunk.LOD = chunk.LOD;
+            if (transition.targetLOD > chunk.LOD) {
+                transition.chunk.geometryData = chunk.geometryData;
+                transition.chunk.voxelTypeData = chunk.voxelTypeData;
+                transition.chunk.nodeColorData = chunk.nodeColorData;
+            }
+            newTransitions.emplace_back(std::move(transition));
+        }
+        if (!newTransitions.empty()) {
+            lock.lock();
+            for (LODTransition& transition : newTransitions) {
+                pendingChunkIDs.insert(transition.chunkID);
+                queuedTransitions.emplace_back(std::move(transition));
+            }
+            lock.unlock();
+        }
+        transitionRequested.notify_all();
+        return sceneChanged;
+    }
 
-        return;
+    LODSchedulerStatistics LODScheduler::getStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        LODSchedulerStatistics statistics;
+        statistics.pendingTransitions = pendingChunkIDs.size();
+        statistics.completedTransitions = completedTransitions;
+        statistics.discardedTransitions = discardedTransitions;
+        statistics.transitionMilliseconds = transitionMilliseconds;
+        return statistics;
     }
 }
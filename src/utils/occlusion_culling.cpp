@@ -0,0 +1,436 @@
+#include "utils/occlusion_culling.h"
+
+// SSE2 is part of x86-64, so the rasterizer's 4 pixel loops need no runtime check.
+#if defined(__SSE2__)
+#define PROJV_OCCLUSION_SSE2 1
+#include <emmintrin.h>
+#else
+#define PROJV_OCCLUSION_SSE2 0
+#endif
+
+namespace projv::utils {
+    constexpr float OCCLUSION_NEAR_W = 1e-4f; // Corners closer to the camera plane than this count as behind the camera.
+    constexpr float OCCLUSION_DEPTH_BIAS = 1e-6f; // A box is only hidden by occluders at least this much closer, so rounding never hides it.
+    constexpr float OCCLUDER_MIN_FACE_AREA = 1e-6f; // Twice the screen area in pixels below which a face is seen edge on.
+
+    struct FullCellSearch { // What every node of a search for fully solid cells shares.
+        const uint32_t* tree64;
+        int level; // Level of the cells to mark.
+        int cellsPerAxis;
+        std::vector<uint8_t>* fullCells; // One entry per cell at level, x fastest.
+    };
+
+    void markFullCell(const FullCellSearch& search, core::ivec3 cellMin, int cellLevel) {
+        int span = 1 << (2 * (cellLevel - search.level));
+        core::ivec3 start = cellMin / (1 << (2 * search.level));
+        int cellsPerAxis = search.cellsPerAxis;
+        for(int z = start.z; z < start.z + span; z++) {
+            for(int y = start.y; y < start.y + span; y++) {
+                uint8_t* row = search.fullCells->data() + (size_t(z) * cellsPerAxis + y) * cellsPerAxis;
+                std::fill(row + start.x, row + start.x + span, uint8_t(1));
+            }
+        }
+    }
+
+    // Returns true if the node's whole cell is solid. The largest fully solid cells of a node that isn't are marked instead, as long as they are at
+    // search.level or above. cellLevel is the level of the node's own cell.
+    bool findFullCellsTree64(const FullCellSearch& search, uint32_t nodeIndex, int cellLevel, core::ivec3 cellMin) {
+        const uint32_t* node = search.tree64 + size_t(nodeIndex) * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        bool full = validMask == UINT64_MAX;
+        int childLevel = cellLevel - 1;
+        if(childLevel == 0) {
+            return full; // The children are voxels.
+        }
+        if(!full && childLevel < search.level) {
+            return false; // Can't be full and its children are too small to mark.
+        }
+
+        uint32_t firstChild = nodeIndex + getTree64ChildPointer(node);
+        int childSize = 1 << (2 * childLevel);
+        uint64_t fullChildren = 0;
+        uint32_t childRank = 0;
+        for(uint64_t remaining = validMask; remaining != 0; childRank++) {
+            uint32_t zOrderInParent = uint32_t(__builtin_clzll(remaining));
+            remaining &= ~(1ull << (63 - zOrderInParent));
+            if(findFullCellsTree64(search, firstChild + childRank, childLevel, cellMin + getTree64ChildOffset(zOrderInParent) * childSize)) {
+                fullChildren |= 1ull << (63 - zOrderInParent);
+            }
+        }
+        if(full && fullChildren == UINT64_MAX) {
+            return true;
+        }
+        if(childLevel >= search.level) {
+            for(uint64_t remaining = fullChildren; remaining != 0;) {
+                uint32_t zOrderInParent = uint32_t(__builtin_clzll(remaining));
+                remaining &= ~(1ull << (63 - zOrderInParent));
+                markFullCell(search, cellMin + getTree64ChildOffset(zOrderInParent) * childSize, childLevel);
+            }
+        }
+        return false;
+    }
+
+    // Greedily grows boxes of marked cells along x, then y, then z. The cells taken by a box are cleared.
+    std::vector<std::pair<core::ivec3, core::ivec3>> mergeFullCells(std::vector<uint8_t>& fullCells, int cellsPerAxis) {
+        auto isFull = [&](int x, int y, int z) {
+            return fullCells[(size_t(z) * cellsPerAxis + y) * cellsPerAxis + x] != 0;
+        };
+        auto isRowFull = [&](int xStart, int xEnd, int y, int z) {
+            for(int x = xStart; x < xEnd; x++) {
+                if(!isFull(x, y, z)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::vector<std::pair<core::ivec3, core::ivec3>> boxes;
+        for(int z = 0; z < cellsPerAxis; z++) {
+            for(int y = 0; y < cellsPerAxis; y++) {
+                for(int x = 0; x < cellsPerAxis; x++) {
+                    if(!isFull(x, y, z)) {
+                        continue;
+                    }
+                    int xEnd = x + 1;
+                    while(xEnd < cellsPerAxis && isFull(xEnd, y, z)) {
+                        xEnd++;
+                    }
+                    int yEnd = y + 1;
+                    while(yEnd < cellsPerAxis && isRowFull(x, xEnd, yEnd, z)) {
+                        yEnd++;
+                    }
+                    int zEnd = z + 1;
+                    for(bool layerFull = true; zEnd < cellsPerAxis && layerFull; zEnd += layerFull ? 1 : 0) {
+                        for(int layerY = y; layerY < yEnd && layerFull; layerY++) {
+                            layerFull = isRowFull(x, xEnd, layerY, zEnd);
+                        }
+                    }
+                    for(int boxZ = z; boxZ < zEnd; boxZ++) {
+                        for(int boxY = y; boxY < yEnd; boxY++) {
+                            uint8_t* row = fullCells.data() + (size_t(boxZ) * cellsPerAxis + boxY) * cellsPerAxis;
+                            std::fill(row + x, row + xEnd, uint8_t(0));
+                        }
+                    }
+                    boxes.push_back({core::ivec3(x, y, z), core::ivec3(xEnd, yEnd, zEnd)});
+                }
+            }
+        }
+        return boxes;
+    }
+
+    std::vector<OccluderBox> findChunkOccluders(const Chunk& chunk, int level, size_t maxOccluders) {
+        int resolution = int(chunk.header.resolution);
+        int levelsOfDepth = getTree64LevelsOfDepth(resolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("findChunkOccluders: Resolution " + std::to_string(resolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(level < 1 || level > levelsOfDepth) {
+            throw std::invalid_argument("findChunkOccluders: Level " + std::to_string(level) + " is outside of 1 to " + std::to_string(levelsOfDepth));
+        }
+        std::vector<OccluderBox> occluders;
+        if(chunk.geometryData.empty() || maxOccluders == 0) {
+            return occluders;
+        }
+
+        int cellsPerAxis = 1 << (2 * (levelsOfDepth - level));
+        std::vector<uint8_t> fullCells(size_t(cellsPerAxis) * cellsPerAxis * cellsPerAxis, 0);
+        FullCellSearch search = {chunk.geometryData.data(), level, cellsPerAxis, &fullCells};
+        if(findFullCellsTree64(search, 0, levelsOfDepth, core::ivec3(0))) {
+            markFullCell(search, core::ivec3(0), levelsOfDepth);
+        }
+        std::vector<std::pair<core::ivec3, core::ivec3>> boxes = mergeFullCells(fullCells, cellsPerAxis);
+        std::stable_sort(boxes.begin(), boxes.end(), [](const std::pair<core::ivec3, core::ivec3>& a, const std::pair<core::ivec3, core::ivec3>& b) {
+            core::ivec3 sizeA = a.second - a.first;
+            core::ivec3 sizeB = b.second - b.first;
+            return int64_t(sizeA.x) * sizeA.y * sizeA.z > int64_t(sizeB.x) * sizeB.y * sizeB.z;
+        });
+        if(boxes.size() > maxOccluders) {
+            boxes.resize(maxOccluders);
+        }
+
+        float cellSize = float(1 << (2 * level)) * chunk.header.scale / float(resolution);
+        for(const std::pair<core::ivec3, core::ivec3>& box : boxes) {
+            occluders.push_back({chunk.header.position + core::vec3(box.first) * cellSize, chunk.header.position + core::vec3(box.second) * cellSize});
+        }
+        return occluders;
+    }
+
+    void clearOcclusionBuffer(OcclusionBuffer& buffer, int width, int height, const core::mat4& viewProjection, core::vec3 cameraPosition) {
+        if(width <= 0 || height <= 0) {
+            throw std::invalid_argument("clearOcclusionBuffer: Resolution " + std::to_string(width) + "x" + std::to_string(height) + " is empty");
+        }
+        buffer.width = width;
+        buffer.height = height;
+        buffer.depth.assign(size_t(width) * height, INFINITY);
+        buffer.viewProjection = viewProjection;
+        buffer.cameraPosition = cameraPosition;
+    }
+
+    struct ScreenPoint {
+        float x; // In pixels.
+        float y;
+        float depth; // z / w.
+    };
+
+    // Returns false for points too close to or behind the camera.
+    bool projectToOcclusionBuffer(const OcclusionBuffer& buffer, core::vec3 position, ScreenPoint& point) {
+        core::vec4 clip = buffer.viewProjection * core::vec4(position, 1.0f);
+        if(!(clip.w > OCCLUSION_NEAR_W)) {
+            return false;
+        }
+        point.x = (clip.x / clip.w * 0.5f + 0.5f) * float(buffer.width);
+        point.y = (clip.y / clip.w * 0.5f + 0.5f) * float(buffer.height);
+        point.depth = clip.z / clip.w;
+        return true;
+    }
+
+    bool projectBoxCorners(const OcclusionBuffer& buffer, core::vec3 boundsMin, core::vec3 boundsMax, std::array<ScreenPoint, 8>& corners) {
+        for(int i = 0; i < 8; i++) {
+            core::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+            if(!projectToOcclusionBuffer(buffer, corner, corners[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // An occluder prepared for drawing. Both the edges and the depth planes are linear in the pixel position and already moved to the pixel's worst corner,
+    // so a pixel is covered when every edge is >= 0 at its center, and the depth at its center is the farthest the box gets in it.
+    struct OccluderRaster {
+        int edgeCount;
+        std::array<float, 8> edgeX; // edge = edgeX * x + edgeY * y + edgeOffset.
+        std::array<float, 8> edgeY;
+        std::array<float, 8> edgeOffset;
+        int planeCount;
+        std::array<float, 3> planeX; // depth = max over planes of planeX * x + planeY * y + planeOffset, capped at maxDepth.
+        std::array<float, 3> planeY;
+        std::array<float, 3> planeOffset;
+        float maxDepth;
+    };
+
+    float getCrossProduct2D(const ScreenPoint& origin, const ScreenPoint& a, const ScreenPoint& b) {
+        return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+    }
+
+    // The box's outline on screen is the convex hull of its corners (monotone chain), counter clockwise.
+    int findScreenHull(std::array<ScreenPoint, 8> points, std::array<ScreenPoint, 16>& hull) {
+        std::sort(points.begin(), points.end(), [](const ScreenPoint& a, const ScreenPoint& b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        });
+        int hullSize = 0;
+        for(int i = 0; i < 8; i++) {
+            while(hullSize >= 2 && getCrossProduct2D(hull[hullSize - 2], hull[hullSize - 1], points[i]) <= 0.0f) {
+                hullSize--;
+            }
+            hull[hullSize++] = points[i];
+        }
+        for(int i = 6, lowerSize = hullSize + 1; i >= 0; i--) {
+            while(hullSize >= lowerSize && getCrossProduct2D(hull[hullSize - 2], hull[hullSize - 1], points[i]) <= 0.0f) {
+                hullSize--;
+            }
+            hull[hullSize++] = points[i];
+        }
+        return hullSize - 1; // The first point is repeated at the end.
+    }
+
+    void rasterizeOccluderRowScalar(const OccluderRaster& raster, float* row, int xStart, int xEnd, float y) {
+        for(int x = xStart; x < xEnd; x++) {
+            float centerX = float(x) + 0.5f;
+            bool covered = true;
+            for(int i = 0; i < raster.edgeCount; i++) {
+                covered = covered && raster.edgeX[i] * centerX + raster.edgeY[i] * y + raster.edgeOffset[i] >= 0.0f;
+            }
+            if(!covered) {
+                continue;
+            }
+            float depth = raster.planeCount > 0 ? -INFINITY : raster.maxDepth;
+            for(int i = 0; i < raster.planeCount; i++) {
+                depth = std::max(depth, raster.planeX[i] * centerX + raster.planeY[i] * y + raster.planeOffset[i]);
+            }
+            row[x] = std::min(row[x], std::min(depth, raster.maxDepth));
+        }
+    }
+
+#if PROJV_OCCLUSION_SSE2
+    void rasterizeOccluderRowSSE2(const OccluderRaster& raster, float* row, int xStart, int xEnd, float y) {
+        std::array<float, 8> rowEdgeOffsets;
+        for(int i = 0; i < raster.edgeCount; i++) {
+            rowEdgeOffsets[i] = raster.edgeY[i] * y + raster.edgeOffset[i];
+        }
+        std::array<float, 3> rowPlaneOffsets;
+        for(int i = 0; i < raster.planeCount; i++) {
+            rowPlaneOffsets[i] = raster.planeY[i] * y + raster.planeOffset[i];
+        }
+        const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maxDepth = _mm_set1_ps(raster.maxDepth);
+        int x = xStart;
+        for(; x + 4 <= xEnd; x += 4) {
+            __m128 centerX = _mm_add_ps(_mm_set1_ps(float(x)), laneOffsets);
+            __m128 covered = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(int i = 0; i < raster.edgeCount; i++) {
+                __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(raster.edgeX[i]), centerX), _mm_set1_ps(rowEdgeOffsets[i]));
+                covered = _mm_and_ps(covered, _mm_cmpge_ps(edge, zero));
+            }
+            if(_mm_movemask_ps(covered) == 0) {
+                continue;
+            }
+            __m128 depth = raster.planeCount > 0 ? _mm_set1_ps(-INFINITY) : maxDepth;
+            for(int i = 0; i < raster.planeCount; i++) {
+                depth = _mm_max_ps(depth, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(raster.planeX[i]), centerX), _mm_set1_ps(rowPlaneOffsets[i])));
+            }
+            __m128 previous = _mm_loadu_ps(row + x);
+            __m128 written = _mm_min_ps(previous, _mm_min_ps(depth, maxDepth));
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(covered, written), _mm_andnot_ps(covered, previous)));
+        }
+        rasterizeOccluderRowScalar(raster, row, x, xEnd, y);
+    }
+#endif
+
+    void rasterizeOccluder(OcclusionBuffer& buffer, const OccluderBox& occluder) {
+        std::array<ScreenPoint, 8> corners;
+        if(buffer.depth.empty() || !projectBoxCorners(buffer, occluder.boundsMin, occluder.boundsMax, corners)) {
+            return;
+        }
+        OccluderRaster raster;
+        raster.maxDepth = -INFINITY;
+        for(const ScreenPoint& corner : corners) {
+            raster.maxDepth = std::max(raster.maxDepth, corner.depth);
+        }
+
+        // Only the faces turned towards the camera can be seen. A camera inside the box sees none and the box can't be drawn.
+        raster.planeCount = 0;
+        bool cameraOutside = false;
+        for(int axis = 0; axis < 3; axis++) {
+            int side;
+            if(buffer.cameraPosition[axis] < occluder.boundsMin[axis]) {
+                side = 0;
+            } else if(buffer.cameraPosition[axis] > occluder.boundsMax[axis]) {
+                side = 1;
+            } else {
+                continue;
+            }
+            cameraOutside = true;
+            std::array<const ScreenPoint*, 4> face;
+            int faceCorners = 0;
+            for(int i = 0; i < 8; i++) {
+                if(((i >> axis) & 1) == side) {
+                    face[faceCorners++] = &corners[i];
+                }
+            }
+            // Corners 0 and 3 of the face are opposite, so 0, 1 and 3 are never on a line unless the face is seen edge on.
+            const ScreenPoint& p0 = *face[0];
+            const ScreenPoint& p1 = *face[1];
+            const ScreenPoint& p2 = *face[3];
+            float determinant = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+            if(fabsf(determinant) < OCCLUDER_MIN_FACE_AREA) {
+                continue;
+            }
+            float slopeX = ((p1.depth - p0.depth) * (p2.y - p0.y) - (p2.depth - p0.depth) * (p1.y - p0.y)) / determinant;
+            float slopeY = ((p1.x - p0.x) * (p2.depth - p0.depth) - (p2.x - p0.x) * (p1.depth - p0.depth)) / determinant;
+            raster.planeX[raster.planeCount] = slopeX;
+            raster.planeY[raster.planeCount] = slopeY;
+            raster.planeOffset[raster.planeCount] = p0.depth - slopeX * p0.x - slopeY * p0.y + 0.5f * (fabsf(slopeX) + fabsf(slopeY));
+            raster.planeCount++;
+        }
+        if(!cameraOutside) {
+            return;
+        }
+
+        std::array<ScreenPoint, 16> hull;
+        int hullSize = findScreenHull(corners, hull);
+        if(hullSize < 3) {
+            return;
+        }
+        float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+        raster.edgeCount = hullSize;
+        for(int i = 0; i < hullSize; i++) {
+            const ScreenPoint& start = hull[i];
+            const ScreenPoint& end = hull[i + 1];
+            raster.edgeX[i] = start.y - end.y;
+            raster.edgeY[i] = end.x - start.x;
+            raster.edgeOffset[i] = -(raster.edgeX[i] * start.x + raster.edgeY[i] * start.y) - 0.5f * (fabsf(raster.edgeX[i]) + fabsf(raster.edgeY[i]));
+            minX = std::min(minX, start.x);
+            maxX = std::max(maxX, start.x);
+            minY = std::min(minY, start.y);
+            maxY = std::max(maxY, start.y);
+        }
+        int xStart = std::max(0, int(floorf(minX)));
+        int xEnd = std::min(buffer.width, int(ceilf(maxX)));
+        int yStart = std::max(0, int(floorf(minY)));
+        int yEnd = std::min(buffer.height, int(ceilf(maxY)));
+        for(int y = yStart; y < yEnd; y++) {
+            float* row = buffer.depth.data() + size_t(y) * buffer.width;
+#if PROJV_OCCLUSION_SSE2
+            rasterizeOccluderRowSSE2(raster, row, xStart, xEnd, float(y) + 0.5f);
+#else
+            rasterizeOccluderRowScalar(raster, row, xStart, xEnd, float(y) + 0.5f);
+#endif
+        }
+    }
+
+    bool isBoxOccluded(const OcclusionBuffer& buffer, core::vec3 boundsMin, core::vec3 boundsMax) {
+        std::array<ScreenPoint, 8> corners;
+        if(buffer.depth.empty() || !projectBoxCorners(buffer, boundsMin, boundsMax, corners)) {
+            return false;
+        }
+        float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+        float minDepth = INFINITY;
+        for(const ScreenPoint& corner : corners) {
+            minX = std::min(minX, corner.x);
+            maxX = std::max(maxX, corner.x);
+            minY = std::min(minY, corner.y);
+            maxY = std::max(maxY, corner.y);
+            minDepth = std::min(minDepth, corner.depth);
+        }
+        // Every pixel the box's screen rectangle touches, the box covers at most these.
+        int xStart = std::max(0, int(floorf(minX)));
+        int xEnd = std::min(buffer.width, int(ceilf(maxX)));
+        int yStart = std::max(0, int(floorf(minY)));
+        int yEnd = std::min(buffer.height, int(ceilf(maxY)));
+        if(xStart >= xEnd || yStart >= yEnd) {
+            return false;
+        }
+        float threshold = minDepth - OCCLUSION_DEPTH_BIAS;
+        for(int y = yStart; y < yEnd; y++) {
+            const float* row = buffer.depth.data() + size_t(y) * buffer.width;
+            int x = xStart;
+#if PROJV_OCCLUSION_SSE2
+            const __m128 thresholds = _mm_set1_ps(threshold);
+            for(; x + 4 <= xEnd; x += 4) {
+                if(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(row + x), thresholds)) != 0xF) {
+                    return false;
+                }
+            }
+#endif
+            for(; x < xEnd; x++) {
+                if(!(row[x] < threshold)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::vector<GPUVisibleChunk> removeOccludedChunks(const Scene& scene, const std::vector<std::vector<OccluderBox>>& chunkOccluders, const std::vector<GPUVisibleChunk>& visibleChunks,
+                                                      const core::mat4& viewProjection, core::vec3 cameraPosition, OcclusionBuffer& buffer, const OcclusionCullingSettings& settings) {
+        if(chunkOccluders.size() != scene.chunks.size()) {
+            throw std::invalid_argument("removeOccludedChunks: Got occluders for " + std::to_string(chunkOccluders.size()) + " chunks, the scene has " + std::to_string(scene.chunks.size()));
+        }
+        clearOcclusionBuffer(buffer, settings.width, settings.height, viewProjection, cameraPosition);
+        size_t occluderChunks = std::min<size_t>(settings.occluderChunks, visibleChunks.size());
+        for(size_t i = 0; i < occluderChunks; i++) {
+            for(const OccluderBox& occluder : chunkOccluders[visibleChunks[i].headerIndex]) {
+                rasterizeOccluder(buffer, occluder);
+            }
+        }
+
+        std::vector<GPUVisibleChunk> unoccludedChunks;
+        for(const GPUVisibleChunk& visibleChunk : visibleChunks) {
+            const ChunkHeader& header = scene.chunks[visibleChunk.headerIndex].header;
+            if(!isBoxOccluded(buffer, header.position, header.position + core::vec3(header.scale))) {
+                unoccludedChunks.push_back(visibleChunk);
+            }
+        }
+        return unoccludedChunks;
+    }
+}
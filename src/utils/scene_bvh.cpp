@@ -0,0 +1,476 @@
+#include "utils/scene_bvh.h"
+
+namespace projv::utils {
+    void setSceneBVHNodeToChunkBounds(SceneBVHNode& node, const ChunkHeader& chunkHeader) {
+        node.boundsMin = chunkHeader.position;
+        node.boundsMax = chunkHeader.position + core::vec3(chunkHeader.scale);
+    }
+
+    float getSceneBVHBoundsArea(const core::vec3& boundsMin, const core::vec3& boundsMax) {
+        core::vec3 size = boundsMax - boundsMin;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    // Area of the bounds containing both a and b.
+    float getSceneBVHCombinedArea(const SceneBVHNode& a, const SceneBVHNode& b) {
+        core::vec3 boundsMin(std::min(a.boundsMin.x, b.boundsMin.x), std::min(a.boundsMin.y, b.boundsMin.y), std::min(a.boundsMin.z, b.boundsMin.z));
+        core::vec3 boundsMax(std::max(a.boundsMax.x, b.boundsMax.x), std::max(a.boundsMax.y, b.boundsMax.y), std::max(a.boundsMax.z, b.boundsMax.z));
+        return getSceneBVHBoundsArea(boundsMin, boundsMax);
+    }
+
+    int allocateSceneBVHNode(SceneBVH& sceneBVH) {
+        int nodeIndex;
+        if(!sceneBVH.freeNodes.empty()) {
+            nodeIndex = sceneBVH.freeNodes.back();
+            sceneBVH.freeNodes.pop_back();
+        } else {
+            nodeIndex = int(sceneBVH.nodes.size());
+            sceneBVH.nodes.emplace_back();
+        }
+        SceneBVHNode& node = sceneBVH.nodes[nodeIndex];
+        node.boundsMin = core::vec3(0.0f);
+        node.boundsMax = core::vec3(0.0f);
+        node.parent = -1;
+        node.left = -1;
+        node.right = -1;
+        node.chunkID = 0;
+        node.chunkIndex = 0;
+        return nodeIndex;
+    }
+
+    // Recomputes the bounds of an inner node from its children.
+    void refitSceneBVHNode(SceneBVH& sceneBVH, int nodeIndex) {
+        SceneBVHNode& node = sceneBVH.nodes[nodeIndex];
+        const SceneBVHNode& left = sceneBVH.nodes[node.left];
+        const SceneBVHNode& right = sceneBVH.nodes[node.right];
+        node.boundsMin = core::vec3(std::min(left.boundsMin.x, right.boundsMin.x), std::min(left.boundsMin.y, right.boundsMin.y), std::min(left.boundsMin.z, right.boundsMin.z));
+        node.boundsMax = core::vec3(std::max(left.boundsMax.x, right.boundsMax.x), std::max(left.boundsMax.y, right.boundsMax.y), std::max(left.boundsMax.z, right.boundsMax.z));
+    }
+
+    // Recomputes the bounds of nodeIndex and every node above it.
+    void refitSceneBVHAncestors(SceneBVH& sceneBVH, int nodeIndex) {
+        while(nodeIndex != -1) {
+            refitSceneBVHNode(sceneBVH, nodeIndex);
+            nodeIndex = sceneBVH.nodes[nodeIndex].parent;
+        }
+    }
+
+    // Builds the subtree over chunkIndices[first, last) and returns its node.
+    int buildSceneBVHRange(SceneBVH& sceneBVH, const Scene& scene, std::vector<uint32_t>& chunkIndices, size_t first, size_t last, int parent) {
+        int nodeIndex = allocateSceneBVHNode(sceneBVH);
+        sceneBVH.nodes[nodeIndex].parent = parent;
+        if(last - first == 1) {
+            const Chunk& chunk = scene.chunks[chunkIndices[first]];
+            SceneBVHNode& leaf = sceneBVH.nodes[nodeIndex];
+            setSceneBVHNodeToChunkBounds(leaf, chunk.header);
+            leaf.chunkID = chunk.header.chunkID;
+            leaf.chunkIndex = chunkIndices[first];
+            sceneBVH.leafOfChunk[chunk.header.chunkID] = nodeIndex;
+            return nodeIndex;
+        }
+
+        auto getCenter = [&](uint32_t chunkIndex) {
+            const ChunkHeader& header = scene.chunks[chunkIndex].header;
+            return header.position + core::vec3(header.scale * 0.5f);
+        };
+        core::vec3 centersMin = getCenter(chunkIndices[first]);
+        core::vec3 centersMax = centersMin;
+        for(size_t i = first + 1; i < last; i++) {
+            core::vec3 center = getCenter(chunkIndices[i]);
+            centersMin = core::vec3(std::min(centersMin.x, center.x), std::min(centersMin.y, center.y), std::min(centersMin.z, center.z));
+            centersMax = core::vec3(std::max(centersMax.x, center.x), std::max(centersMax.y, center.y), std::max(centersMax.z, center.z));
+        }
+        core::vec3 extent = centersMax - centersMin;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        size_t middle = first + (last - first) / 2;
+        std::nth_element(chunkIndices.begin() + first, chunkIndices.begin() + middle, chunkIndices.begin() + last, [&](uint32_t a, uint32_t b) {
+            return getCenter(a)[axis] < getCenter(b)[axis];
+        });
+        int left = buildSceneBVHRange(sceneBVH, scene, chunkIndices, first, middle, nodeIndex);
+        int right = buildSceneBVHRange(sceneBVH, scene, chunkIndices, middle, last, nodeIndex);
+        sceneBVH.nodes[nodeIndex].left = left;
+        sceneBVH.nodes[nodeIndex].right = right;
+        refitSceneBVHNode(sceneBVH, nodeIndex);
+        return nodeIndex;
+    }
+
+    SceneBVH createSceneBVH(const Scene& scene) {
+        auto start = std::chrono::high_resolution_clock::now();
+        SceneBVH sceneBVH;
+        std::vector<uint32_t> chunkIndices;
+        std::unordered_set<uint32_t> chunkIDs;
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            if(!chunkIDs.insert(scene.chunks[i].header.chunkID).second) {
+                core::warn("createSceneBVH: Chunk ID {} is used by more than one chunk, only the first is added", scene.chunks[i].header.chunkID);
+                continue;
+            }
+            chunkIndices.emplace_back(uint32_t(i));
+        }
+        if(chunkIndices.empty()) {
+            return sceneBVH;
+        }
+        sceneBVH.nodes.reserve(chunkIndices.size() * 2 - 1);
+        sceneBVH.root = buildSceneBVHRange(sceneBVH, scene, chunkIndices, 0, chunkIndices.size(), -1);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("createSceneBVH: Built hierarchy over {} chunks in {:.2f}ms", chunkIndices.size(), elapsed);
+        return sceneBVH;
+    }
+
+    void insertChunkIntoSceneBVH(SceneBVH& sceneBVH, const ChunkHeader& chunkHeader, uint32_t chunkIndex) {
+        if(sceneBVH.leafOfChunk.count(chunkHeader.chunkID) != 0) {
+            throw std::invalid_argument("insertChunkIntoSceneBVH: Chunk " + std::to_string(chunkHeader.chunkID) + " is already in the hierarchy");
+        }
+        int leafIndex = allocateSceneBVHNode(sceneBVH);
+        SceneBVHNode& leaf = sceneBVH.nodes[leafIndex];
+        setSceneBVHNodeToChunkBounds(leaf, chunkHeader);
+        leaf.chunkID = chunkHeader.chunkID;
+        leaf.chunkIndex = chunkIndex;
+        sceneBVH.leafOfChunk[chunkHeader.chunkID] = leafIndex;
+        if(sceneBVH.root == -1) {
+            sceneBVH.root = leafIndex;
+            return;
+        }
+
+        // Walk down towards the node that grows the least, stopping once placing the leaf here is cheaper than going further.
+        int sibling = sceneBVH.root;
+        while(sceneBVH.nodes[sibling].left != -1) {
+            const SceneBVHNode& node = sceneBVH.nodes[sibling];
+            const SceneBVHNode& newLeaf = sceneBVH.nodes[leafIndex];
+            float combinedArea = getSceneBVHCombinedArea(node, newLeaf);
+            float cost = 2.0f * combinedArea;
+            float inheritedCost = 2.0f * (combinedArea - getSceneBVHBoundsArea(node.boundsMin, node.boundsMax));
+            auto getChildCost = [&](int child) {
+                const SceneBVHNode& childNode = sceneBVH.nodes[child];
+                float childCost = getSceneBVHCombinedArea(childNode, newLeaf);
+                if(childNode.left != -1) {
+                    childCost -= getSceneBVHBoundsArea(childNode.boundsMin, childNode.boundsMax);
+                }
+                return childCost + inheritedCost;
+            };
+            float leftCost = getChildCost(node.left);
+            float rightCost = getChildCost(node.right);
+            if(cost < leftCost && cost < rightCost) {
+                break;
+            }
+            sibling = leftCost < rightCost ? node.left : node.right;
+        }
+
+        int oldParent = sceneBVH.nodes[sibling].parent;
+        int newParent = allocateSceneBVHNode(sceneBVH);
+        sceneBVH.nodes[newParent].parent = oldParent;
+        sceneBVH.nodes[newParent].left = sibling;
+        sceneBVH.nodes[newParent].right = leafIndex;
+        sceneBVH.nodes[sibling].parent = newParent;
+        sceneBVH.nodes[leafIndex].parent = newParent;
+        if(oldParent == -1) {
+            sceneBVH.root = newParent;
+        } else if(sceneBVH.nodes[oldParent].left == sibling) {
+            sceneBVH.nodes[oldParent].left = newParent;
+        } else {
+            sceneBVH.nodes[oldParent].right = newParent;
+        }
+        refitSceneBVHAncestors(sceneBVH, newParent);
+    }
+
+    bool removeChunkFromSceneBVH(SceneBVH& sceneBVH, uint32_t chunkID) {
+        auto leafOfChunk = sceneBVH.leafOfChunk.find(chunkID);
+        if(leafOfChunk == sceneBVH.leafOfChunk.end()) {
+            return false;
+        }
+        int leafIndex = leafOfChunk->second;
+        sceneBVH.leafOfChunk.erase(leafOfChunk);
+        sceneBVH.freeNodes.emplace_back(leafIndex);
+        if(leafIndex == sceneBVH.root) {
+            sceneBVH.root = -1;
+            return true;
+        }
+
+        int parent = sceneBVH.nodes[leafIndex].parent;
+        int sibling = sceneBVH.nodes[parent].left == leafIndex ? sceneBVH.nodes[parent].right : sceneBVH.nodes[parent].left;
+        int grandParent = sceneBVH.nodes[parent].parent;
+        sceneBVH.nodes[sibling].parent = grandParent;
+        sceneBVH.freeNodes.emplace_back(parent);
+        if(grandParent == -1) {
+            sceneBVH.root = sibling;
+            return true;
+        }
+        if(sceneBVH.nodes[grandParent].left == parent) {
+            sceneBVH.nodes[grandParent].left = sibling;
+        } else {
+            sceneBVH.nodes[grandParent].right = sibling;
+        }
+        refitSceneBVHAncestors(sceneBVH, grandParent);
+        return true;
+    }
+
+    void updateSceneBVH(SceneBVH& sceneBVH, const Scene& scene) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::unordered_set<uint32_t> sceneChunkIDs;
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            sceneChunkIDs.insert(scene.chunks[i].header.chunkID);
+        }
+
+        std::vector<uint32_t> removedChunkIDs;
+        for(const auto& [chunkID, leafIndex] : sceneBVH.leafOfChunk) {
+            if(sceneChunkIDs.count(chunkID) == 0) {
+                removedChunkIDs.emplace_back(chunkID);
+            }
+        }
+        for(uint32_t chunkID : removedChunkIDs) {
+            removeChunkFromSceneBVH(sceneBVH, chunkID);
+        }
+
+        size_t insertedChunks = 0;
+        size_t movedChunks = 0;
+        std::unordered_set<uint32_t> visitedChunkIDs;
+        for(size_t i = 0; i < scene.chunks.size(); i++) {
+            const ChunkHeader& header = scene.chunks[i].header;
+            if(!visitedChunkIDs.insert(header.chunkID).second) {
+                continue;
+            }
+            auto leafOfChunk = sceneBVH.leafOfChunk.find(header.chunkID);
+            if(leafOfChunk == sceneBVH.leafOfChunk.end()) {
+                insertChunkIntoSceneBVH(sceneBVH, header, uint32_t(i));
+                insertedChunks++;
+                continue;
+            }
+            SceneBVHNode& leaf = sceneBVH.nodes[leafOfChunk->second];
+            leaf.chunkIndex = uint32_t(i);
+            SceneBVHNode chunkBounds = leaf;
+            setSceneBVHNodeToChunkBounds(chunkBounds, header);
+            if(chunkBounds.boundsMin != leaf.boundsMin || chunkBounds.boundsMax != leaf.boundsMax) {
+                leaf.boundsMin = chunkBounds.boundsMin;
+                leaf.boundsMax = chunkBounds.boundsMax;
+                refitSceneBVHAncestors(sceneBVH, leaf.parent);
+                movedChunks++;
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("updateSceneBVH: Inserted {}, removed {} and refit {} chunks in {:.2f}ms", insertedChunks, removedChunkIDs.size(), movedChunks, elapsed);
+    }
+
+    std::vector<GPUSceneBVHNode> createGPUSceneBVH(const SceneBVH& sceneBVH) {
+        std::vector<GPUSceneBVHNode> gpuNodes;
+        if(sceneBVH.root == -1) {
+            gpuNodes.push_back({INFINITY, INFINITY, INFINITY, SCENE_BVH_END, -INFINITY, -INFINITY, -INFINITY, SCENE_BVH_END});
+            return gpuNodes;
+        }
+
+        // Depth first, left before right. The node to skip to is whatever would be taken off the stack after the whole subtree.
+        std::vector<int> order;
+        std::vector<int> skipNodes;
+        std::vector<int> stack = {sceneBVH.root};
+        while(!stack.empty()) {
+            int nodeIndex = stack.back();
+            stack.pop_back();
+            order.emplace_back(nodeIndex);
+            skipNodes.emplace_back(stack.empty() ? -1 : stack.back());
+            const SceneBVHNode& node = sceneBVH.nodes[nodeIndex];
+            if(node.left != -1) {
+                stack.emplace_back(node.right);
+                stack.emplace_back(node.left);
+            }
+        }
+
+        std::vector<uint32_t> gpuIndices(sceneBVH.nodes.size(), SCENE_BVH_END);
+        for(size_t i = 0; i < order.size(); i++) {
+            gpuIndices[order[i]] = uint32_t(i);
+        }
+        gpuNodes.reserve(order.size());
+        for(size_t i = 0; i < order.size(); i++) {
+            const SceneBVHNode& node = sceneBVH.nodes[order[i]];
+            GPUSceneBVHNode gpuNode;
+            gpuNode.minX = node.boundsMin.x;
+            gpuNode.minY = node.boundsMin.y;
+            gpuNode.minZ = node.boundsMin.z;
+            gpuNode.skipIndex = skipNodes[i] == -1 ? SCENE_BVH_END : gpuIndices[skipNodes[i]];
+            gpuNode.maxX = node.boundsMax.x;
+            gpuNode.maxY = node.boundsMax.y;
+            gpuNode.maxZ = node.boundsMax.z;
+            gpuNode.headerIndex = node.left == -1 ? node.chunkIndex : SCENE_BVH_END;
+            gpuNodes.emplace_back(gpuNode);
+        }
+        return gpuNodes;
+    }
+
+    // Returns the distance along the ray to where it enters the bounds, 0 when it starts inside and -1 when it misses them.
+    float getRayBoundsEntryDistance(const Ray& ray, const core::vec3& boundsMin, const core::vec3& boundsMax) {
+        float entryDistance = 0.0f;
+        float exitDistance = INFINITY;
+        for(int axis = 0; axis < 3; axis++) {
+            if(ray.direction[axis] == 0.0f) {
+                if(ray.origin[axis] < boundsMin[axis] || ray.origin[axis] > boundsMax[axis]) {
+                    return -1.0f;
+                }
+                continue;
+            }
+            float inverseDirection = 1.0f / ray.direction[axis];
+            float near = (boundsMin[axis] - ray.origin[axis]) * inverseDirection;
+            float far = (boundsMax[axis] - ray.origin[axis]) * inverseDirection;
+            if(near > far) {
+                std::swap(near, far);
+            }
+            entryDistance = std::max(entryDistance, near);
+            exitDistance = std::min(exitDistance, far);
+        }
+        return entryDistance <= exitDistance ? entryDistance : -1.0f;
+    }
+
+    SceneRayHit castRayThroughScene(const Scene& scene, const SceneBVH& sceneBVH, const Ray& ray, uint32_t maxSteps) {
+        SceneRayHit sceneHit;
+        sceneHit.voxelHit.hit = false;
+        sceneHit.voxelHit.distance = -1.0f;
+        sceneHit.voxelHit.voxelPosition = core::ivec3(0);
+        sceneHit.voxelHit.ZOrder = 0;
+        sceneHit.voxelHit.normal = core::ivec3(0);
+        sceneHit.voxelHit.voxelTypeDataIndex = UINT32_MAX;
+        sceneHit.voxelHit.nodeIndex = UINT32_MAX;
+        sceneHit.voxelHit.steps = 0;
+        sceneHit.chunkIndex = 0;
+        sceneHit.chunksTested = 0;
+        if(sceneBVH.root == -1) {
+            return sceneHit;
+        }
+
+        float closestDistance = INFINITY;
+        std::array<std::pair<int, float>, 64> stack;
+        std::vector<std::pair<int, float>> overflowStack; // Only used by very unbalanced hierarchies.
+        size_t stackSize = 0;
+        auto push = [&](int nodeIndex, float distance) {
+            if(stackSize < stack.size()) {
+                stack[stackSize++] = {nodeIndex, distance};
+            } else {
+                overflowStack.emplace_back(nodeIndex, distance);
+            }
+        };
+        float rootDistance = getRayBoundsEntryDistance(ray, sceneBVH.nodes[sceneBVH.root].boundsMin, sceneBVH.nodes[sceneBVH.root].boundsMax);
+        if(rootDistance >= 0.0f) {
+            push(sceneBVH.root, rootDistance);
+        }
+        while(stackSize > 0 || !overflowStack.empty()) {
+            std::pair<int, float> entry;
+            if(!overflowStack.empty()) {
+                entry = overflowStack.back();
+                overflowStack.pop_back();
+            } else {
+                entry = stack[--stackSize];
+            }
+            if(entry.second >= closestDistance) {
+                continue;
+            }
+            const SceneBVHNode& node = sceneBVH.nodes[entry.first];
+            if(node.left == -1) {
+                RayHit hit = castRayThroughChunk(scene.chunks[node.chunkIndex], ray, maxSteps);
+                sceneHit.chunksTested++;
+                if(hit.hit && hit.distance < closestDistance) {
+                    closestDistance = hit.distance;
+                    sceneHit.voxelHit = hit;
+                    sceneHit.chunkIndex = node.chunkIndex;
+                }
+                continue;
+            }
+            // Push the farther child first so the closer one is visited next.
+            float leftDistance = getRayBoundsEntryDistance(ray, sceneBVH.nodes[node.left].boundsMin, sceneBVH.nodes[node.left].boundsMax);
+            float rightDistance = getRayBoundsEntryDistance(ray, sceneBVH.nodes[node.right].boundsMin, sceneBVH.nodes[node.right].boundsMax);
+            bool leftFirst = leftDistance >= 0.0f && (rightDistance < 0.0f || leftDistance <= rightDistance);
+            int nearChild = leftFirst ? node.left : node.right;
+            int farChild = leftFirst ? node.right : node.left;
+            float nearDistance = leftFirst ? leftDistance : rightDistance;
+            float farDistance = leftFirst ? rightDistance : leftDistance;
+            if(farDistance >= 0.0f && farDistance < closestDistance) {
+                push(farChild, farDistance);
+            }
+            if(nearDistance >= 0.0f && nearDistance < closestDistance) {
+                push(nearChild, nearDistance);
+            }
+        }
+        return sceneHit;
+    }
+
+    uint32_t findChunkInSceneBVH(const SceneBVH& sceneBVH, core::vec3 worldPosition) {
+        if(sceneBVH.root == -1) {
+            return UINT32_MAX;
+        }
+        std::array<int, 64> stack;
+        std::vector<int> overflowStack; // Only used by very unbalanced hierarchies.
+        size_t stackSize = 0;
+        stack[stackSize++] = sceneBVH.root;
+        while(stackSize > 0 || !overflowStack.empty()) {
+            int nodeIndex;
+            if(!overflowStack.empty()) {
+                nodeIndex = overflowStack.back();
+                overflowStack.pop_back();
+            } else {
+                nodeIndex = stack[--stackSize];
+            }
+            const SceneBVHNode& node = sceneBVH.nodes[nodeIndex];
+            bool isLeaf = node.left == -1;
+            bool inside = true;
+            for(int axis = 0; axis < 3; axis++) {
+                // Chunks include their minimum corner but not their maximum one, so neighbouring chunks never both contain a point.
+                inside &= worldPosition[axis] >= node.boundsMin[axis] && (isLeaf ? worldPosition[axis] < node.boundsMax[axis] : worldPosition[axis] <= node.boundsMax[axis]);
+            }
+            if(!inside) {
+                continue;
+            }
+            if(isLeaf) {
+                return node.chunkIndex;
+            }
+            for(int child : {node.left, node.right}) {
+                if(stackSize < stack.size()) {
+                    stack[stackSize++] = child;
+                } else {
+                    overflowStack.push_back(child);
+                }
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    std::vector<uint32_t> findChunksInSceneBVH(const SceneBVH& sceneBVH, const VoxelRegion& region) {
+        std::vector<uint32_t> chunkIndices;
+        if(sceneBVH.root == -1) {
+            return chunkIndices;
+        }
+        std::vector<int> stack = {sceneBVH.root};
+        while(!stack.empty()) {
+            const SceneBVHNode& node = sceneBVH.nodes[stack.back()];
+            stack.pop_back();
+            if(classifyBoundsInVoxelRegion(region, node.boundsMin, node.boundsMax) == VoxelRegionOverlap::Outside) {
+                continue;
+            }
+            if(node.left == -1) {
+                chunkIndices.push_back(node.chunkIndex);
+                continue;
+            }
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+        }
+        std::sort(chunkIndices.begin(), chunkIndices.end());
+        return chunkIndices;
+    }
+
+    std::vector<GPUVisibleChunk> createVisibleChunkList(const Scene& scene, const SceneBVH& sceneBVH, const core::mat4& viewProjection, core::vec3 cameraPosition, bool homogeneousDepth) {
+        std::vector<GPUVisibleChunk> visibleChunks;
+        for(uint32_t chunkIndex : findChunksInSceneBVH(sceneBVH, createFrustumVoxelRegion(viewProjection, homogeneousDepth))) {
+            const ChunkHeader& header = scene.chunks[chunkIndex].header;
+            core::vec3 closestPoint = core::clamp(cameraPosition, header.position, header.position + core::vec3(header.scale));
+            GPUVisibleChunk visibleChunk;
+            visibleChunk.headerIndex = chunkIndex;
+            visibleChunk.distance = core::length(closestPoint - cameraPosition);
+            visibleChunk.padding[0] = 0;
+            visibleChunk.padding[1] = 0;
+            visibleChunks.push_back(visibleChunk);
+        }
+        // Ties keep the header order, so the list (and the image) doesn't flicker between frames.
+        std::stable_sort(visibleChunks.begin(), visibleChunks.end(), [](const GPUVisibleChunk& a, const GPUVisibleChunk& b) {
+            return a.distance < b.distance;
+        });
+        return visibleChunks;
+    }
+}
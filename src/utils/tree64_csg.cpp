@@ -0,0 +1,245 @@
+#include "utils/tree64_csg.h"
+
+namespace projv::utils {
+    constexpr size_t NO_TREE64_NODE = SIZE_MAX;
+
+    struct Tree64CSGBuilder {
+        const std::vector<uint32_t>* tree64A;
+        const std::vector<uint32_t>* tree64B;
+        const std::vector<uint32_t>* voxelTypeDataA;
+        const std::vector<uint32_t>* voxelTypeDataB;
+        int levelsOfDepth;
+        VoxelColorPrecedence colorPrecedence;
+        std::array<std::vector<uint32_t>, MAX_TREE64_LEVELS> levels; // Output nodes of each depth: [mask1][mask2][index of the first child in the next level]
+        std::vector<uint32_t> voxelTypeData;
+        size_t voxelCursorA = 0; // Voxels of voxelTypeDataA before the cursor have already been passed.
+        size_t voxelCursorB = 0;
+        size_t visitedNodeCount = 0;
+        std::vector<uint8_t> solidA; // Whether every voxel below a node of tree64A is set, only for the operand the operation prunes with.
+        std::vector<uint8_t> solidB;
+    };
+
+    // Flags the nodes whose every voxel is set, in one pass from the last node back since children are always stored after their parent.
+    std::vector<uint8_t> createSolidSubtreeFlagsTree64(const std::vector<uint32_t>& tree64) {
+        size_t nodeCount = tree64.size() / 3;
+        std::vector<uint8_t> solid(nodeCount, 0);
+        for(size_t nodeIndex = nodeCount; nodeIndex-- > 0;) {
+            const uint32_t* node = tree64.data() + nodeIndex * 3;
+            if(getTree64ValidMask(node) != UINT64_MAX) {
+                continue;
+            }
+            if(isTree64LeafParent(node)) {
+                solid[nodeIndex] = 1;
+                continue;
+            }
+            size_t firstChild = nodeIndex + getTree64ChildPointer(node);
+            if(firstChild + 64 > nodeCount) {
+                throw std::invalid_argument("applyCSGToTree64: Node " + std::to_string(nodeIndex) + " points past the end of the tree64");
+            }
+            solid[nodeIndex] = std::all_of(solid.begin() + firstChild, solid.begin() + firstChild + 64, [](uint8_t childSolid) { return childSolid != 0; });
+        }
+        return solid;
+    }
+
+    // Settles what it can about a pair of subtrees before they are walked. Returns false when the pair leaves no voxels.
+    // Otherwise one side may be removed, with the operation turned into a Union so the other side is copied as is.
+    bool pruneSubtreePairTree64CSG(const Tree64CSGBuilder& builder, size_t& nodeA, size_t& nodeB, Tree64CSGOperation& operation) {
+        bool hasA = nodeA != NO_TREE64_NODE;
+        bool hasB = nodeB != NO_TREE64_NODE;
+        bool keepA = builder.colorPrecedence == VoxelColorPrecedence::KeepA;
+        switch(operation) {
+            case Tree64CSGOperation::Union:
+                if(hasA && hasB) {
+                    if(keepA && builder.solidA[nodeA]) {
+                        nodeB = NO_TREE64_NODE;
+                    } else if(!keepA && builder.solidB[nodeB]) {
+                        nodeA = NO_TREE64_NODE;
+                    }
+                }
+                return hasA || hasB;
+            case Tree64CSGOperation::Subtract:
+                if(!hasA) {
+                    return false;
+                }
+                if(!hasB) {
+                    operation = Tree64CSGOperation::Union;
+                    return true;
+                }
+                return !builder.solidB[nodeB];
+            case Tree64CSGOperation::Intersect:
+                if(!hasA || !hasB) {
+                    return false;
+                }
+                if(keepA && builder.solidB[nodeB]) {
+                    nodeB = NO_TREE64_NODE;
+                    operation = Tree64CSGOperation::Union;
+                } else if(!keepA && builder.solidA[nodeA]) {
+                    nodeA = NO_TREE64_NODE;
+                    operation = Tree64CSGOperation::Union;
+                }
+                return true;
+        }
+        return false;
+    }
+
+    // Copies the voxelTypeData entry of ZOrder from one operand. Voxels are visited in increasing Z-Order, so the cursor only moves forward
+    // and pruned subtrees are skipped with a binary search over the rest of the data.
+    void appendVoxelTypeDataTree64CSG(Tree64CSGBuilder& builder, bool fromA, uint32_t ZOrder) {
+        const std::vector<uint32_t>& voxelTypeData = fromA ? *builder.voxelTypeDataA : *builder.voxelTypeDataB;
+        size_t& cursor = fromA ? builder.voxelCursorA : builder.voxelCursorB;
+        size_t low = cursor;
+        size_t high = voxelTypeData.size() / 3;
+        if(low < high && voxelTypeData[low * 3] != ZOrder) {
+            while(low < high) {
+                size_t middle = low + (high - low) / 2;
+                if(voxelTypeData[middle * 3] < ZOrder) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+        }
+        if(low >= voxelTypeData.size() / 3 || voxelTypeData[low * 3] != ZOrder) {
+            throw std::runtime_error("applyCSGToTree64: Voxel with Z-Order " + std::to_string(ZOrder) + " is in tree64 " + (fromA ? "A" : "B") + " but not in its voxelTypeData");
+        }
+        builder.voxelTypeData.insert(builder.voxelTypeData.end(), voxelTypeData.begin() + low * 3, voxelTypeData.begin() + low * 3 + 3);
+        cursor = low + 1;
+    }
+
+    // Combines the subtrees at nodeA and nodeB, either of which may be NO_TREE64_NODE. Children are combined before their parent is appended to its level,
+    // which keeps the children of every node together and in order, the same as the breadth first layout of a tree64.
+    // Returns whether the combined subtree has any voxels, nothing is appended when it doesn't.
+    bool combineSubtreesTree64CSG(Tree64CSGBuilder& builder, size_t nodeA, size_t nodeB, int depth, uint32_t ZOrderPrefix, Tree64CSGOperation operation) {
+        builder.visitedNodeCount++;
+        const uint32_t* node1 = nodeA != NO_TREE64_NODE ? builder.tree64A->data() + nodeA * 3 : nullptr;
+        const uint32_t* node2 = nodeB != NO_TREE64_NODE ? builder.tree64B->data() + nodeB * 3 : nullptr;
+        uint64_t validMaskA = node1 ? getTree64ValidMask(node1) : 0;
+        uint64_t validMaskB = node2 ? getTree64ValidMask(node2) : 0;
+
+        uint64_t combinedMask = 0;
+        if(depth == builder.levelsOfDepth - 1) {
+            if(operation == Tree64CSGOperation::Union) {
+                combinedMask = validMaskA | validMaskB;
+            } else if(operation == Tree64CSGOperation::Subtract) {
+                combinedMask = validMaskA & ~validMaskB;
+            } else {
+                combinedMask = validMaskA & validMaskB;
+            }
+            for(uint32_t zOrderInParent = 0; zOrderInParent < 64; zOrderInParent++) {
+                if(!isTree64ChildValid(combinedMask, zOrderInParent)) {
+                    continue;
+                }
+                bool inA = isTree64ChildValid(validMaskA, zOrderInParent);
+                bool inB = isTree64ChildValid(validMaskB, zOrderInParent);
+                bool fromA = inA && (!inB || operation == Tree64CSGOperation::Subtract || builder.colorPrecedence == VoxelColorPrecedence::KeepA);
+                appendVoxelTypeDataTree64CSG(builder, fromA, (ZOrderPrefix << 6) | zOrderInParent);
+            }
+            if(combinedMask == 0) {
+                return false;
+            }
+            builder.levels[depth].insert(builder.levels[depth].end(), {uint32_t(combinedMask >> 32), uint32_t(combinedMask), 0});
+            return true;
+        }
+
+        uint32_t firstChild = builder.levels[depth + 1].size() / 3;
+        size_t childA = node1 ? nodeA + getTree64ChildPointer(node1) : NO_TREE64_NODE;
+        size_t childB = node2 ? nodeB + getTree64ChildPointer(node2) : NO_TREE64_NODE;
+        for(uint32_t zOrderInParent = 0; zOrderInParent < 64; zOrderInParent++) {
+            bool inA = isTree64ChildValid(validMaskA, zOrderInParent);
+            bool inB = isTree64ChildValid(validMaskB, zOrderInParent);
+            if(!inA && !inB) {
+                continue;
+            }
+            size_t childNodeA = inA ? childA++ : NO_TREE64_NODE;
+            size_t childNodeB = inB ? childB++ : NO_TREE64_NODE;
+            Tree64CSGOperation childOperation = operation;
+            if(!pruneSubtreePairTree64CSG(builder, childNodeA, childNodeB, childOperation)) {
+                continue;
+            }
+            if(combineSubtreesTree64CSG(builder, childNodeA, childNodeB, depth + 1, (ZOrderPrefix << 6) | zOrderInParent, childOperation)) {
+                combinedMask |= 1ull << (63 - zOrderInParent);
+            }
+        }
+        if(combinedMask == 0) {
+            return false;
+        }
+        builder.levels[depth].insert(builder.levels[depth].end(), {uint32_t(combinedMask >> 32), uint32_t(combinedMask), firstChild});
+        return true;
+    }
+
+    Tree64CSGResult applyCSGToTree64(const std::vector<uint32_t>& tree64A, const std::vector<uint32_t>& voxelTypeDataA, const std::vector<uint32_t>& tree64B, const std::vector<uint32_t>& voxelTypeDataB, int gridResolution, Tree64CSGOperation operation, VoxelColorPrecedence colorPrecedence) {
+        auto start = std::chrono::high_resolution_clock::now();
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("applyCSGToTree64: Resolution " + std::to_string(gridResolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+
+        Tree64CSGBuilder builder;
+        builder.tree64A = &tree64A;
+        builder.tree64B = &tree64B;
+        builder.voxelTypeDataA = &voxelTypeDataA;
+        builder.voxelTypeDataB = &voxelTypeDataB;
+        builder.levelsOfDepth = levelsOfDepth;
+        builder.colorPrecedence = colorPrecedence;
+        builder.voxelTypeData.reserve(operation == Tree64CSGOperation::Union ? voxelTypeDataA.size() + voxelTypeDataB.size() : voxelTypeDataA.size());
+        // Only one operand is ever checked for solid subtrees: the one whose voxels win a Union or Intersect, the removed one of a Subtract.
+        bool keepA = colorPrecedence == VoxelColorPrecedence::KeepA;
+        if((operation == Tree64CSGOperation::Union && keepA) || (operation == Tree64CSGOperation::Intersect && !keepA)) {
+            builder.solidA = createSolidSubtreeFlagsTree64(tree64A);
+        } else {
+            builder.solidB = createSolidSubtreeFlagsTree64(tree64B);
+        }
+
+        size_t rootA = tree64A.empty() ? NO_TREE64_NODE : 0;
+        size_t rootB = tree64B.empty() ? NO_TREE64_NODE : 0;
+        if(pruneSubtreePairTree64CSG(builder, rootA, rootB, operation)) {
+            combineSubtreesTree64CSG(builder, rootA, rootB, 0, 0, operation);
+        }
+
+        // Lay the levels out one after another and turn the child indices into relative pointers.
+        std::array<size_t, MAX_TREE64_LEVELS + 1> levelStarts;
+        levelStarts[0] = 0;
+        for(int depth = 0; depth < levelsOfDepth; depth++) {
+            levelStarts[depth + 1] = levelStarts[depth] + builder.levels[depth].size() / 3;
+        }
+
+        Tree64CSGResult result;
+        result.geometryData.reserve(levelStarts[levelsOfDepth] * 3);
+        for(int depth = 0; depth < levelsOfDepth; depth++) {
+            const std::vector<uint32_t>& level = builder.levels[depth];
+            for(size_t i = 0; i < level.size() / 3; i++) {
+                result.geometryData.emplace_back(level[i * 3]);
+                result.geometryData.emplace_back(level[i * 3 + 1]);
+                if(depth == levelsOfDepth - 1) {
+                    result.geometryData.emplace_back(0b1);
+                } else {
+                    uint32_t pointer = uint32_t(levelStarts[depth + 1] + level[i * 3 + 2] - (levelStarts[depth] + i));
+                    result.geometryData.emplace_back(pointer << 1);
+                }
+            }
+        }
+        result.voxelTypeData = std::move(builder.voxelTypeData);
+        result.visitedNodeCount = builder.visitedNodeCount;
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("applyCSGToTree64: Combined {} + {} nodes into {} nodes ({} voxels), visiting {} node pairs in {:.2f}ms", tree64A.size() / 3, tree64B.size() / 3, result.geometryData.size() / 3, result.voxelTypeData.size() / 3, result.visitedNodeCount, elapsed);
+        return result;
+    }
+
+    void applyCSGToChunk(Chunk& chunk, const Chunk& otherChunk, Tree64CSGOperation operation, VoxelColorPrecedence colorPrecedence) {
+        if(chunk.LOD != 0 || otherChunk.LOD != 0) {
+            throw std::invalid_argument("applyCSGToChunk: Chunks " + std::to_string(chunk.header.chunkID) + " and " + std::to_string(otherChunk.header.chunkID) + " must both be at LOD 0");
+        }
+        if(chunk.header.resolution != otherChunk.header.resolution) {
+            throw std::invalid_argument("applyCSGToChunk: Chunk " + std::to_string(chunk.header.chunkID) + " has resolution " + std::to_string(chunk.header.resolution) + " but chunk " + std::to_string(otherChunk.header.chunkID) + " has resolution " + std::to_string(otherChunk.header.resolution));
+        }
+        Tree64CSGResult result = applyCSGToTree64(chunk.geometryData, chunk.voxelTypeData, otherChunk.geometryData, otherChunk.voxelTypeData, chunk.header.resolution, operation, colorPrecedence);
+        chunk.geometryData = std::move(result.geometryData);
+        chunk.voxelTypeData = std::move(result.voxelTypeData);
+        if(!chunk.nodeColorData.empty()) {
+            chunk.nodeColorData = createTree64NodeColors(chunk.geometryData, chunk.voxelTypeData);
+        }
+        bumpChunkRevision(chunk);
+    }
+}
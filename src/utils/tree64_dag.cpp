@@ -0,0 +1,126 @@
+#include "utils/tree64_dag.h"
+
+namespace projv::utils {
+    struct Tree64DAGNodeKeyHash {
+        size_t operator()(const std::array<uint32_t, 4>& key) const {
+            uint64_t hash = 1469598103934665603ull;
+            for(uint32_t value : key) {
+                hash = (hash ^ value) * 1099511628211ull;
+            }
+            return size_t(hash);
+        }
+    };
+
+    struct Tree64DAGBlockHash {
+        size_t operator()(const std::vector<uint32_t>& block) const {
+            uint64_t hash = 1469598103934665603ull;
+            for(uint32_t value : block) {
+                hash = (hash ^ value) * 1099511628211ull;
+            }
+            return size_t(hash);
+        }
+    };
+
+    struct Tree64DAGBuilder {
+        const std::vector<uint32_t>* tree64;
+        std::vector<std::array<uint32_t, 4>> uniqueNodes; // [mask1][mask2][last slice of a parent of leaves, else 0][block id, or UINT32_MAX for none]
+        std::vector<std::vector<uint32_t>> blocks; // Unique node ids of the children of a unique node, in Z-Order.
+        std::unordered_map<std::array<uint32_t, 4>, uint32_t, Tree64DAGNodeKeyHash> nodeIDs;
+        std::unordered_map<std::vector<uint32_t>, uint32_t, Tree64DAGBlockHash> blockIDs;
+    };
+
+    // Returns the unique node id of the subtree at nodeIndex, interning its children first.
+    uint32_t internSubtreeTree64DAG(Tree64DAGBuilder& builder, size_t nodeIndex) {
+        const uint32_t* node = builder.tree64->data() + nodeIndex * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        bool leafParent = isTree64LeafParent(node);
+
+        uint32_t blockID = UINT32_MAX;
+        if(!leafParent && validMask != 0) {
+            std::vector<uint32_t> block;
+            block.reserve(__builtin_popcountll(validMask));
+            size_t firstChild = nodeIndex + getTree64ChildPointer(node);
+            for(int i = 0; i < __builtin_popcountll(validMask); i++) {
+                block.emplace_back(internSubtreeTree64DAG(builder, firstChild + i));
+            }
+            auto inserted = builder.blockIDs.emplace(block, uint32_t(builder.blocks.size()));
+            if(inserted.second) {
+                builder.blocks.emplace_back(std::move(block));
+            }
+            blockID = inserted.first->second;
+        }
+
+        // Parents of leaves keep their whole last slice, so attribute offsets (addAttributeOffsetsTree64) are never merged away.
+        std::array<uint32_t, 4> key = {node[0], node[1], leafParent ? node[2] : 0u, blockID};
+        auto inserted = builder.nodeIDs.emplace(key, uint32_t(builder.uniqueNodes.size()));
+        if(inserted.second) {
+            builder.uniqueNodes.emplace_back(key);
+        }
+        return inserted.first->second;
+    }
+
+    Tree64DAG createTree64DAG(const std::vector<uint32_t>& tree64) {
+        auto start = std::chrono::high_resolution_clock::now();
+        Tree64DAG dag;
+        dag.treeNodeCount = tree64.size() / 3;
+        dag.uniqueNodeCount = 0;
+        dag.dagNodeCount = 0;
+        dag.compressionRatio = 1.0f;
+        if(tree64.empty()) {
+            return dag;
+        }
+
+        Tree64DAGBuilder builder;
+        builder.tree64 = &tree64;
+        uint32_t rootID = internSubtreeTree64DAG(builder, 0);
+
+        // Lay the DAG out level by level. Each level holds the distinct sibling blocks referenced by the level above,
+        // so parents always come before the blocks they point to.
+        std::vector<uint32_t> currentLevel = {rootID};
+        size_t levelStart = 0;
+        bool childPointerTooLarge = false;
+        while(!currentLevel.empty()) {
+            std::vector<uint32_t> nextLevel;
+            std::unordered_map<uint32_t, size_t> blockPositions;
+            size_t nextLevelStart = levelStart + currentLevel.size();
+            for(size_t i = 0; i < currentLevel.size(); i++) {
+                uint32_t blockID = builder.uniqueNodes[currentLevel[i]][3];
+                if(blockID == UINT32_MAX || blockPositions.count(blockID) != 0) {
+                    continue;
+                }
+                blockPositions[blockID] = nextLevelStart + nextLevel.size();
+                nextLevel.insert(nextLevel.end(), builder.blocks[blockID].begin(), builder.blocks[blockID].end());
+            }
+
+            for(size_t i = 0; i < currentLevel.size(); i++) {
+                const std::array<uint32_t, 4>& node = builder.uniqueNodes[currentLevel[i]];
+                uint64_t childPointer = 0;
+                if(node[3] != UINT32_MAX) {
+                    childPointer = blockPositions[node[3]] - (levelStart + i);
+                }
+                if(childPointer > 0x7FFFFFFF) {
+                    childPointerTooLarge = true;
+                }
+                dag.geometryData.emplace_back(node[0]);
+                dag.geometryData.emplace_back(node[1]);
+                dag.geometryData.emplace_back(uint32_t(childPointer << 1) | node[2]);
+            }
+
+            levelStart = nextLevelStart;
+            currentLevel = std::move(nextLevel);
+        }
+
+        if(childPointerTooLarge) {
+            core::error("createTree64DAG: Child pointer too large (exceeds 31 bits)! DAG may be corrupted");
+        }
+
+        dag.uniqueNodeCount = builder.uniqueNodes.size();
+        dag.dagNodeCount = dag.geometryData.size() / 3;
+        dag.compressionRatio = float(dag.treeNodeCount) / float(dag.dagNodeCount);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("createTree64DAG: Reduced {} tree64 nodes to {} DAG nodes ({} unique subtrees, {:.2f}x compression) in {:.2f}ms", dag.treeNodeCount, dag.dagNodeCount, dag.uniqueNodeCount, dag.compressionRatio, elapsed);
+        return dag;
+    }
+}
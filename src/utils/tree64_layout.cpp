@@ -0,0 +1,213 @@
+#include "utils/tree64_layout.h"
+
+namespace projv::utils {
+    // Nodes with a block of child nodes. Parents of leaves keep their leaf bits in the node itself.
+    bool hasTree64ChildBlock(const uint32_t* node) {
+        return !isTree64LeafParent(node) && getTree64ValidMask(node) != 0;
+    }
+
+    // Counts the levels of child blocks below a node, all leaves of a tree64 are on the same level.
+    int countTree64BlockLevels(const std::vector<uint32_t>& tree64, size_t nodeIndex) {
+        int blockLevels = 0;
+        for(const uint32_t* node = tree64.data() + nodeIndex * 3; hasTree64ChildBlock(node); node = tree64.data() + nodeIndex * 3) {
+            nodeIndex += getTree64ChildPointer(node);
+            blockLevels++;
+        }
+        return blockLevels;
+    }
+
+    // Every child block is named by the node it belongs to. Blocks are stored in the order of blockParents.
+    void orderBlocksDepthFirst(const std::vector<uint32_t>& tree64, size_t nodeIndex, std::vector<uint32_t>& blockParents) {
+        const uint32_t* node = tree64.data() + nodeIndex * 3;
+        if(!hasTree64ChildBlock(node)) {
+            return;
+        }
+        blockParents.emplace_back(uint32_t(nodeIndex));
+        size_t firstChild = nodeIndex + getTree64ChildPointer(node);
+        for(int i = 0; i < __builtin_popcountll(getTree64ValidMask(node)); i++) {
+            orderBlocksDepthFirst(tree64, firstChild + i, blockParents);
+        }
+    }
+
+    // Appends the nodes blockLevels levels of child blocks below a node, in Z-Order.
+    void findTree64DescendantsAtBlockLevel(const std::vector<uint32_t>& tree64, size_t nodeIndex, int blockLevels, std::vector<uint32_t>& descendants) {
+        if(blockLevels == 0) {
+            descendants.emplace_back(uint32_t(nodeIndex));
+            return;
+        }
+        const uint32_t* node = tree64.data() + nodeIndex * 3;
+        if(!hasTree64ChildBlock(node)) {
+            return;
+        }
+        size_t firstChild = nodeIndex + getTree64ChildPointer(node);
+        for(int i = 0; i < __builtin_popcountll(getTree64ValidMask(node)); i++) {
+            findTree64DescendantsAtBlockLevel(tree64, firstChild + i, blockLevels - 1, descendants);
+        }
+    }
+
+    // Orders the blockLevels levels of child blocks below a node as a treelet: the top half of the levels first, then the treelet below each of their nodes.
+    void orderBlocksVanEmdeBoas(const std::vector<uint32_t>& tree64, size_t nodeIndex, int blockLevels, std::vector<uint32_t>& blockParents) {
+        if(blockLevels == 0 || !hasTree64ChildBlock(tree64.data() + nodeIndex * 3)) {
+            return;
+        }
+        if(blockLevels == 1) {
+            blockParents.emplace_back(uint32_t(nodeIndex));
+            return;
+        }
+        int topLevels = blockLevels / 2;
+        orderBlocksVanEmdeBoas(tree64, nodeIndex, topLevels, blockParents);
+        std::vector<uint32_t> treeletRoots;
+        findTree64DescendantsAtBlockLevel(tree64, nodeIndex, topLevels, treeletRoots);
+        for(uint32_t treeletRoot : treeletRoots) {
+            orderBlocksVanEmdeBoas(tree64, treeletRoot, blockLevels - topLevels, blockParents);
+        }
+    }
+
+    void orderBlocksBreadthFirst(const std::vector<uint32_t>& tree64, std::vector<uint32_t>& blockParents) {
+        std::vector<uint32_t> currentLevel = {0};
+        while(!currentLevel.empty()) {
+            std::vector<uint32_t> nextLevel;
+            for(uint32_t nodeIndex : currentLevel) {
+                const uint32_t* node = tree64.data() + size_t(nodeIndex) * 3;
+                if(!hasTree64ChildBlock(node)) {
+                    continue;
+                }
+                blockParents.emplace_back(nodeIndex);
+                uint32_t firstChild = nodeIndex + getTree64ChildPointer(node);
+                for(int i = 0; i < __builtin_popcountll(getTree64ValidMask(node)); i++) {
+                    nextLevel.emplace_back(firstChild + i);
+                }
+            }
+            currentLevel = std::move(nextLevel);
+        }
+    }
+
+    std::vector<uint32_t> reorderTree64(const std::vector<uint32_t>& tree64, Tree64NodeOrder order) {
+        if(tree64.empty()) {
+            return {};
+        }
+        size_t rootCount = countTree64Roots(tree64);
+        if(rootCount > 1) {
+            throw std::invalid_argument("reorderTree64: The tree64 has " + std::to_string(rootCount) + " roots, only trees of a power of 4 resolution (a single root) can be reordered");
+        }
+        size_t nodeCount = tree64.size() / 3;
+        std::vector<uint32_t> blockParents;
+        switch(order) {
+            case Tree64NodeOrder::BreadthFirst:
+                orderBlocksBreadthFirst(tree64, blockParents);
+                break;
+            case Tree64NodeOrder::DepthFirst:
+                orderBlocksDepthFirst(tree64, 0, blockParents);
+                break;
+            case Tree64NodeOrder::VanEmdeBoas:
+                orderBlocksVanEmdeBoas(tree64, 0, countTree64BlockLevels(tree64, 0), blockParents);
+                break;
+            default:
+                throw std::invalid_argument("reorderTree64: Unknown node order " + std::to_string(int(order)));
+        }
+
+        // The root stays first, every block goes where the order puts it. A block is always placed after the block holding its parent.
+        std::vector<uint32_t> newIndices(nodeCount, UINT32_MAX);
+        newIndices[0] = 0;
+        uint32_t nextIndex = 1;
+        for(uint32_t parent : blockParents) {
+            const uint32_t* node = tree64.data() + size_t(parent) * 3;
+            size_t firstChild = parent + getTree64ChildPointer(node);
+            int blockSize = __builtin_popcountll(getTree64ValidMask(node));
+            if(firstChild + blockSize > nodeCount) {
+                throw std::invalid_argument("reorderTree64: Node " + std::to_string(parent) + " points past the end of the tree64");
+            }
+            for(int i = 0; i < blockSize; i++) {
+                if(newIndices[firstChild + i] != UINT32_MAX) {
+                    throw std::invalid_argument("reorderTree64: Node " + std::to_string(firstChild + i) + " has more than one parent, DAGs can't be reordered");
+                }
+                newIndices[firstChild + i] = nextIndex++;
+            }
+        }
+
+        std::vector<uint32_t> reordered(size_t(nextIndex) * 3);
+        bool childPointerTooLarge = false;
+        for(size_t i = 0; i < nodeCount; i++) {
+            if(newIndices[i] == UINT32_MAX) {
+                continue; // Not reachable from the root.
+            }
+            const uint32_t* node = tree64.data() + i * 3;
+            uint32_t* newNode = reordered.data() + size_t(newIndices[i]) * 3;
+            newNode[0] = node[0];
+            newNode[1] = node[1];
+            if(hasTree64ChildBlock(node)) {
+                uint32_t childPointer = newIndices[i + getTree64ChildPointer(node)] - newIndices[i];
+                if(childPointer > 0x7FFFFFFF) {
+                    childPointerTooLarge = true;
+                }
+                newNode[2] = childPointer << 1;
+            } else {
+                newNode[2] = node[2]; // Parents of leaves keep their flag and attribute offset.
+            }
+        }
+        if(childPointerTooLarge) {
+            core::error("reorderTree64: Child pointer too large (exceeds 31 bits)! Tree64 may be corrupted");
+        }
+        return reordered;
+    }
+
+    // A set associative cache of line addresses with least recently used eviction.
+    struct SimulatedCache {
+        size_t setCount;
+        size_t associativity;
+        std::vector<uint64_t> lines; // setCount * associativity line addresses, UINT64_MAX where empty.
+        std::vector<uint64_t> lastUses;
+        uint64_t time = 0;
+    };
+
+    // Returns true on a miss.
+    bool readSimulatedCacheLine(SimulatedCache& cache, uint64_t line) {
+        size_t setStart = size_t(line % cache.setCount) * cache.associativity;
+        cache.time++;
+        size_t leastRecentlyUsed = setStart;
+        for(size_t way = setStart; way < setStart + cache.associativity; way++) {
+            if(cache.lines[way] == line) {
+                cache.lastUses[way] = cache.time;
+                return false;
+            }
+            if(cache.lastUses[way] < cache.lastUses[leastRecentlyUsed]) {
+                leastRecentlyUsed = way;
+            }
+        }
+        cache.lines[leastRecentlyUsed] = line;
+        cache.lastUses[leastRecentlyUsed] = cache.time;
+        return true;
+    }
+
+    Tree64CacheStatistics measureTree64CacheMisses(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, size_t rayCount,
+                                                   const Tree64CacheSettings& settings) {
+        if(settings.lineSize == 0 || settings.associativity == 0 || settings.cacheSize < settings.lineSize * settings.associativity) {
+            throw std::invalid_argument("measureTree64CacheMisses: A " + std::to_string(settings.cacheSize) + " byte cache can't hold " + std::to_string(settings.associativity) + " lines of " + std::to_string(settings.lineSize) + " bytes per set");
+        }
+        SimulatedCache cache;
+        cache.setCount = settings.cacheSize / (settings.lineSize * settings.associativity);
+        cache.associativity = settings.associativity;
+        cache.lines.assign(cache.setCount * cache.associativity, UINT64_MAX);
+        cache.lastUses.assign(cache.setCount * cache.associativity, 0);
+
+        Tree64CacheStatistics statistics = {};
+        statistics.rayCount = rayCount;
+        std::vector<uint32_t> visitedNodes;
+        for(size_t i = 0; i < rayCount; i++) {
+            visitedNodes.clear();
+            traceRayThroughTree64(tree64, voxelTypeData, gridResolution, rays[i], visitedNodes);
+            statistics.nodeReads += visitedNodes.size();
+            for(uint32_t nodeIndex : visitedNodes) {
+                uint64_t firstByte = uint64_t(nodeIndex) * 3 * sizeof(uint32_t);
+                uint64_t lastLine = (firstByte + 3 * sizeof(uint32_t) - 1) / settings.lineSize;
+                for(uint64_t line = firstByte / settings.lineSize; line <= lastLine; line++) {
+                    statistics.lineReads++;
+                    statistics.cacheMisses += readSimulatedCacheLine(cache, line) ? 1 : 0;
+                }
+            }
+        }
+        statistics.missesPerRay = rayCount == 0 ? 0.0f : float(statistics.cacheMisses) / float(rayCount);
+        statistics.missRate = statistics.lineReads == 0 ? 0.0f : float(statistics.cacheMisses) / float(statistics.lineReads);
+        return statistics;
+    }
+}
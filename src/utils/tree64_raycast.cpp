@@ -0,0 +1,434 @@
+#include "utils/tree64_raycast.h"
+
+// The packet kernel is compiled with a per function target attribute and picked at runtime, so no global -mavx2 is needed.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PROJV_RAY_PACKET_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define PROJV_RAY_PACKET_X86_KERNELS 0
+#endif
+
+namespace projv::utils {
+    constexpr size_t MIN_RAYS_PER_THREAD = 4096;
+    constexpr size_t RAY_PACKETS_PER_TASK = 64;
+
+    struct Tree64RayTraversal { // What every ray of a cast shares.
+        const uint32_t* tree64;
+        const std::vector<uint32_t>* voxelTypeData;
+        int levelsOfDepth;
+        int hitDepth; // Depth of the nodes a ray stops at, levelsOfDepth to go down to the voxels.
+        int treeSize; // Voxels per axis covered by the tree64.
+        uint32_t maxSteps;
+    };
+
+    Tree64RayTraversal createTree64RayTraversal(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, uint32_t maxSteps) {
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("castRayThroughTree64: Resolution " + std::to_string(gridResolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(!hasSingleTree64Root(gridResolution)) { // Only the block of the first root would be cast through, missing everything else.
+            throw std::invalid_argument("castRayThroughTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        return {tree64.data(), &voxelTypeData, levelsOfDepth, levelsOfDepth, 1 << (2 * levelsOfDepth), maxSteps};
+    }
+
+    RayHit createRayMiss(uint32_t steps) {
+        RayHit hit;
+        hit.hit = false;
+        hit.distance = -1.0f;
+        hit.voxelPosition = core::ivec3(0);
+        hit.ZOrder = 0;
+        hit.normal = core::ivec3(0);
+        hit.voxelTypeDataIndex = UINT32_MAX;
+        hit.nodeIndex = UINT32_MAX;
+        hit.steps = steps;
+        return hit;
+    }
+
+    // Clips the ray against the tree64's bounds and finds the cell it starts in. Returns false when the ray misses the tree64.
+    bool enterTree64(const Tree64RayTraversal& traversal, const Ray& ray, core::ivec3& voxelPosition, float& distance, core::ivec3& normal) {
+        if(ray.direction.x == 0.0f && ray.direction.y == 0.0f && ray.direction.z == 0.0f) {
+            return false;
+        }
+        float treeSize = float(traversal.treeSize);
+        float entryDistance = -INFINITY;
+        float exitDistance = INFINITY;
+        int entryAxis = -1;
+        for(int axis = 0; axis < 3; axis++) {
+            if(ray.direction[axis] == 0.0f) {
+                if(ray.origin[axis] < 0.0f || ray.origin[axis] >= treeSize) {
+                    return false;
+                }
+                continue;
+            }
+            float inverseDirection = 1.0f / ray.direction[axis];
+            float near = (0.0f - ray.origin[axis]) * inverseDirection;
+            float far = (treeSize - ray.origin[axis]) * inverseDirection;
+            if(near > far) {
+                std::swap(near, far);
+            }
+            if(near > entryDistance) {
+                entryDistance = near;
+                entryAxis = axis;
+            }
+            exitDistance = std::min(exitDistance, far);
+        }
+        if(entryDistance > exitDistance || exitDistance < 0.0f) {
+            return false;
+        }
+
+        distance = std::max(entryDistance, 0.0f);
+        normal = core::ivec3(0);
+        for(int axis = 0; axis < 3; axis++) {
+            float position = std::floor(ray.origin[axis] + ray.direction[axis] * distance);
+            voxelPosition[axis] = int(std::min(std::max(position, 0.0f), treeSize - 1.0f));
+        }
+        if(entryDistance > 0.0f) {
+            bool positive = ray.direction[entryAxis] > 0.0f;
+            voxelPosition[entryAxis] = positive ? 0 : traversal.treeSize - 1;
+            normal[entryAxis] = positive ? -1 : 1;
+        }
+        return true;
+    }
+
+    // Moves the ray out of the empty cell of size 1 << cellShift that voxelPosition is in. Returns false once the ray leaves the tree64.
+    // The packet kernel does the same math 8 rays at a time, so both have to be changed together.
+    bool advanceRayTree64(const Tree64RayTraversal& traversal, const Ray& ray, const core::vec3& inverseDirection, int cellShift, core::ivec3& voxelPosition, float& distance, core::ivec3& normal) {
+        int cellSize = 1 << cellShift;
+        core::ivec3 cellMin;
+        float exitDistances[3];
+        for(int axis = 0; axis < 3; axis++) {
+            cellMin[axis] = (voxelPosition[axis] >> cellShift) << cellShift;
+            float plane = float(ray.direction[axis] > 0.0f ? cellMin[axis] + cellSize : cellMin[axis]);
+            exitDistances[axis] = ray.direction[axis] == 0.0f ? INFINITY : (plane - ray.origin[axis]) * inverseDirection[axis];
+        }
+        int exitAxis = exitDistances[0] <= exitDistances[1] && exitDistances[0] <= exitDistances[2] ? 0 : (exitDistances[1] <= exitDistances[2] ? 1 : 2);
+        float exitDistance = exitDistances[exitAxis];
+
+        for(int axis = 0; axis < 3; axis++) {
+            if(axis == exitAxis) {
+                voxelPosition[axis] = ray.direction[axis] > 0.0f ? cellMin[axis] + cellSize : cellMin[axis] - 1;
+                normal[axis] = ray.direction[axis] > 0.0f ? -1 : 1;
+            } else {
+                // The ray stays inside the cell on the other axes, clamping keeps rounding from moving it sideways.
+                float position = std::floor(ray.origin[axis] + ray.direction[axis] * exitDistance);
+                voxelPosition[axis] = int(std::min(std::max(position, float(cellMin[axis])), float(cellMin[axis] + cellSize - 1)));
+                normal[axis] = 0;
+            }
+        }
+        distance = std::max(distance, exitDistance);
+        return voxelPosition[exitAxis] >= 0 && voxelPosition[exitAxis] < traversal.treeSize;
+    }
+
+    RayHit createRayHit(const Tree64RayTraversal& traversal, core::ivec3 voxelPosition, uint32_t ZOrder, float distance, core::ivec3 normal, uint32_t steps) {
+        RayHit hit;
+        hit.hit = true;
+        hit.distance = distance;
+        hit.voxelPosition = voxelPosition;
+        hit.ZOrder = ZOrder;
+        hit.normal = normal;
+        hit.nodeIndex = UINT32_MAX;
+        hit.steps = steps;
+
+        const std::vector<uint32_t>& voxelTypeData = *traversal.voxelTypeData;
+        size_t low = 0;
+        size_t high = voxelTypeData.size() / 3;
+        while(low < high) {
+            size_t middle = low + (high - low) / 2;
+            if(voxelTypeData[middle * 3] < ZOrder) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        hit.voxelTypeDataIndex = low < voxelTypeData.size() / 3 && voxelTypeData[low * 3] == ZOrder ? uint32_t(low) : UINT32_MAX;
+        return hit;
+    }
+
+    RayHit createRayNodeHit(uint32_t nodeIndex, core::ivec3 voxelPosition, uint32_t ZOrder, float distance, core::ivec3 normal, uint32_t steps) {
+        RayHit hit = createRayMiss(steps);
+        hit.hit = true;
+        hit.distance = distance;
+        hit.voxelPosition = voxelPosition;
+        hit.ZOrder = ZOrder;
+        hit.normal = normal;
+        hit.nodeIndex = nodeIndex;
+        return hit;
+    }
+
+    // visitNode is called with every node the ray reads, see traceRayThroughTree64.
+    template <typename NodeVisitor>
+    RayHit castRayTree64(const Tree64RayTraversal& traversal, const Ray& ray, NodeVisitor&& visitNode) {
+        core::ivec3 voxelPosition;
+        core::ivec3 normal;
+        float distance;
+        if(!enterTree64(traversal, ray, voxelPosition, distance, normal)) {
+            return createRayMiss(0);
+        }
+        core::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+        Tree64Path path;
+        path.nodes[0] = 0;
+        path.depth = 0;
+        path.ZOrder = 0;
+        for(uint32_t steps = 0; steps < traversal.maxSteps; steps++) {
+            uint32_t ZOrder = uint32_t(createZOrderIndex(voxelPosition));
+            int depth = descendTree64Path(traversal.tree64, traversal.levelsOfDepth, path, ZOrder, visitNode);
+            if(depth >= traversal.hitDepth) {
+                if(traversal.hitDepth == traversal.levelsOfDepth) {
+                    return createRayHit(traversal, voxelPosition, ZOrder, distance, normal, steps);
+                }
+                return createRayNodeHit(path.nodes[traversal.hitDepth], voxelPosition, ZOrder, distance, normal, steps); // The node exists, so a voxel below it is set.
+            }
+            if(!advanceRayTree64(traversal, ray, inverseDirection, 2 * (traversal.levelsOfDepth - 1 - depth), voxelPosition, distance, normal)) {
+                return createRayMiss(steps + 1);
+            }
+        }
+        return createRayMiss(traversal.maxSteps);
+    }
+
+    RayHit castRayTree64(const Tree64RayTraversal& traversal, const Ray& ray) {
+        return castRayTree64(traversal, ray, [](uint32_t) {});
+    }
+
+    RayHit castRayThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, uint32_t maxSteps) {
+        if(tree64.empty()) {
+            return createRayMiss(0);
+        }
+        return castRayTree64(createTree64RayTraversal(tree64, voxelTypeData, gridResolution, maxSteps), ray);
+    }
+
+    RayHit castRayThroughTree64AtLOD(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, uint32_t LOD, uint32_t maxSteps) {
+        if(tree64.empty()) {
+            return createRayMiss(0);
+        }
+        Tree64RayTraversal traversal = createTree64RayTraversal(tree64, voxelTypeData, gridResolution, maxSteps);
+        traversal.hitDepth = traversal.levelsOfDepth - int(std::min<uint32_t>(LOD, uint32_t(traversal.levelsOfDepth - 1)));
+        return castRayTree64(traversal, ray);
+    }
+
+    RayHit traceRayThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray& ray, std::vector<uint32_t>& visitedNodes, uint32_t maxSteps) {
+        if(tree64.empty()) {
+            return createRayMiss(0);
+        }
+        return castRayTree64(createTree64RayTraversal(tree64, voxelTypeData, gridResolution, maxSteps), ray, [&](uint32_t nodeIndex) {
+            visitedNodes.push_back(nodeIndex);
+        });
+    }
+
+    void castRayPacketTree64Scalar(const Tree64RayTraversal& traversal, const Ray* rays, RayHit* hits) {
+        for(size_t i = 0; i < RAY_PACKET_SIZE; i++) {
+            hits[i] = castRayTree64(traversal, rays[i]);
+        }
+    }
+
+#if PROJV_RAY_PACKET_X86_KERNELS
+    // Each ray still walks its own path through the nodes, one lane at a time. The stepping to the next cell, which is the same math for every ray, runs on all 8 lanes at once.
+    __attribute__((target("avx2")))
+    void castRayPacketTree64AVX2(const Tree64RayTraversal& traversal, const Ray* rays, RayHit* hits) {
+        alignas(32) float origins[3][RAY_PACKET_SIZE];
+        alignas(32) float directions[3][RAY_PACKET_SIZE];
+        alignas(32) float inverseDirections[3][RAY_PACKET_SIZE];
+        alignas(32) int voxelPositions[3][RAY_PACKET_SIZE];
+        alignas(32) int normals[3][RAY_PACKET_SIZE];
+        alignas(32) float distances[RAY_PACKET_SIZE];
+        alignas(32) int cellShifts[RAY_PACKET_SIZE];
+        alignas(32) int insideTree[RAY_PACKET_SIZE];
+        std::array<Tree64Path, RAY_PACKET_SIZE> paths;
+        uint32_t activeLanes = 0;
+
+        for(size_t lane = 0; lane < RAY_PACKET_SIZE; lane++) {
+            core::ivec3 voxelPosition(0);
+            core::ivec3 normal(0);
+            float distance = 0.0f;
+            if(enterTree64(traversal, rays[lane], voxelPosition, distance, normal)) {
+                activeLanes |= 1u << lane;
+            } else {
+                hits[lane] = createRayMiss(0);
+            }
+            for(int axis = 0; axis < 3; axis++) {
+                origins[axis][lane] = rays[lane].origin[axis];
+                directions[axis][lane] = rays[lane].direction[axis];
+                inverseDirections[axis][lane] = 1.0f / rays[lane].direction[axis];
+                voxelPositions[axis][lane] = voxelPosition[axis];
+                normals[axis][lane] = normal[axis];
+            }
+            distances[lane] = distance;
+            cellShifts[lane] = 0;
+            paths[lane].nodes[0] = 0;
+            paths[lane].depth = 0;
+            paths[lane].ZOrder = 0;
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 infinity = _mm256_set1_ps(INFINITY);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i treeSize = _mm256_set1_epi32(traversal.treeSize);
+        for(uint32_t steps = 0; activeLanes != 0; steps++) {
+            for(uint32_t lanes = activeLanes; lanes != 0; lanes &= lanes - 1) {
+                int lane = __builtin_ctz(lanes);
+                core::ivec3 voxelPosition(voxelPositions[0][lane], voxelPositions[1][lane], voxelPositions[2][lane]);
+                if(steps == traversal.maxSteps) {
+                    hits[lane] = createRayMiss(traversal.maxSteps);
+                    activeLanes &= ~(1u << lane);
+                    continue;
+                }
+                uint32_t ZOrder = uint32_t(createZOrderIndex(voxelPosition));
+                int depth = descendTree64Path(traversal.tree64, traversal.levelsOfDepth, paths[lane], ZOrder);
+                if(depth == traversal.levelsOfDepth) {
+                    core::ivec3 normal(normals[0][lane], normals[1][lane], normals[2][lane]);
+                    hits[lane] = createRayHit(traversal, voxelPosition, ZOrder, distances[lane], normal, steps);
+                    activeLanes &= ~(1u << lane);
+                    continue;
+                }
+                cellShifts[lane] = 2 * (traversal.levelsOfDepth - 1 - depth);
+            }
+            if(activeLanes == 0) {
+                break;
+            }
+
+            // Same as advanceRayTree64. Finished lanes are stepped too, their results are never read.
+            __m256i cellShift = _mm256_load_si256((const __m256i*)cellShifts);
+            __m256i cellSize = _mm256_sllv_epi32(one, cellShift);
+            __m256i cellMins[3];
+            __m256 exitDistances[3];
+            __m256 positiveDirections[3];
+            for(int axis = 0; axis < 3; axis++) {
+                __m256i voxelPosition = _mm256_load_si256((const __m256i*)voxelPositions[axis]);
+                __m256 direction = _mm256_load_ps(directions[axis]);
+                cellMins[axis] = _mm256_sllv_epi32(_mm256_srav_epi32(voxelPosition, cellShift), cellShift);
+                positiveDirections[axis] = _mm256_cmp_ps(direction, zero, _CMP_GT_OQ);
+                __m256 plane = _mm256_cvtepi32_ps(_mm256_blendv_epi8(cellMins[axis], _mm256_add_epi32(cellMins[axis], cellSize), _mm256_castps_si256(positiveDirections[axis])));
+                __m256 exitDistance = _mm256_mul_ps(_mm256_sub_ps(plane, _mm256_load_ps(origins[axis])), _mm256_load_ps(inverseDirections[axis]));
+                exitDistances[axis] = _mm256_blendv_ps(exitDistance, infinity, _mm256_cmp_ps(direction, zero, _CMP_EQ_OQ));
+            }
+            __m256 exitX = _mm256_and_ps(_mm256_cmp_ps(exitDistances[0], exitDistances[1], _CMP_LE_OQ), _mm256_cmp_ps(exitDistances[0], exitDistances[2], _CMP_LE_OQ));
+            __m256 exitY = _mm256_andnot_ps(exitX, _mm256_cmp_ps(exitDistances[1], exitDistances[2], _CMP_LE_OQ));
+            __m256 exitZ = _mm256_andnot_ps(_mm256_or_ps(exitX, exitY), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+            __m256 exitAxes[3] = {exitX, exitY, exitZ};
+            __m256 exitDistance = _mm256_blendv_ps(_mm256_blendv_ps(exitDistances[2], exitDistances[1], exitY), exitDistances[0], exitX);
+
+            __m256i steppedInside = _mm256_setzero_si256();
+            for(int axis = 0; axis < 3; axis++) {
+                __m256 position = _mm256_floor_ps(_mm256_add_ps(_mm256_load_ps(origins[axis]), _mm256_mul_ps(_mm256_load_ps(directions[axis]), exitDistance)));
+                __m256i cellMax = _mm256_sub_epi32(_mm256_add_epi32(cellMins[axis], cellSize), one);
+                position = _mm256_min_ps(_mm256_max_ps(position, _mm256_cvtepi32_ps(cellMins[axis])), _mm256_cvtepi32_ps(cellMax));
+                __m256i positive = _mm256_castps_si256(positiveDirections[axis]);
+                __m256i stepped = _mm256_blendv_epi8(_mm256_sub_epi32(cellMins[axis], one), _mm256_add_epi32(cellMax, one), positive);
+                __m256i exitAxis = _mm256_castps_si256(exitAxes[axis]);
+                __m256i voxelPosition = _mm256_blendv_epi8(_mm256_cvttps_epi32(position), stepped, exitAxis);
+                _mm256_store_si256((__m256i*)voxelPositions[axis], voxelPosition);
+                __m256i normal = _mm256_and_si256(exitAxis, _mm256_blendv_epi8(one, _mm256_set1_epi32(-1), positive));
+                _mm256_store_si256((__m256i*)normals[axis], normal);
+                __m256i inside = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), stepped), _mm256_cmpgt_epi32(treeSize, stepped));
+                steppedInside = _mm256_or_si256(steppedInside, _mm256_and_si256(exitAxis, inside));
+            }
+            _mm256_store_ps(distances, _mm256_max_ps(_mm256_load_ps(distances), exitDistance));
+            _mm256_store_si256((__m256i*)insideTree, steppedInside);
+
+            for(uint32_t lanes = activeLanes; lanes != 0; lanes &= lanes - 1) {
+                int lane = __builtin_ctz(lanes);
+                if(insideTree[lane] == 0) {
+                    hits[lane] = createRayMiss(steps + 1);
+                    activeLanes &= ~(1u << lane);
+                }
+            }
+        }
+    }
+#endif
+
+    using CastRayPacketKernel = void (*)(const Tree64RayTraversal&, const Ray*, RayHit*);
+
+    struct RayPacketKernel {
+        CastRayPacketKernel cast;
+        const char* name;
+    };
+
+    RayPacketKernel selectRayPacketKernel() {
+#if PROJV_RAY_PACKET_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return {castRayPacketTree64AVX2, "AVX2"};
+        }
+#endif
+        return {castRayPacketTree64Scalar, "scalar"};
+    }
+
+    // Selected once when the library loads.
+    const RayPacketKernel RAY_PACKET_KERNEL = selectRayPacketKernel();
+
+    void castRayPacketThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, RayHit* hits, uint32_t maxSteps) {
+        if(tree64.empty()) {
+            for(size_t i = 0; i < RAY_PACKET_SIZE; i++) {
+                hits[i] = createRayMiss(0);
+            }
+            return;
+        }
+        RAY_PACKET_KERNEL.cast(createTree64RayTraversal(tree64, voxelTypeData, gridResolution, maxSteps), rays, hits);
+    }
+
+    void castRaysThroughTree64(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int gridResolution, const Ray* rays, RayHit* hits, size_t rayCount, uint32_t maxSteps, int threadCount) {
+        auto start = std::chrono::high_resolution_clock::now();
+        if(tree64.empty()) {
+            for(size_t i = 0; i < rayCount; i++) {
+                hits[i] = createRayMiss(0);
+            }
+            return;
+        }
+        Tree64RayTraversal traversal = createTree64RayTraversal(tree64, voxelTypeData, gridResolution, maxSteps);
+
+        // Workers take small runs of packets from a shared counter, so rays that take longer don't leave other threads idle.
+        size_t packetCount = rayCount / RAY_PACKET_SIZE;
+        std::atomic<size_t> nextPacket(0);
+        auto castPackets = [&]() {
+            while(true) {
+                size_t firstPacket = nextPacket.fetch_add(RAY_PACKETS_PER_TASK);
+                if(firstPacket >= packetCount) {
+                    break;
+                }
+                size_t lastPacket = std::min(packetCount, firstPacket + RAY_PACKETS_PER_TASK);
+                for(size_t packet = firstPacket; packet < lastPacket; packet++) {
+                    RAY_PACKET_KERNEL.cast(traversal, rays + packet * RAY_PACKET_SIZE, hits + packet * RAY_PACKET_SIZE);
+                }
+            }
+        };
+
+        unsigned int workerCount = threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::max<size_t>(1, std::min<size_t>(workerCount, rayCount / MIN_RAYS_PER_THREAD));
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < workerCount; i++) {
+            workers.emplace_back(castPackets);
+        }
+        castPackets(); // The calling thread works too.
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+        for(size_t i = packetCount * RAY_PACKET_SIZE; i < rayCount; i++) {
+            hits[i] = castRayTree64(traversal, rays[i]);
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("castRaysThroughTree64: Cast {} rays with {} threads ({} kernel) in {:.2f}ms ({:.2f} million rays per second)", rayCount, workerCount, RAY_PACKET_KERNEL.name, elapsed, elapsed > 0.0 ? rayCount / elapsed / 1000.0 : 0.0);
+    }
+
+    RayHit castRayThroughChunk(const Chunk& chunk, const Ray& ray, uint32_t maxSteps) {
+        if(!hasSingleTree64Root(int(chunk.header.resolution))) {
+            throw std::invalid_argument("castRayThroughChunk: Chunk " + std::to_string(chunk.header.chunkID) + " has resolution " + std::to_string(chunk.header.resolution) + ", rays can only be cast through power of 4 resolutions");
+        }
+        // Same transform as castRayThroughTree64 in the shaders, every voxel of the chunk gets a size of 1.
+        float resolution = float(chunk.header.resolution);
+        Ray chunkRay;
+        chunkRay.origin = (ray.origin - chunk.header.position) * resolution / chunk.header.scale;
+        chunkRay.direction = ray.direction;
+        RayHit hit = castRayThroughTree64(chunk.geometryData, chunk.voxelTypeData, chunk.header.resolution, chunkRay, maxSteps);
+        if(hit.hit) {
+            hit.distance *= chunk.header.scale / resolution;
+        }
+        return hit;
+    }
+
+    const char* getRayPacketKernelName() {
+        return RAY_PACKET_KERNEL.name;
+    }
+}
@@ -0,0 +1,558 @@
+#include "utils/voxel_collision.h"
+
+namespace projv::utils {
+    constexpr float CAPSULE_CONTACT_DISTANCE = 1e-3f; // How close to a voxel, in voxels, a capsule stops.
+    constexpr int MAX_CAPSULE_NEWTON_STEPS = 32;
+    constexpr float PARALLEL_AXIS_EPSILON = 1e-6f; // Edge cross products shorter than this are treated as parallel.
+
+    struct SweptBoundsEntry {
+        bool hit;
+        float time; // Clamped to 0 when the bounds start inside the box.
+        int axis; // Axis of the face the bounds enter through, -1 when they start inside.
+        bool startsInside;
+    };
+
+    // When a moving box [boundsMin, boundsMin + boundsSize] starts overlapping a box. The corner is a point moving through the box grown by boundsSize,
+    // and the slabs are open so bounds touching the box (or sliding along it) don't count.
+    SweptBoundsEntry sweepBoundsAgainstBox(core::vec3 boundsMin, core::vec3 boundsSize, core::vec3 displacement, core::vec3 boxMin, core::vec3 boxMax) {
+        SweptBoundsEntry entry = {false, 0.0f, -1, false};
+        float entryTime = -INFINITY;
+        float exitTime = INFINITY;
+        for(int axis = 0; axis < 3; axis++) {
+            float low = boxMin[axis] - boundsSize[axis];
+            float high = boxMax[axis];
+            if(displacement[axis] == 0.0f) {
+                if(!(boundsMin[axis] > low && boundsMin[axis] < high)) {
+                    return entry;
+                }
+                continue;
+            }
+            float t0 = (low - boundsMin[axis]) / displacement[axis];
+            float t1 = (high - boundsMin[axis]) / displacement[axis];
+            if(t0 > t1) {
+                std::swap(t0, t1);
+            }
+            if(t0 > entryTime) {
+                entryTime = t0;
+                entry.axis = axis;
+            }
+            exitTime = std::min(exitTime, t1);
+        }
+        if(entryTime >= exitTime || exitTime <= 0.0f || entryTime > 1.0f) {
+            return entry;
+        }
+        entry.hit = true;
+        entry.startsInside = entryTime < 0.0f;
+        entry.time = std::max(entryTime, 0.0f);
+        if(entry.startsInside) {
+            entry.axis = -1;
+        }
+        return entry;
+    }
+
+    // Closest points between a segment and a box. The squared distance is a convex quadratic in the segment parameter between the points where
+    // the segment crosses a face plane, so each piece is minimized exactly. Returns the distance.
+    float getSegmentBoxDistance(core::vec3 pointA, core::vec3 pointB, core::vec3 boxMin, core::vec3 boxMax, core::vec3& closestOnSegment, core::vec3& closestOnBox) {
+        core::vec3 direction = pointB - pointA;
+        std::array<float, 8> breakpoints;
+        int breakpointCount = 0;
+        breakpoints[breakpointCount++] = 0.0f;
+        breakpoints[breakpointCount++] = 1.0f;
+        for(int axis = 0; axis < 3; axis++) {
+            if(direction[axis] == 0.0f) {
+                continue;
+            }
+            float crossings[2] = {(boxMin[axis] - pointA[axis]) / direction[axis], (boxMax[axis] - pointA[axis]) / direction[axis]};
+            for(float crossing : crossings) {
+                if(crossing > 0.0f && crossing < 1.0f) {
+                    breakpoints[breakpointCount++] = crossing;
+                }
+            }
+        }
+        // At most 8 entries, an insertion sort of the used ones.
+        for(int i = 1; i < breakpointCount; i++) {
+            float breakpoint = breakpoints[i];
+            int j = i;
+            for(; j > 0 && breakpoints[j - 1] > breakpoint; j--) {
+                breakpoints[j] = breakpoints[j - 1];
+            }
+            breakpoints[j] = breakpoint;
+        }
+
+        float closestDistanceSquared = INFINITY;
+        for(int i = 0; i + 1 < breakpointCount; i++) {
+            float start = breakpoints[i];
+            float end = breakpoints[i + 1];
+            core::vec3 middle = pointA + direction * ((start + end) * 0.5f);
+            // Every axis is either inside its slab or past one face for the whole piece, which makes it (a + d * s - face)^2 or 0.
+            float numerator = 0.0f;
+            float denominator = 0.0f;
+            for(int axis = 0; axis < 3; axis++) {
+                float face;
+                if(middle[axis] < boxMin[axis]) {
+                    face = boxMin[axis];
+                } else if(middle[axis] > boxMax[axis]) {
+                    face = boxMax[axis];
+                } else {
+                    continue;
+                }
+                numerator -= direction[axis] * (pointA[axis] - face);
+                denominator += direction[axis] * direction[axis];
+            }
+            float s = denominator > 0.0f ? std::clamp(numerator / denominator, start, end) : start;
+            core::vec3 point = pointA + direction * s;
+            core::vec3 clamped = core::clamp(point, boxMin, boxMax);
+            core::vec3 offset = point - clamped;
+            float distanceSquared = core::dot(offset, offset);
+            if(distanceSquared < closestDistanceSquared) {
+                closestDistanceSquared = distanceSquared;
+                closestOnSegment = point;
+                closestOnBox = clamped;
+            }
+        }
+        return sqrtf(closestDistanceSquared);
+    }
+
+    // The axis the box is the least deep into, pointing the way out. point is inside [boxMin, boxMax].
+    core::vec3 getShallowestExitNormal(core::vec3 point, core::vec3 boxMin, core::vec3 boxMax) {
+        core::vec3 normal(0.0f);
+        float shallowestDepth = INFINITY;
+        for(int axis = 0; axis < 3; axis++) {
+            float lowDepth = point[axis] - boxMin[axis];
+            float highDepth = boxMax[axis] - point[axis];
+            if(std::min(lowDepth, highDepth) < shallowestDepth) {
+                shallowestDepth = std::min(lowDepth, highDepth);
+                normal = core::vec3(0.0f);
+                normal[axis] = lowDepth < highDepth ? -1.0f : 1.0f;
+            }
+        }
+        return normal;
+    }
+
+    struct SweepShape { // A box, or a capsule with its bounding box, in a tree64's grid space.
+        bool capsule;
+        core::vec3 boundsMin;
+        core::vec3 boundsSize;
+        core::vec3 pointA; // Capsule segment and radius.
+        core::vec3 pointB;
+        float radius;
+        core::vec3 displacement;
+    };
+
+    struct Tree64Sweep { // What every node of a sweep shares.
+        const uint32_t* tree64;
+        const SweepShape* shape;
+        SweepHit* hit;
+    };
+
+    // Narrow phase of a box. The swept bounds test is already exact.
+    void sweepBoxAgainstVoxel(const Tree64Sweep& sweep, const SweptBoundsEntry& entry, core::ivec3 voxelPosition, uint32_t ZOrder) {
+        const SweepShape& shape = *sweep.shape;
+        SweepHit& hit = *sweep.hit;
+        hit.hit = true;
+        hit.time = entry.time;
+        hit.startsInside = entry.startsInside;
+        hit.voxelPosition = voxelPosition;
+        hit.ZOrder = ZOrder;
+        hit.normal = core::vec3(0.0f);
+        if(entry.startsInside) {
+            // The box's min corner is inside the voxel grown by the box's size, which leaves it through the closest face.
+            hit.normal = getShallowestExitNormal(shape.boundsMin, core::vec3(voxelPosition) - shape.boundsSize, core::vec3(voxelPosition) + core::vec3(1.0f));
+        } else {
+            hit.normal[entry.axis] = shape.displacement[entry.axis] > 0.0f ? -1.0f : 1.0f;
+        }
+    }
+
+    // Narrow phase of a capsule, starting from when its bounding box reaches the voxel. The distance between two convex shapes is convex in how far
+    // one of them moved, so Newton steps along it (the derivative is the closest point direction dotted with the displacement) never pass the first contact,
+    // and a distance that stops shrinking never reaches it.
+    void sweepCapsuleAgainstVoxel(const Tree64Sweep& sweep, const SweptBoundsEntry& entry, core::ivec3 voxelPosition, uint32_t ZOrder) {
+        const SweepShape& shape = *sweep.shape;
+        SweepHit& hit = *sweep.hit;
+        core::vec3 voxelMin(voxelPosition);
+        core::vec3 voxelMax = voxelMin + core::vec3(1.0f);
+        float time = entry.time;
+        for(int step = 0; step < MAX_CAPSULE_NEWTON_STEPS; step++) {
+            core::vec3 offset = shape.displacement * time;
+            core::vec3 closestOnSegment, closestOnBox;
+            float distance = getSegmentBoxDistance(shape.pointA + offset, shape.pointB + offset, voxelMin, voxelMax, closestOnSegment, closestOnBox);
+            float gap = distance - shape.radius;
+            if(gap <= CAPSULE_CONTACT_DISTANCE) {
+                core::vec3 normal = distance > 0.0f ? (closestOnSegment - closestOnBox) / distance : getShallowestExitNormal(closestOnSegment, voxelMin, voxelMax);
+                bool startsInside = time == 0.0f && gap < 0.0f;
+                if(time == 0.0f && !startsInside && core::dot(normal, shape.displacement) >= 0.0f) {
+                    return; // Touching but moving away or along the voxel.
+                }
+                hit.hit = true;
+                hit.time = time;
+                hit.startsInside = startsInside;
+                hit.normal = normal;
+                hit.voxelPosition = voxelPosition;
+                hit.ZOrder = ZOrder;
+                return;
+            }
+            float approachSpeed = -core::dot((closestOnSegment - closestOnBox) / distance, shape.displacement);
+            if(approachSpeed <= 0.0f) {
+                return;
+            }
+            time += gap / approachSpeed;
+            if(time > 1.0f || time >= hit.time) {
+                return;
+            }
+        }
+    }
+
+    // Visits the children of a node closest first, skipping the ones the swept bounds reach after the closest hit so far. cellLevel is the level of the node's own cell.
+    void sweepCellTree64(const Tree64Sweep& sweep, uint32_t nodeIndex, int cellLevel, uint32_t ZOrderPrefix, core::ivec3 cellMin) {
+        const SweepShape& shape = *sweep.shape;
+        const uint32_t* node = sweep.tree64 + size_t(nodeIndex) * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        uint32_t firstChild = nodeIndex + getTree64ChildPointer(node);
+        int childLevel = cellLevel - 1;
+        int childSize = 1 << (2 * childLevel);
+
+        struct ChildEntry {
+            SweptBoundsEntry entry;
+            uint32_t zOrderInParent;
+            uint32_t rank;
+        };
+        std::array<ChildEntry, 64> children;
+        int childCount = 0;
+        uint32_t childRank = 0;
+        for(uint64_t remaining = validMask; remaining != 0; childRank++) {
+            uint32_t zOrderInParent = uint32_t(__builtin_clzll(remaining));
+            remaining &= ~(1ull << (63 - zOrderInParent));
+            core::vec3 childMin(cellMin + getTree64ChildOffset(zOrderInParent) * childSize);
+            SweptBoundsEntry entry = sweepBoundsAgainstBox(shape.boundsMin, shape.boundsSize, shape.displacement, childMin, childMin + core::vec3(float(childSize)));
+            if(entry.hit && entry.time < sweep.hit->time) {
+                children[childCount++] = {entry, zOrderInParent, childRank};
+            }
+        }
+        std::sort(children.begin(), children.begin() + childCount, [](const ChildEntry& a, const ChildEntry& b) {
+            return a.entry.time < b.entry.time;
+        });
+
+        for(int i = 0; i < childCount; i++) {
+            const ChildEntry& child = children[i];
+            if(child.entry.time >= sweep.hit->time) {
+                break; // Sorted, so no later child can be closer either.
+            }
+            uint32_t childPrefix = (ZOrderPrefix << 6) | child.zOrderInParent;
+            core::ivec3 childMin = cellMin + getTree64ChildOffset(child.zOrderInParent) * childSize;
+            if(childLevel > 0) {
+                sweepCellTree64(sweep, firstChild + child.rank, childLevel, childPrefix, childMin);
+            } else if(shape.capsule) {
+                sweepCapsuleAgainstVoxel(sweep, child.entry, childMin, childPrefix);
+            } else {
+                sweepBoxAgainstVoxel(sweep, child.entry, childMin, childPrefix);
+            }
+        }
+    }
+
+    SweepHit createSweepMiss() {
+        SweepHit hit;
+        hit.hit = false;
+        hit.time = 1.0f;
+        hit.normal = core::vec3(0.0f);
+        hit.startsInside = false;
+        hit.chunkIndex = 0;
+        hit.voxelPosition = core::ivec3(0);
+        hit.ZOrder = 0;
+        return hit;
+    }
+
+    // Runs a sweep through one tree64, only accepting hits earlier than maxTime.
+    SweepHit sweepShapeThroughTree64(const char* functionName, const std::vector<uint32_t>& tree64, int gridResolution, const SweepShape& shape, float maxTime) {
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument(std::string(functionName) + ": Resolution " + std::to_string(gridResolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        SweepHit hit = createSweepMiss();
+        hit.time = maxTime;
+        if(tree64.empty() || getTree64ValidMask(tree64.data()) == 0) {
+            return hit;
+        }
+        float treeSize = float(1 << (2 * levelsOfDepth));
+        SweptBoundsEntry rootEntry = sweepBoundsAgainstBox(shape.boundsMin, shape.boundsSize, shape.displacement, core::vec3(0.0f), core::vec3(treeSize));
+        if(!rootEntry.hit || rootEntry.time >= maxTime) {
+            return hit;
+        }
+        Tree64Sweep sweep = {tree64.data(), &shape, &hit};
+        sweepCellTree64(sweep, 0, levelsOfDepth, 0, core::ivec3(0));
+        return hit;
+    }
+
+    SweepShape createBoxSweepShape(core::vec3 boxMin, core::vec3 boxMax, core::vec3 displacement) {
+        SweepShape shape;
+        shape.capsule = false;
+        shape.boundsMin = boxMin;
+        shape.boundsSize = boxMax - boxMin;
+        shape.pointA = core::vec3(0.0f);
+        shape.pointB = core::vec3(0.0f);
+        shape.radius = 0.0f;
+        shape.displacement = displacement;
+        return shape;
+    }
+
+    SweepShape createCapsuleSweepShape(core::vec3 pointA, core::vec3 pointB, float radius, core::vec3 displacement) {
+        SweepShape shape;
+        shape.capsule = true;
+        shape.boundsMin = core::min(pointA, pointB) - core::vec3(radius);
+        shape.boundsSize = core::max(pointA, pointB) + core::vec3(radius) - shape.boundsMin;
+        shape.pointA = pointA;
+        shape.pointB = pointB;
+        shape.radius = radius;
+        shape.displacement = displacement;
+        return shape;
+    }
+
+    SweepHit sweepAABBThroughTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::vec3 boxMin, core::vec3 boxMax, core::vec3 displacement) {
+        return sweepShapeThroughTree64("sweepAABBThroughTree64", tree64, gridResolution, createBoxSweepShape(boxMin, boxMax, displacement), 1.0f);
+    }
+
+    SweepHit sweepCapsuleThroughTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::vec3 pointA, core::vec3 pointB, float radius, core::vec3 displacement) {
+        if(radius < 0.0f) {
+            throw std::invalid_argument("sweepCapsuleThroughTree64: Radius " + std::to_string(radius) + " is negative");
+        }
+        return sweepShapeThroughTree64("sweepCapsuleThroughTree64", tree64, gridResolution, createCapsuleSweepShape(pointA, pointB, radius, displacement), 1.0f);
+    }
+
+    // Broad phase over the chunk bounds, then every chunk the swept bounds reach, closest first. A chunk's grid is its world space scaled uniformly,
+    // so the time of impact and the normal carry over unchanged.
+    SweepHit sweepShapeThroughScene(const char* functionName, const Scene& scene, const SceneBVH& sceneBVH, const SweepShape& worldShape) {
+        core::vec3 sweptMin = core::min(worldShape.boundsMin, worldShape.boundsMin + worldShape.displacement);
+        core::vec3 sweptMax = core::max(worldShape.boundsMin, worldShape.boundsMin + worldShape.displacement) + worldShape.boundsSize;
+        std::vector<std::pair<float, uint32_t>> chunkEntries;
+        for(uint32_t chunkIndex : findChunksInSceneBVH(sceneBVH, createBoxVoxelRegion(sweptMin, sweptMax))) {
+            const ChunkHeader& header = scene.chunks[chunkIndex].header;
+            SweptBoundsEntry entry = sweepBoundsAgainstBox(worldShape.boundsMin, worldShape.boundsSize, worldShape.displacement, header.position, header.position + core::vec3(header.scale));
+            if(entry.hit) {
+                chunkEntries.push_back({entry.time, chunkIndex});
+            }
+        }
+        std::sort(chunkEntries.begin(), chunkEntries.end());
+
+        SweepHit closestHit = createSweepMiss();
+        for(const std::pair<float, uint32_t>& chunkEntry : chunkEntries) {
+            if(chunkEntry.first >= closestHit.time) {
+                break;
+            }
+            const Chunk& chunk = scene.chunks[chunkEntry.second];
+            float gridScale = float(chunk.header.resolution) / chunk.header.scale;
+            SweepShape gridShape = worldShape;
+            gridShape.boundsMin = (worldShape.boundsMin - chunk.header.position) * gridScale;
+            gridShape.boundsSize = worldShape.boundsSize * gridScale;
+            gridShape.pointA = (worldShape.pointA - chunk.header.position) * gridScale;
+            gridShape.pointB = (worldShape.pointB - chunk.header.position) * gridScale;
+            gridShape.radius = worldShape.radius * gridScale;
+            gridShape.displacement = worldShape.displacement * gridScale;
+            SweepHit hit = sweepShapeThroughTree64(functionName, chunk.geometryData, int(chunk.header.resolution), gridShape, closestHit.time);
+            if(hit.hit) {
+                closestHit = hit;
+                closestHit.chunkIndex = chunkEntry.second;
+            }
+        }
+        return closestHit;
+    }
+
+    SweepHit sweepAABBThroughScene(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 boxMin, core::vec3 boxMax, core::vec3 displacement) {
+        return sweepShapeThroughScene("sweepAABBThroughScene", scene, sceneBVH, createBoxSweepShape(boxMin, boxMax, displacement));
+    }
+
+    SweepHit sweepCapsuleThroughScene(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 pointA, core::vec3 pointB, float radius, core::vec3 displacement) {
+        if(radius < 0.0f) {
+            throw std::invalid_argument("sweepCapsuleThroughScene: Radius " + std::to_string(radius) + " is negative");
+        }
+        return sweepShapeThroughScene("sweepCapsuleThroughScene", scene, sceneBVH, createCapsuleSweepShape(pointA, pointB, radius, displacement));
+    }
+
+    struct Tree64Cell {
+        uint32_t nodeIndex; // Only meaningful above level 0.
+        int level;
+        uint32_t ZOrder;
+        core::ivec3 cellMin;
+    };
+
+    struct SeparatingAxis {
+        core::vec3 direction;
+        float extentA; // Half the length of the projection of a cube of size 2 of the first tree64 onto the axis.
+        float extentB; // The same for a cube of the second tree64.
+    };
+
+    struct Tree64Overlap { // What every pair of cells of an overlap search shares. Everything is in the first tree64's grid space.
+        const uint32_t* tree64A;
+        const uint32_t* tree64B;
+        core::mat3 rotationB; // Columns are the second tree64's axes.
+        core::vec3 originB; // Where the second tree64's grid starts.
+        float scaleB; // Size of a voxel of the second tree64.
+        std::array<SeparatingAxis, 15> axes; // The same for every pair of cells, see createSeparatingAxes.
+        int axisCount;
+        const VoxelObjectTransform* transformA;
+        const VoxelObjectTransform* transformB;
+        float voxelSizeA; // World space size of a voxel of the first tree64.
+        float voxelSizeB;
+        std::vector<VoxelOverlapPair>* pairs; // Null when only asking whether anything overlaps.
+        bool found;
+    };
+
+    // The 15 separating axis candidates of two boxes: both boxes' face normals and the cross products of their edges. The edge axes are built
+    // explicitly instead of through the usual rotation matrix identities, which fall apart for nearly parallel edges.
+    void createSeparatingAxes(Tree64Overlap& overlap) {
+        const core::mat3& axesB = overlap.rotationB;
+        overlap.axisCount = 0;
+        auto addAxis = [&](core::vec3 axis) {
+            float axisLength = core::length(axis);
+            if(axisLength < PARALLEL_AXIS_EPSILON) {
+                return; // Parallel edges, the face axes already cover them.
+            }
+            SeparatingAxis& separatingAxis = overlap.axes[overlap.axisCount++];
+            separatingAxis.direction = axis / axisLength;
+            separatingAxis.extentA = fabsf(separatingAxis.direction.x) + fabsf(separatingAxis.direction.y) + fabsf(separatingAxis.direction.z);
+            separatingAxis.extentB = fabsf(core::dot(axesB[0], separatingAxis.direction)) + fabsf(core::dot(axesB[1], separatingAxis.direction)) + fabsf(core::dot(axesB[2], separatingAxis.direction));
+        };
+        for(int i = 0; i < 3; i++) {
+            core::vec3 axisA(0.0f);
+            axisA[i] = 1.0f;
+            addAxis(axisA);
+            addAxis(axesB[i]);
+        }
+        for(int i = 0; i < 3; i++) {
+            core::vec3 axisA(0.0f);
+            axisA[i] = 1.0f;
+            for(int j = 0; j < 3; j++) {
+                addAxis(core::cross(axisA, axesB[j]));
+            }
+        }
+    }
+
+    // Separating axis test between an axis aligned cube and a rotated one. Touching cubes don't overlap. When they overlap, returns the shallowest
+    // axis in normal, pointing from the rotated cube to the axis aligned one, with the depth along it.
+    bool getCubePenetration(const Tree64Overlap& overlap, float halfSizeA, float halfSizeB, core::vec3 offset, float& depth, core::vec3& normal) {
+        depth = INFINITY;
+        for(int i = 0; i < overlap.axisCount; i++) {
+            const SeparatingAxis& axis = overlap.axes[i];
+            float distance = core::dot(offset, axis.direction);
+            float penetration = halfSizeA * axis.extentA + halfSizeB * axis.extentB - fabsf(distance);
+            if(penetration <= 0.0f) {
+                return false;
+            }
+            if(penetration < depth) {
+                depth = penetration;
+                normal = distance > 0.0f ? -axis.direction : axis.direction;
+            }
+        }
+        return true;
+    }
+
+    bool getCellPenetration(const Tree64Overlap& overlap, const Tree64Cell& cellA, const Tree64Cell& cellB, float& depth, core::vec3& normal) {
+        float sizeA = float(1 << (2 * cellA.level));
+        float sizeB = float(1 << (2 * cellB.level));
+        core::vec3 centerA = core::vec3(cellA.cellMin) + core::vec3(sizeA * 0.5f);
+        core::vec3 centerB = overlap.originB + overlap.rotationB * ((core::vec3(cellB.cellMin) + core::vec3(sizeB * 0.5f)) * overlap.scaleB);
+        return getCubePenetration(overlap, sizeA * 0.5f, sizeB * 0.5f * overlap.scaleB, centerB - centerA, depth, normal);
+    }
+
+    void addVoxelOverlapPair(Tree64Overlap& overlap, const Tree64Cell& voxelA, const Tree64Cell& voxelB) {
+        VoxelOverlapPair pair;
+        if(!getCellPenetration(overlap, voxelA, voxelB, pair.depth, pair.normal)) {
+            return;
+        }
+        overlap.found = true;
+        if(overlap.pairs == nullptr) {
+            return;
+        }
+        const VoxelObjectTransform& transformA = *overlap.transformA;
+        const VoxelObjectTransform& transformB = *overlap.transformB;
+        core::vec3 centerA = transformA.position + transformA.rotation * ((core::vec3(voxelA.cellMin) + core::vec3(0.5f)) * overlap.voxelSizeA);
+        core::vec3 centerB = transformB.position + transformB.rotation * ((core::vec3(voxelB.cellMin) + core::vec3(0.5f)) * overlap.voxelSizeB);
+        pair.voxelA = voxelA.cellMin;
+        pair.ZOrderA = voxelA.ZOrder;
+        pair.voxelB = voxelB.cellMin;
+        pair.ZOrderB = voxelB.ZOrder;
+        pair.contactPoint = (centerA + centerB) * 0.5f;
+        pair.normal = transformA.rotation * pair.normal;
+        pair.depth *= overlap.voxelSizeA;
+        overlap.pairs->push_back(pair);
+    }
+
+    // Descends both tree64s together, always splitting the bigger of the two cells, and only keeps the child pairs whose boxes overlap.
+    void findOverlappingCellsTree64(Tree64Overlap& overlap, const Tree64Cell& cellA, const Tree64Cell& cellB) {
+        if(overlap.found && overlap.pairs == nullptr) {
+            return;
+        }
+        if(cellA.level == 0 && cellB.level == 0) {
+            addVoxelOverlapPair(overlap, cellA, cellB);
+            return;
+        }
+        float sizeA = float(1 << (2 * cellA.level));
+        float sizeB = float(1 << (2 * cellB.level)) * overlap.scaleB;
+        bool splitA = cellB.level == 0 || (cellA.level > 0 && sizeA >= sizeB);
+        const Tree64Cell& parent = splitA ? cellA : cellB;
+        const uint32_t* node = (splitA ? overlap.tree64A : overlap.tree64B) + size_t(parent.nodeIndex) * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        uint32_t firstChild = parent.nodeIndex + getTree64ChildPointer(node);
+        int childSize = 1 << (2 * (parent.level - 1));
+        uint32_t childRank = 0;
+        for(uint64_t remaining = validMask; remaining != 0; childRank++) {
+            uint32_t zOrderInParent = uint32_t(__builtin_clzll(remaining));
+            remaining &= ~(1ull << (63 - zOrderInParent));
+            Tree64Cell child = {firstChild + childRank, parent.level - 1, (parent.ZOrder << 6) | zOrderInParent, parent.cellMin + getTree64ChildOffset(zOrderInParent) * childSize};
+            const Tree64Cell& childA = splitA ? child : cellA;
+            const Tree64Cell& childB = splitA ? cellB : child;
+            float depth;
+            core::vec3 normal;
+            if(getCellPenetration(overlap, childA, childB, depth, normal)) {
+                findOverlappingCellsTree64(overlap, childA, childB);
+            }
+        }
+    }
+
+    bool searchOverlappingVoxelsTree64(const char* functionName, const std::vector<uint32_t>& tree64A, int gridResolutionA, const VoxelObjectTransform& transformA,
+                                       const std::vector<uint32_t>& tree64B, int gridResolutionB, const VoxelObjectTransform& transformB, std::vector<VoxelOverlapPair>* pairs) {
+        int levelsOfDepthA = getTree64LevelsOfDepth(gridResolutionA);
+        int levelsOfDepthB = getTree64LevelsOfDepth(gridResolutionB);
+        if(levelsOfDepthA > MAX_TREE64_LEVELS || levelsOfDepthB > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument(std::string(functionName) + ": Resolution " + std::to_string(std::max(gridResolutionA, gridResolutionB)) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(!(transformA.scale > 0.0f) || !(transformB.scale > 0.0f)) {
+            throw std::invalid_argument(std::string(functionName) + ": Transform scales must be positive");
+        }
+        if(tree64A.empty() || tree64B.empty() || getTree64ValidMask(tree64A.data()) == 0 || getTree64ValidMask(tree64B.data()) == 0) {
+            return false;
+        }
+
+        Tree64Overlap overlap;
+        overlap.tree64A = tree64A.data();
+        overlap.tree64B = tree64B.data();
+        overlap.voxelSizeA = transformA.scale / float(gridResolutionA);
+        overlap.voxelSizeB = transformB.scale / float(gridResolutionB);
+        core::mat3 inverseRotationA = core::transpose(transformA.rotation);
+        overlap.rotationB = inverseRotationA * transformB.rotation;
+        overlap.originB = inverseRotationA * (transformB.position - transformA.position) / overlap.voxelSizeA;
+        overlap.scaleB = overlap.voxelSizeB / overlap.voxelSizeA;
+        createSeparatingAxes(overlap);
+        overlap.transformA = &transformA;
+        overlap.transformB = &transformB;
+        overlap.pairs = pairs;
+        overlap.found = false;
+
+        Tree64Cell rootA = {0, levelsOfDepthA, 0, core::ivec3(0)};
+        Tree64Cell rootB = {0, levelsOfDepthB, 0, core::ivec3(0)};
+        float depth;
+        core::vec3 normal;
+        if(getCellPenetration(overlap, rootA, rootB, depth, normal)) {
+            findOverlappingCellsTree64(overlap, rootA, rootB);
+        }
+        return overlap.found;
+    }
+
+    bool areTree64sOverlapping(const std::vector<uint32_t>& tree64A, int gridResolutionA, const VoxelObjectTransform& transformA,
+                               const std::vector<uint32_t>& tree64B, int gridResolutionB, const VoxelObjectTransform& transformB) {
+        return searchOverlappingVoxelsTree64("areTree64sOverlapping", tree64A, gridResolutionA, transformA, tree64B, gridResolutionB, transformB, nullptr);
+    }
+
+    void findOverlappingVoxelsTree64(const std::vector<uint32_t>& tree64A, int gridResolutionA, const VoxelObjectTransform& transformA,
+                                     const std::vector<uint32_t>& tree64B, int gridResolutionB, const VoxelObjectTransform& transformB, std::vector<VoxelOverlapPair>& pairs) {
+        searchOverlappingVoxelsTree64("findOverlappingVoxelsTree64", tree64A, gridResolutionA, transformA, tree64B, gridResolutionB, transformB, &pairs);
+    }
+}
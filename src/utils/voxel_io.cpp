@@ -129,6 +129,56 @@ namespace projv::utils {
         core::info("writeSceneToDisk: Successfully wrote scene data to disk");
     }
 
+    // Appends data after the data written by writeUint32Vector, then the level table. See CHUNK_LEVEL_TABLE_MAGIC.
+    void appendChunkLevelTable(const std::string& fileDirectory, const std::vector<uint32_t>& data, const std::vector<size_t>& levelTable) {
+        std::ofstream outFile(fileDirectory, std::ios::binary | std::ios::app);
+        if (!outFile) {
+            core::warn("appendChunkLevelTable: Failed to open file for writing: {}", fileDirectory);
+            return;
+        }
+        size_t tableSize = levelTable.size();
+        outFile.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint32_t));
+        outFile.write(reinterpret_cast<const char*>(levelTable.data()), tableSize * sizeof(size_t));
+        outFile.write(reinterpret_cast<const char*>(&tableSize), sizeof(tableSize));
+        outFile.write(reinterpret_cast<const char*>(&CHUNK_LEVEL_TABLE_MAGIC), sizeof(CHUNK_LEVEL_TABLE_MAGIC));
+    }
+
+    // Returns false if the file has no level table. appendedWords is the number of uint32_t's appended before the table.
+    bool readChunkLevelTable(std::ifstream& inFile, std::vector<size_t>& levelTable, size_t& appendedWords) {
+        inFile.seekg(0, std::ios::end);
+        size_t fileSize = size_t(inFile.tellg());
+        size_t tableSize = 0;
+        size_t dataWords = 0;
+        uint32_t magic = 0;
+        if (fileSize < 3 * sizeof(size_t) + sizeof(magic)) {
+            return false;
+        }
+        inFile.seekg(0);
+        inFile.read(reinterpret_cast<char*>(&dataWords), sizeof(dataWords));
+        inFile.seekg(fileSize - sizeof(magic));
+        inFile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        inFile.seekg(fileSize - sizeof(magic) - sizeof(tableSize));
+        inFile.read(reinterpret_cast<char*>(&tableSize), sizeof(tableSize));
+        size_t bodyBytes = fileSize - 2 * sizeof(size_t) - sizeof(magic); // The data, the appended words and the table.
+        if (!inFile || magic != CHUNK_LEVEL_TABLE_MAGIC || tableSize > bodyBytes / sizeof(size_t) || dataWords > (bodyBytes - tableSize * sizeof(size_t)) / sizeof(uint32_t)) {
+            inFile.clear();
+            return false;
+        }
+        appendedWords = (bodyBytes - tableSize * sizeof(size_t) - dataWords * sizeof(uint32_t)) / sizeof(uint32_t);
+        levelTable.resize(tableSize);
+        inFile.seekg(fileSize - sizeof(magic) - sizeof(tableSize) - tableSize * sizeof(size_t));
+        inFile.read(reinterpret_cast<char*>(levelTable.data()), tableSize * sizeof(size_t));
+        return bool(inFile);
+    }
+
+    // Reads wordCount uint32_t's starting firstWord uint32_t's after the count written by writeUint32Vector.
+    std::vector<uint32_t> readUint32Range(std::ifstream& inFile, size_t firstWord, size_t wordCount) {
+        std::vector<uint32_t> words(wordCount);
+        inFile.seekg(sizeof(size_t) + firstWord * sizeof(uint32_t));
+        inFile.read(reinterpret_cast<char*>(words.data()), wordCount * sizeof(uint32_t));
+        return words;
+    }
+
     Chunk loadChunkFromDisk(std::string sceneFileDirectory, ChunkHeader chunk) {
         uint32_t chunkID = chunk.chunkID;
         core::info("[loadChunkFromDisk] Loading chunk {} from disk...", chunkID);
@@ -155,7 +205,19 @@ namespace projv::utils {
         chunkData.geometryData = readUint32Vector(sceneFileDirectory + "/tree64/" + std::to_string(chunkData.header.chunkID) + ".bin");
         chunkData.voxelTypeData = readUint32Vector(sceneFileDirectory + "/voxelTypeData/" + std::to_string(chunkData.header.chunkID) + ".bin");
 
+        // Node colors are appended to the tree64 file before its level table, files written without them get them computed.
+        std::ifstream tree64File(sceneFileDirectory + "/tree64/" + std::to_string(chunkData.header.chunkID) + ".bin", std::ios::binary);
+        std::vector<size_t> levelEnds;
+        size_t nodeColorWords = 0;
+        size_t nodeCount = chunkData.geometryData.size() / 3;
+        if (tree64File && readChunkLevelTable(tree64File, levelEnds, nodeColorWords) && nodeColorWords == nodeCount && nodeCount != 0) {
+            chunkData.nodeColorData = readUint32Range(tree64File, nodeCount * 3, nodeCount);
+        } else {
+            chunkData.nodeColorData = createTree64NodeColors(chunkData.geometryData, chunkData.voxelTypeData);
+        }
+
         chunkData.LOD = 0;
+        bumpChunkRevision(chunkData);
 
         auto end = std::chrono::high_resolution_clock::now();
         double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
@@ -163,6 +225,64 @@ namespace projv::utils {
         return chunkData;
     }
 
+    Chunk loadChunkFromDiskAtLOD(std::string sceneFileDirectory, ChunkHeader chunkHeader, uint32_t LOD) {
+        if (LOD == 0) {
+            return loadChunkFromDisk(sceneFileDirectory, chunkHeader);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        uint32_t chunkID = chunkHeader.chunkID;
+        std::vector<ChunkHeader> chunkHeaders = readHeadersJSON(sceneFileDirectory + "/headers.json");
+        auto it = std::find_if(chunkHeaders.begin(), chunkHeaders.end(), [chunkID](const ChunkHeader& header) {
+            return header.chunkID == chunkID;
+        });
+        if (it == chunkHeaders.end()) {
+            throw std::invalid_argument("loadChunkFromDiskAtLOD: Chunk " + std::to_string(chunkID) + " not found in headers file");
+        }
+        Chunk chunkData;
+        chunkData.header = *it;
+        chunkData.LOD = 0;
+        int levelsOfDepth = getTree64LevelsOfDepth(int(chunkData.header.resolution));
+        if (LOD >= uint32_t(levelsOfDepth)) {
+            throw std::invalid_argument("loadChunkFromDiskAtLOD: Chunk " + std::to_string(chunkID) + " has " + std::to_string(levelsOfDepth) + " levels, it can't be loaded at LOD " + std::to_string(LOD));
+        }
+        int keptLevels = levelsOfDepth - int(LOD);
+
+        std::ifstream tree64File(sceneFileDirectory + "/tree64/" + std::to_string(chunkID) + ".bin", std::ios::binary);
+        std::ifstream voxelTypeDataFile(sceneFileDirectory + "/voxelTypeData/" + std::to_string(chunkID) + ".bin", std::ios::binary);
+        std::vector<size_t> levelEnds;
+        std::vector<size_t> LODEnds;
+        size_t nodeColorWords = 0;
+        size_t lowerLODWords = 0;
+        if (tree64File && voxelTypeDataFile && readChunkLevelTable(tree64File, levelEnds, nodeColorWords) && readChunkLevelTable(voxelTypeDataFile, LODEnds, lowerLODWords) &&
+            levelEnds.size() == size_t(levelsOfDepth) && LODEnds.size() == size_t(levelsOfDepth) && nodeColorWords == levelEnds.back()) {
+            // The first levels of a breadth first tree64 are the start of it, and their node colors the start of the stored ones.
+            chunkData.geometryData = readUint32Range(tree64File, 0, levelEnds[keptLevels - 1] * 3);
+            truncateTree64Levels(chunkData.geometryData, levelEnds, keptLevels);
+            chunkData.nodeColorData = readUint32Range(tree64File, levelEnds.back() * 3, levelEnds[keptLevels - 1]);
+            chunkData.voxelTypeData = readUint32Range(voxelTypeDataFile, LODEnds[LOD - 1], LODEnds[LOD] - LODEnds[LOD - 1]);
+        } else {
+            core::info("loadChunkFromDiskAtLOD: Chunk {} has no level table or node colors, loading it whole", chunkID);
+            chunkData.geometryData = readUint32Vector(sceneFileDirectory + "/tree64/" + std::to_string(chunkID) + ".bin");
+            chunkData.voxelTypeData = readUint32Vector(sceneFileDirectory + "/voxelTypeData/" + std::to_string(chunkID) + ".bin");
+            // Colors come from the full voxels, as reduceChunkLOD keeps them.
+            chunkData.nodeColorData = createTree64NodeColors(chunkData.geometryData, chunkData.voxelTypeData);
+            truncateTree64Levels(chunkData.geometryData, findTree64LevelEnds(chunkData.geometryData, levelsOfDepth), keptLevels);
+            chunkData.geometryData.shrink_to_fit();
+            chunkData.nodeColorData.resize(chunkData.geometryData.size() / 3);
+            chunkData.nodeColorData.shrink_to_fit();
+            chunkData.voxelTypeData = mergeVoxelTypeDataLevels(chunkData.voxelTypeData, LOD);
+        }
+        chunkData.header.resolution >>= 2 * LOD;
+        chunkData.header.voxelScale *= float(1u << (2 * LOD));
+        chunkData.LOD = LOD;
+        bumpChunkRevision(chunkData);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("loadChunkFromDiskAtLOD: Loaded chunk {} at LOD {} in {:.2f}ms", chunkID, LOD, elapsed);
+        return chunkData;
+    }
+
     void writeChunkToDisk(std::string sceneFileDirectory, Chunk chunk) {
         // Reads the header data if it exists.
         std::vector<ChunkHeader> chunkHeaders;
@@ -192,8 +312,33 @@ namespace projv::utils {
 
         // Writes our tree64 and voxelTypeData and creates it if it exists. Also writes headers.
         writeHeadersJSON(chunkHeaders, sceneFileDirectory + "/headers.json");
-        writeUint32Vector(chunk.geometryData, sceneFileDirectory + "/tree64/" + std::to_string(chunk.header.chunkID) + ".bin");
-        writeUint32Vector(chunk.voxelTypeData, sceneFileDirectory + "/voxelTypeData/" + std::to_string(chunk.header.chunkID) + ".bin");
+        std::string tree64File = sceneFileDirectory + "/tree64/" + std::to_string(chunk.header.chunkID) + ".bin";
+        std::string voxelTypeDataFile = sceneFileDirectory + "/voxelTypeData/" + std::to_string(chunk.header.chunkID) + ".bin";
+        writeUint32Vector(chunk.geometryData, tree64File);
+        writeUint32Vector(chunk.voxelTypeData, voxelTypeDataFile);
+
+        // Appends the level tables and the voxelTypeData of the lower LODs after the data.
+        int levelsOfDepth = getTree64LevelsOfDepth(int(chunk.header.resolution));
+        std::vector<size_t> levelEnds;
+        try {
+            levelEnds = findTree64LevelEnds(chunk.geometryData, levelsOfDepth);
+        } catch (const std::invalid_argument& exception) {
+            core::warn("writeChunkToDisk: Chunk {} is written without a level table, it can only be loaded whole: {}", chunk.header.chunkID, exception.what());
+            return;
+        }
+        // The node colors go before the tree64's level table, so loadChunkFromDiskAtLOD can read the ones of the levels it keeps.
+        bool hasNodeColors = chunk.nodeColorData.size() * 3 == chunk.geometryData.size();
+        appendChunkLevelTable(tree64File, hasNodeColors ? chunk.nodeColorData : createTree64NodeColors(chunk.geometryData, chunk.voxelTypeData), levelEnds);
+
+        std::vector<uint32_t> lowerLODs;
+        std::vector<size_t> LODEnds = {chunk.voxelTypeData.size()};
+        for (int LOD = 1; LOD < levelsOfDepth; LOD++) {
+            // Each LOD is merged from the full voxels, averaging already averaged colors would weigh the voxels unevenly.
+            std::vector<uint32_t> voxelTypeDataAtLOD = mergeVoxelTypeDataLevels(chunk.voxelTypeData, uint32_t(LOD));
+            lowerLODs.insert(lowerLODs.end(), voxelTypeDataAtLOD.begin(), voxelTypeDataAtLOD.end());
+            LODEnds.emplace_back(LODEnds.back() + voxelTypeDataAtLOD.size());
+        }
+        appendChunkLevelTable(voxelTypeDataFile, lowerLODs, LODEnds);
     }
 
     Scene loadSceneFromDisk(std::string sceneFileDirectory) {
@@ -211,9 +356,7 @@ namespace projv::utils {
     }
 
     std::vector<ChunkHeader> loadChunkHeadersFromDisk(std::string sceneFileDirectory) {
-        std::vector<ChunkHeader> sceneHeaders;
-        std::vector<ChunkHeader> chunkHeaders = readHeadersJSON(sceneFileDirectory + "/headers.json");
-        return sceneHeaders;
+        return readHeadersJSON(sceneFileDirectory + "/headers.json");
     }
 
     std::vector<ChunkHeader> getChunkHeadersFromScene(Scene& scene) {
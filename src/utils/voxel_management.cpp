@@ -85,11 +85,10 @@ namespace projv::utils {
         return newLevel;
     }
 
-    std::vector<nodeStructureTree64> aggregateLevelFromVoxelGridTree64(VoxelGrid& oldLevel, bool childParent = false) {
+    std::vector<nodeStructureTree64> aggregateLevelFromVoxelRangeTree64(const Voxel* firstVoxel, const Voxel* lastVoxel, bool childParent = false) {
         std::vector<nodeStructureTree64> newLevel;
-        //newLevel.reserve(oldLevel.voxels.size());
-        for(int i = oldLevel.voxels.size() - 1; i >= 0; i--) { // Looping over every voxel in reverse
-            Voxel voxel = oldLevel.voxels[i];
+        for(const Voxel* it = lastVoxel; it != firstVoxel;) { // Looping over every voxel in reverse
+            Voxel voxel = *(--it);
             uint32_t newIndex = voxel.ZOrderPosition / 64;
             uint32_t relativeZOrder = (voxel.ZOrderPosition % 64);
             uint64_t bitToSet = (1ull << (63 - relativeZOrder));
@@ -122,6 +121,10 @@ namespace projv::utils {
         return newLevel;
     }
 
+    std::vector<nodeStructureTree64> aggregateLevelFromVoxelGridTree64(VoxelGrid& oldLevel, bool childParent = false) {
+        return aggregateLevelFromVoxelRangeTree64(oldLevel.voxels.data(), oldLevel.voxels.data() + oldLevel.voxels.size(), childParent);
+    }
+
     std::vector<uint32_t> createTree64(VoxelGrid& voxels, int gridResolution) {
         std::chrono::high_resolution_clock::time_point startWhole = std::chrono::high_resolution_clock::now();
         core::info("createTree64: Starting tree64 generation with resolution {}x{}x{} ({} voxels total)", gridResolution, gridResolution, gridResolution, gridResolution * gridResolution * gridResolution);
@@ -165,35 +168,522 @@ namespace projv::utils {
         return tree64Simplified;
     }
 
+    std::vector<uint32_t> createTree64Parallel(VoxelGrid& voxels, int gridResolution, int threadCount) {
+        int levelsOfDepth = int(log10(gridResolution)/log10(4));
+        if(levelsOfDepth < 2 || voxels.voxels.empty()) { // Only the root exists, nothing to split.
+            return createTree64(voxels, gridResolution);
+        }
+
+        std::chrono::high_resolution_clock::time_point startWhole = std::chrono::high_resolution_clock::now();
+
+        // Every child of the root covers a contiguous Z-Order range of the sorted voxels, so each range is an independent subtree.
+        uint32_t subtreeShift = 6 * (levelsOfDepth - 1);
+        std::vector<std::pair<size_t, size_t>> subtreeRanges;
+        const Voxel* voxelData = voxels.voxels.data();
+        size_t voxelCount = voxels.voxels.size();
+        for(size_t begin = 0; begin < voxelCount;) {
+            uint32_t subtreeKey = voxelData[begin].ZOrderPosition >> subtreeShift;
+            const Voxel* end = std::partition_point(voxelData + begin, voxelData + voxelCount, [subtreeKey, subtreeShift](const Voxel& voxel) {
+                return (voxel.ZOrderPosition >> subtreeShift) <= subtreeKey;
+            });
+            subtreeRanges.emplace_back(begin, end - voxelData);
+            begin = end - voxelData;
+        }
+
+        // Each subtree stores its levels from the parents of the leaves up to the child of the root, every level in descending Z-Order like createTree64.
+        std::vector<std::vector<std::vector<nodeStructureTree64>>> subtreeLevels(subtreeRanges.size());
+        std::atomic<size_t> nextSubtree{0};
+        auto buildSubtrees = [&]() {
+            for(size_t s = nextSubtree++; s < subtreeRanges.size(); s = nextSubtree++) {
+                std::vector<std::vector<nodeStructureTree64>>& levels = subtreeLevels[s];
+                levels.reserve(levelsOfDepth - 1);
+                levels.emplace_back(aggregateLevelFromVoxelRangeTree64(voxelData + subtreeRanges[s].first, voxelData + subtreeRanges[s].second, true));
+                for(int i = 0; i < levelsOfDepth - 2; i++) {
+                    std::vector<nodeStructureTree64> levelInProgress = aggregateLevelTree64(levels.back());
+                    for(size_t j = 0; j < levelInProgress.size(); j++) {
+                        levelInProgress[j].pointerAndLeafFlag &= 0b11111111111111111111111111111110; // Removes the leaf flag from the node.
+                    }
+                    levels.emplace_back(std::move(levelInProgress));
+                }
+            }
+        };
+
+        unsigned int workerCount = threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::min<size_t>(workerCount, subtreeRanges.size());
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < workerCount; i++) {
+            workers.emplace_back(buildSubtrees);
+        }
+        buildSubtrees(); // The calling thread works too.
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        // Aggregate the tops of the subtrees into the root level, fed in descending order to match the serial build.
+        std::vector<nodeStructureTree64> subtreeTops;
+        size_t nodeCount = 0;
+        for(size_t s = subtreeLevels.size(); s-- > 0;) {
+            subtreeTops.insert(subtreeTops.end(), subtreeLevels[s].back().begin(), subtreeLevels[s].back().end());
+            for(size_t level = 0; level < subtreeLevels[s].size(); level++) {
+                nodeCount += subtreeLevels[s][level].size();
+            }
+        }
+        std::vector<nodeStructureTree64> rootLevel = aggregateLevelTree64(subtreeTops);
+        nodeCount += rootLevel.size();
+
+        // Stitch the levels together breadth first: root, then every level top down with the subtrees in ascending Z-Order.
+        std::vector<uint32_t> tree64Simplified;
+        tree64Simplified.reserve(nodeCount * 3);
+        auto emplaceNodesAscending = [&tree64Simplified](const std::vector<nodeStructureTree64>& level) {
+            for(auto it = level.rbegin(); it != level.rend(); ++it) {
+                tree64Simplified.emplace_back(it->mask1);
+                tree64Simplified.emplace_back(it->mask2);
+                tree64Simplified.emplace_back(it->pointerAndLeafFlag);
+            }
+        };
+        emplaceNodesAscending(rootLevel);
+        for(int level = levelsOfDepth - 2; level >= 0; level--) {
+            for(size_t s = 0; s < subtreeLevels.size(); s++) {
+                emplaceNodesAscending(subtreeLevels[s][level]);
+            }
+        }
+
+        addPointersTree64(tree64Simplified);
+
+        auto endWhole = std::chrono::high_resolution_clock::now();
+        double elapsedWhole = std::chrono::duration<double, std::milli>(endWhole - startWhole).count();
+        core::info("createTree64Parallel: Completed tree-64 generation in {:.2f}ms using {} threads over {} subtrees", elapsedWhole, workerCount, subtreeRanges.size());
+
+        return tree64Simplified;
+    }
+
+    std::vector<uint32_t> createTree64Streaming(VoxelGrid& voxels, int gridResolution) {
+        auto start = std::chrono::high_resolution_clock::now();
+        Tree64Layout layout = measureTree64(voxels.voxels.begin(), voxels.voxels.end(), gridResolution);
+        std::vector<uint32_t> tree64(layout.nodeCount * 3);
+        writeTree64(voxels.voxels.begin(), voxels.voxels.end(), layout, tree64.data(), tree64.size());
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("createTree64Streaming: Completed tree-64 generation in {:.2f}ms ({} nodes)", elapsed, layout.nodeCount);
+        return tree64;
+    }
+
+    uint32_t serializeColor(Color color) {
+        int R10 = (color.r)*4;
+        int G10 = (color.g)*4;
+        int B10 = (color.b)*4;
+        return uint32_t(R10 << 20 | G10 << 10 | B10);
+    }
+
+    uint32_t serializeNormal(core::vec3 normal) {
+        uint8_t normalXSign = 1;
+        uint8_t normalYSign = 1;
+        uint8_t normalZSign = 1;
+        if(normal.x < 0) normalXSign = 0;
+        if(normal.y < 0) normalYSign = 0;
+        if(normal.z < 0) normalZSign = 0;
+        int normalX9 = int(std::abs(normal.x)*511) & 0x1FF;
+        int normalY9 = int(std::abs(normal.y)*511) & 0x1FF;
+        int normalZ9 = int(std::abs(normal.z)*511) & 0x1FF;
+        return uint32_t((normalXSign << 29) | (normalX9 << 20) | (normalYSign << 19) | (normalY9 << 10) | (normalZSign << 9) | normalZ9);
+    }
+
     std::vector<uint32_t> createVoxelTypeData(VoxelGrid& voxels) {
         std::vector<uint32_t> voxelTypeData;
+        voxelTypeData.reserve(voxels.voxels.size() * 3);
         for(size_t i = 0; i < voxels.voxels.size(); i++){
             Voxel voxel = voxels.voxels[i];
             //core::debug("{} ZOrderIndex", i);
             voxelTypeData.emplace_back(voxel.ZOrderPosition);
-            int R10 = (voxel.color.r)*4;
-            int G10 = (voxel.color.g)*4;
-            int B10 = (voxel.color.b)*4;
-            float normalX = 0;
-            float normalY = 0;
-            float normalZ = 0;
-            uint8_t normalXSign = 1;
-            uint8_t normalYSign = 1;
-            uint8_t normalZSign = 1;
-            if(normalX < 0) normalXSign = 0;
-            if(normalY < 0) normalYSign = 0;
-            if(normalZ < 0) normalZSign = 0;
-            int normalX9 = int(abs(normalX)*511) & 0x1FF;
-            int normalY9 = int(abs(normalY)*511) & 0x1FF;
-            int normalZ9 = int(abs(normalZ)*511) & 0x1FF;
-            uint32_t SerializedColor = uint32_t(R10 << 20 | G10 << 10 | B10);
-            uint32_t SerializedNormal = uint32_t((normalXSign << 29) | (normalX9 << 20) | (normalYSign << 19) | (normalY9 << 10) | (normalZSign << 9) | normalZ9);
-            voxelTypeData.emplace_back(SerializedColor);
-            voxelTypeData.emplace_back(SerializedNormal);
+            voxelTypeData.emplace_back(serializeColor(voxel.color));
+            voxelTypeData.emplace_back(serializeNormal(core::vec3(0.0f)));
+        }
+        return voxelTypeData;
+    }
+
+    // Finds the index (in voxels, not uint32_t's) of the first voxel in voxelTypeData with a Z-Order not less than ZOrder.
+    size_t findVoxelInVoxelTypeData(const std::vector<uint32_t>& voxelTypeData, uint32_t ZOrder) {
+        size_t low = 0;
+        size_t high = voxelTypeData.size() / 3;
+        while(low < high) {
+            size_t middle = low + (high - low) / 2;
+            if(voxelTypeData[middle * 3] < ZOrder) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    void setVoxelInVoxelTypeData(std::vector<uint32_t>& voxelTypeData, const Voxel& voxel) {
+        size_t index = findVoxelInVoxelTypeData(voxelTypeData, voxel.ZOrderPosition);
+        uint32_t serializedColor = serializeColor(voxel.color);
+        if(index < voxelTypeData.size() / 3 && voxelTypeData[index * 3] == voxel.ZOrderPosition) {
+            voxelTypeData[index * 3 + 1] = serializedColor;
+            return;
+        }
+        uint32_t entry[3] = {voxel.ZOrderPosition, serializedColor, serializeNormal(core::vec3(0.0f))};
+        voxelTypeData.insert(voxelTypeData.begin() + index * 3, entry, entry + 3);
+    }
+
+    bool eraseVoxelFromVoxelTypeData(std::vector<uint32_t>& voxelTypeData, uint32_t ZOrder) {
+        size_t index = findVoxelInVoxelTypeData(voxelTypeData, ZOrder);
+        if(index >= voxelTypeData.size() / 3 || voxelTypeData[index * 3] != ZOrder) {
+            return false;
+        }
+        voxelTypeData.erase(voxelTypeData.begin() + index * 3, voxelTypeData.begin() + index * 3 + 3);
+        return true;
+    }
+
+    // Adds offset to the relative pointer of every node in (firstNode, lastNode) that has non-leaf children.
+    // Used after a node was inserted or erased at lastNode, which moves the children of those nodes but not the nodes themselves.
+    void shiftChildPointersTree64(std::vector<uint32_t>& tree64, size_t firstNode, size_t lastNode, int offset) {
+        for(size_t i = firstNode + 1; i < lastNode; i++) {
+            uint32_t* node = tree64.data() + i * 3;
+            if(isTree64LeafParent(node) || getTree64ValidMask(node) == 0) {
+                continue;
+            }
+            node[2] = (uint32_t(int(getTree64ChildPointer(node)) + offset) << 1) | (node[2] & 0b1);
+        }
+    }
+
+    void setTree64ChildBit(uint32_t* node, uint32_t zOrderInParent, bool valid) {
+        uint32_t& mask = zOrderInParent < 32 ? node[0] : node[1];
+        uint32_t bit = 1u << (31 - (zOrderInParent & 31));
+        if(valid) {
+            mask |= bit;
+        } else {
+            mask &= ~bit;
+        }
+    }
+
+    bool setVoxelInTree64(std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder, std::vector<uint32_t>* nodeColors) {
+        if(!hasSingleTree64Root(gridResolution)) {
+            throw std::invalid_argument("setVoxelInTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS || (uint64_t(ZOrder) >> (6 * levelsOfDepth)) != 0) {
+            throw std::invalid_argument("setVoxelInTree64: Z-Order " + std::to_string(ZOrder) + " lies outside of a tree64 with resolution " + std::to_string(gridResolution));
+        }
+
+        if(tree64.empty()) {
+            tree64 = {0, 0, levelsOfDepth == 1 ? 1u : 0u};
+            if(nodeColors != nullptr) {
+                *nodeColors = {0};
+            }
+        }
+
+        // Index of the first node of each level, the end of the tree when a level has no nodes yet.
+        std::array<size_t, MAX_TREE64_LEVELS + 1> levelStarts;
+        levelStarts[0] = 0;
+        for(int depth = 0; depth < levelsOfDepth - 1; depth++) {
+            uint32_t pointer = levelStarts[depth] < tree64.size() / 3 ? getTree64ChildPointer(tree64.data() + levelStarts[depth] * 3) : 0;
+            levelStarts[depth + 1] = pointer == 0 ? tree64.size() / 3 : levelStarts[depth] + pointer;
+        }
+
+        size_t nodeIndex = 0;
+        for(int depth = 0; depth < levelsOfDepth; depth++) {
+            uint32_t zOrderInParent = (ZOrder >> (6 * (levelsOfDepth - 1 - depth))) & 63;
+            uint32_t* node = tree64.data() + nodeIndex * 3;
+            uint64_t validMask = getTree64ValidMask(node);
+
+            if(depth == levelsOfDepth - 1) {
+                if(isTree64ChildValid(validMask, zOrderInParent)) {
+                    return false;
+                }
+                setTree64ChildBit(node, zOrderInParent, true);
+                return true;
+            }
+
+            if(isTree64ChildValid(validMask, zOrderInParent)) {
+                nodeIndex += getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+                continue;
+            }
+
+            // Find where the missing child goes in the next level.
+            size_t childIndex;
+            if(validMask != 0) {
+                childIndex = nodeIndex + getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+            } else {
+                // The node has no children yet, so they start right after the children of the closest previous node on its level.
+                childIndex = levelStarts[depth + 1];
+                for(size_t previous = nodeIndex; previous > levelStarts[depth]; previous--) {
+                    const uint32_t* previousNode = tree64.data() + (previous - 1) * 3;
+                    uint64_t previousMask = getTree64ValidMask(previousNode);
+                    if(previousMask != 0) {
+                        childIndex = previous - 1 + getTree64ChildPointer(previousNode) + __builtin_popcountll(previousMask);
+                        break;
+                    }
+                }
+                node[2] = (uint32_t(childIndex - nodeIndex) << 1) | (node[2] & 0b1);
+            }
+            setTree64ChildBit(node, zOrderInParent, true);
+            shiftChildPointersTree64(tree64, nodeIndex, childIndex, 1);
+
+            uint32_t childNode[3] = {0, 0, depth + 1 == levelsOfDepth - 1 ? 1u : 0u};
+            tree64.insert(tree64.begin() + childIndex * 3, childNode, childNode + 3);
+            if(nodeColors != nullptr) {
+                nodeColors->insert(nodeColors->begin() + childIndex, 0);
+            }
+            for(int level = depth + 2; level < levelsOfDepth; level++) {
+                levelStarts[level] += 1;
+            }
+            nodeIndex = childIndex;
+        }
+        return false;
+    }
+
+    bool clearVoxelInTree64(std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder, std::vector<uint32_t>* nodeColors) {
+        if(!hasSingleTree64Root(gridResolution)) {
+            throw std::invalid_argument("clearVoxelInTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(tree64.empty() || levelsOfDepth > MAX_TREE64_LEVELS || (uint64_t(ZOrder) >> (6 * levelsOfDepth)) != 0) {
+            return false;
+        }
+
+        // Walk down to the parent of the leaf, remembering the path.
+        std::array<size_t, MAX_TREE64_LEVELS> path;
+        std::array<uint32_t, MAX_TREE64_LEVELS> zOrdersInParents;
+        size_t nodeIndex = 0;
+        for(int depth = 0; depth < levelsOfDepth; depth++) {
+            uint32_t zOrderInParent = (ZOrder >> (6 * (levelsOfDepth - 1 - depth))) & 63;
+            const uint32_t* node = tree64.data() + nodeIndex * 3;
+            uint64_t validMask = getTree64ValidMask(node);
+            if(!isTree64ChildValid(validMask, zOrderInParent)) {
+                return false;
+            }
+            path[depth] = nodeIndex;
+            zOrdersInParents[depth] = zOrderInParent;
+            nodeIndex += getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+        }
+
+        // Clear bottom up, removing nodes that are left without children.
+        for(int depth = levelsOfDepth - 1; depth >= 0; depth--) {
+            uint32_t* node = tree64.data() + path[depth] * 3;
+            setTree64ChildBit(node, zOrdersInParents[depth], false);
+            if(getTree64ValidMask(node) != 0) {
+                break;
+            }
+            if(depth == 0) {
+                tree64.clear();
+                if(nodeColors != nullptr) {
+                    nodeColors->clear();
+                }
+                break;
+            }
+            tree64.erase(tree64.begin() + path[depth] * 3, tree64.begin() + path[depth] * 3 + 3);
+            if(nodeColors != nullptr) {
+                nodeColors->erase(nodeColors->begin() + path[depth]);
+            }
+            shiftChildPointersTree64(tree64, path[depth - 1], path[depth], -1);
+        }
+        return true;
+    }
+
+    void addAttributeOffsetsTree64(std::vector<uint32_t>& tree64) {
+        uint32_t attributeOffset = 0;
+        for(size_t i = 0; i < tree64.size() / 3; i++) {
+            uint32_t* node = tree64.data() + i * 3;
+            if(!isTree64LeafParent(node)) {
+                continue;
+            }
+            node[2] = (attributeOffset << 1) | 0b1;
+            attributeOffset += __builtin_popcountll(getTree64ValidMask(node));
+        }
+        if(attributeOffset > 0x7FFFFFFF) {
+            core::error("addAttributeOffsetsTree64: Attribute offset too large (exceeds 31 bits)! Tree64 may be corrupted");
+        }
+    }
+
+    std::vector<uint32_t> createVoxelAttributeData(const std::vector<uint32_t>& voxelTypeData) {
+        std::vector<uint32_t> voxelAttributeData;
+        voxelAttributeData.reserve(voxelTypeData.size() / 3 * VOXEL_ATTRIBUTE_SLICES);
+        for(size_t i = 0; i < voxelTypeData.size() / 3; i++) {
+            voxelAttributeData.emplace_back(voxelTypeData[i * 3 + 1]);
+            voxelAttributeData.emplace_back(voxelTypeData[i * 3 + 2]);
+        }
+        return voxelAttributeData;
+    }
+
+    uint32_t findVoxelAttributeIndexTree64(const std::vector<uint32_t>& tree64, int gridResolution, uint32_t ZOrder) {
+        if(!hasSingleTree64Root(gridResolution)) {
+            throw std::invalid_argument("findVoxelAttributeIndexTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(tree64.empty() || levelsOfDepth > MAX_TREE64_LEVELS || (uint64_t(ZOrder) >> (6 * levelsOfDepth)) != 0) {
+            return UINT32_MAX;
+        }
+        size_t nodeIndex = 0;
+        for(int depth = 0; depth < levelsOfDepth; depth++) {
+            uint32_t zOrderInParent = (ZOrder >> (6 * (levelsOfDepth - 1 - depth))) & 63;
+            const uint32_t* node = tree64.data() + nodeIndex * 3;
+            uint64_t validMask = getTree64ValidMask(node);
+            if(!isTree64ChildValid(validMask, zOrderInParent)) {
+                return UINT32_MAX;
+            }
+            if(depth == levelsOfDepth - 1) {
+                // In a parent of leaves the pointer holds the attribute offset.
+                return getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+            }
+            nodeIndex += getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+        }
+        return UINT32_MAX;
+    }
+
+    void appendVoxelTypeDataFromAttributeData(const std::vector<uint32_t>& tree64, size_t nodeIndex, uint32_t ZOrderPrefix, const std::vector<uint32_t>& voxelAttributeData, std::vector<uint32_t>& voxelTypeData) {
+        const uint32_t* node = tree64.data() + nodeIndex * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        uint32_t childPointer = getTree64ChildPointer(node);
+        bool leafParent = isTree64LeafParent(node);
+        uint32_t childNumber = 0;
+        for(uint32_t zOrderInParent = 0; zOrderInParent < 64; zOrderInParent++) {
+            if(!isTree64ChildValid(validMask, zOrderInParent)) {
+                continue;
+            }
+            uint32_t ZOrder = (ZOrderPrefix << 6) | zOrderInParent;
+            if(leafParent) {
+                size_t attributeIndex = size_t(childPointer + childNumber) * VOXEL_ATTRIBUTE_SLICES;
+                if(attributeIndex + VOXEL_ATTRIBUTE_SLICES > voxelAttributeData.size()) {
+                    throw std::invalid_argument("createVoxelTypeDataFromAttributeData: Attribute index " + std::to_string(childPointer + childNumber) + " is out of range, the tree64 has no attribute offsets or doesn't match the attribute data");
+                }
+                voxelTypeData.emplace_back(ZOrder);
+                voxelTypeData.emplace_back(voxelAttributeData[attributeIndex]);
+                voxelTypeData.emplace_back(voxelAttributeData[attributeIndex + 1]);
+            } else {
+                appendVoxelTypeDataFromAttributeData(tree64, nodeIndex + childPointer + childNumber, ZOrder, voxelAttributeData, voxelTypeData);
+            }
+            childNumber++;
+        }
+    }
+
+    std::vector<uint32_t> createVoxelTypeDataFromAttributeData(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelAttributeData) {
+        std::vector<uint32_t> voxelTypeData;
+        voxelTypeData.reserve(voxelAttributeData.size() / VOXEL_ATTRIBUTE_SLICES * 3);
+        if(!tree64.empty()) {
+            appendVoxelTypeDataFromAttributeData(tree64, 0, 0, voxelAttributeData, voxelTypeData);
         }
         return voxelTypeData;
     }
 
+    // Stable LSD radix sort of any record type by the Z-Order getZOrder returns for it.
+    // order, if given, is permuted with the records, so other columns can be gathered once after the sort instead of moving in every pass.
+    template <typename Record, typename GetZOrder>
+    void radixSortByZOrder(std::vector<Record>& voxels, GetZOrder getZOrder, int threadCount, std::vector<uint32_t>* order = nullptr) {
+        constexpr int RADIX_BITS = 9;
+        constexpr size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+        constexpr size_t MIN_VOXELS_PER_THREAD = 1 << 16;
+
+        size_t voxelCount = voxels.size();
+        uint32_t combinedZOrders = 0;
+        for(size_t i = 0; i < voxelCount; i++) {
+            combinedZOrders |= getZOrder(voxels[i]);
+        }
+        if(voxelCount < 2 || combinedZOrders == 0) {
+            return;
+        }
+        int keyBits = 32 - __builtin_clz(combinedZOrders);
+        int passCount = (keyBits + RADIX_BITS - 1) / RADIX_BITS;
+
+        unsigned int workerCount = threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::max<size_t>(1, std::min<size_t>(workerCount, voxelCount / MIN_VOXELS_PER_THREAD));
+
+        // Every worker owns a contiguous slice of the input, so counting and scattering per slice in order keeps the sort stable.
+        auto sliceBegin = [&](unsigned int worker) { return voxelCount * worker / workerCount; };
+        auto runOnWorkers = [&](const auto& work) {
+            std::vector<std::thread> workers;
+            for(unsigned int i = 1; i < workerCount; i++) {
+                workers.emplace_back([&work, i]() { work(i); });
+            }
+            work(0); // The calling thread works too.
+            for(size_t i = 0; i < workers.size(); i++) {
+                workers[i].join();
+            }
+        };
+
+        std::vector<Record> buffer(voxelCount);
+        Record* source = voxels.data();
+        Record* destination = buffer.data();
+        std::vector<uint32_t> orderBuffer(order != nullptr ? voxelCount : 0);
+        uint32_t* orderSource = order != nullptr ? order->data() : nullptr;
+        uint32_t* orderDestination = orderBuffer.data();
+        std::vector<std::array<size_t, RADIX_BUCKETS>> offsets(workerCount);
+        for(int pass = 0; pass < passCount; pass++) {
+            int shift = pass * RADIX_BITS;
+            runOnWorkers([&](unsigned int worker) {
+                std::array<size_t, RADIX_BUCKETS>& histogram = offsets[worker];
+                histogram.fill(0);
+                for(size_t i = sliceBegin(worker); i < sliceBegin(worker + 1); i++) {
+                    histogram[(getZOrder(source[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+                }
+            });
+
+            // Turn the histograms into scatter offsets, bucket major and worker minor.
+            size_t offset = 0;
+            bool singleBucket = false;
+            for(size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+                size_t bucketStart = offset;
+                for(unsigned int worker = 0; worker < workerCount; worker++) {
+                    size_t bucketCount = offsets[worker][bucket];
+                    offsets[worker][bucket] = offset;
+                    offset += bucketCount;
+                }
+                if(offset - bucketStart == voxelCount) {
+                    singleBucket = true;
+                }
+            }
+            if(singleBucket) {
+                continue; // Every voxel has the same digit, this pass wouldn't move anything.
+            }
+
+            runOnWorkers([&](unsigned int worker) {
+                std::array<size_t, RADIX_BUCKETS>& writeOffsets = offsets[worker];
+                for(size_t i = sliceBegin(worker); i < sliceBegin(worker + 1); i++) {
+                    size_t writeOffset = writeOffsets[(getZOrder(source[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+                    destination[writeOffset] = source[i];
+                    if(orderSource != nullptr) {
+                        orderDestination[writeOffset] = orderSource[i];
+                    }
+                }
+            });
+            std::swap(source, destination);
+            std::swap(orderSource, orderDestination);
+        }
+
+        if(source != voxels.data()) {
+            voxels.swap(buffer);
+            if(order != nullptr) {
+                order->swap(orderBuffer);
+            }
+        }
+    }
+
+    // Keeps the last record of each run of equal Z-Orders in sorted records.
+    template <typename Record, typename GetZOrder>
+    void deduplicateSortedByZOrder(std::vector<Record>& voxels, GetZOrder getZOrder) {
+        // The sort is stable, so the last record of each run of equal Z-Orders is the last one written.
+        size_t keptVoxels = 0;
+        for(size_t i = 0; i < voxels.size(); i++) {
+            if(i + 1 < voxels.size() && getZOrder(voxels[i + 1]) == getZOrder(voxels[i])) {
+                continue;
+            }
+            voxels[keptVoxels++] = voxels[i];
+        }
+        voxels.resize(keptVoxels);
+    }
+
+    void radixSortVoxels(std::vector<Voxel>& voxels, int threadCount) {
+        radixSortByZOrder(voxels, [](const Voxel& voxel) { return voxel.ZOrderPosition; }, threadCount);
+    }
+
+    void sortAndDeduplicateVoxels(std::vector<Voxel>& voxels, int threadCount) {
+        auto getZOrder = [](const Voxel& voxel) { return voxel.ZOrderPosition; };
+        radixSortByZOrder(voxels, getZOrder, threadCount);
+        deduplicateSortedByZOrder(voxels, getZOrder);
+    }
+
     void addVoxelToVoxelGrid(VoxelGrid& voxels, core::ivec3 position, Color color) {
         Voxel voxel;
         voxel.ZOrderPosition = createZOrderIndex(position);
@@ -222,13 +712,10 @@ namespace projv::utils {
     }
 
     void addVoxelBatchToVoxelGrid(VoxelGrid& voxels, VoxelBatch& voxelBatch) {
-        for(size_t i = 0; i < voxelBatch.size(); i++) {
-            voxels.voxels.emplace_back(voxelBatch[i]);
-        }
-
-        std::sort(voxels.voxels.begin(), voxels.voxels.end(), [](const Voxel& a, const Voxel& b) {
-            return a.ZOrderPosition < b.ZOrderPosition;
-        });
+        // Only the batch is sorted, the grid already is. Then both are merged with the batch's voxels replacing the grid's.
+        VoxelBatch sortedVoxelBatch = voxelBatch;
+        sortAndDeduplicateVoxels(sortedVoxelBatch);
+        voxels.voxels = createVoxelBatchUnion(voxels.voxels, sortedVoxelBatch, VoxelColorPrecedence::KeepB);
     }
 
     VoxelBatch createVoxelBatch() {
@@ -281,6 +768,11 @@ namespace projv::utils {
         return chunk;
     }
 
+    void bumpChunkRevision(Chunk& chunk) {
+        static std::atomic<uint64_t> nextRevision{1}; // Chunks are loaded and lowered on other threads too.
+        chunk.revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    }
+
     void addVoxelToVoxelBatch(Voxel& voxel, VoxelBatch& voxelBatch) {
         voxelBatch.emplace_back(voxel);
         return;
@@ -334,24 +826,99 @@ namespace projv::utils {
     }
     
     void addVoxelBatchAToVoxelBatchB(VoxelBatch& voxelBatchA, VoxelBatch& voxelBatchB, core::ivec3 voxelBatchAPosition) {
-        for(size_t i = 0; i < voxelBatchA.size(); i++) {
-            core::ivec3 currentPosition = reverseZOrderIndex(voxelBatchA[i].ZOrderPosition);
-            core::ivec3 newPosition = currentPosition + voxelBatchAPosition;
-            newPosition.x = std::clamp(newPosition.x, 0, 511);
-            newPosition.y = std::clamp(newPosition.y, 0, 511);
-            newPosition.z = std::clamp(newPosition.z, 0, 511);
-            uint64_t newZOrderPosition = createZOrderIndex(newPosition);
+        // Move the Z-Orders in blocks so the batch kernel can vectorize and the block stays in cache.
+        constexpr size_t BLOCK_SIZE = 4096;
+        std::vector<uint32_t> ZOrders(std::min(BLOCK_SIZE, voxelBatchA.size()));
+        size_t firstCopiedVoxel = voxelBatchB.size();
+        voxelBatchB.resize(firstCopiedVoxel + voxelBatchA.size());
+        for(size_t blockStart = 0; blockStart < voxelBatchA.size(); blockStart += BLOCK_SIZE) {
+            size_t blockSize = std::min(BLOCK_SIZE, voxelBatchA.size() - blockStart);
+            for(size_t i = 0; i < blockSize; i++) {
+                ZOrders[i] = voxelBatchA[blockStart + i].ZOrderPosition;
+            }
+            translateZOrderIndexBatch(ZOrders.data(), ZOrders.data(), blockSize, voxelBatchAPosition, 511);
+            for(size_t i = 0; i < blockSize; i++) {
+                projv::Voxel copiedVoxel = voxelBatchA[blockStart + i];
+                copiedVoxel.ZOrderPosition = ZOrders[i];
+                voxelBatchB[firstCopiedVoxel + blockStart + i] = copiedVoxel;
+            }
+        }
+    }
 
-            projv::Voxel copiedVoxel = voxelBatchA[i];
-            copiedVoxel.ZOrderPosition = newZOrderPosition;
-            voxelBatchB.emplace_back(copiedVoxel);
+    ColumnarVoxelBatch createColumnarVoxelBatch(const VoxelBatch& voxelBatch) {
+        ColumnarVoxelBatch columnarVoxelBatch;
+        columnarVoxelBatch.ZOrderPositions.resize(voxelBatch.size());
+        columnarVoxelBatch.colors.resize(voxelBatch.size());
+        for(size_t i = 0; i < voxelBatch.size(); i++) {
+            columnarVoxelBatch.ZOrderPositions[i] = voxelBatch[i].ZOrderPosition;
+            columnarVoxelBatch.colors[i] = voxelBatch[i].color;
         }
+        return columnarVoxelBatch;
+    }
+
+    VoxelBatch createVoxelBatchFromColumnarVoxelBatch(const ColumnarVoxelBatch& columnarVoxelBatch) {
+        VoxelBatch voxelBatch(columnarVoxelBatch.ZOrderPositions.size());
+        for(size_t i = 0; i < voxelBatch.size(); i++) {
+            voxelBatch[i].ZOrderPosition = columnarVoxelBatch.ZOrderPositions[i];
+            voxelBatch[i].color = columnarVoxelBatch.colors[i];
+        }
+        return voxelBatch;
+    }
+
+    void moveVoxelBatchToChunk(const ColumnarVoxelBatch& columnarVoxelBatch, Chunk& chunk) {
+        chunk.chunkQueue = createVoxelBatchFromColumnarVoxelBatch(columnarVoxelBatch);
+    }
+
+    void addVoxelBatchAToVoxelBatchB(const ColumnarVoxelBatch& voxelBatchA, ColumnarVoxelBatch& voxelBatchB, core::ivec3 voxelBatchAPosition) {
+        size_t firstCopiedVoxel = voxelBatchB.ZOrderPositions.size();
+        size_t copiedVoxels = voxelBatchA.ZOrderPositions.size();
+        voxelBatchB.ZOrderPositions.resize(firstCopiedVoxel + copiedVoxels);
+        translateZOrderIndexBatch(voxelBatchA.ZOrderPositions.data(), voxelBatchB.ZOrderPositions.data() + firstCopiedVoxel, copiedVoxels, voxelBatchAPosition, 511);
+        voxelBatchB.colors.insert(voxelBatchB.colors.end(), voxelBatchA.colors.begin(), voxelBatchA.colors.begin() + copiedVoxels);
+    }
+
+    // Sorts the Z-Order column alone and returns where every sorted voxel came from, so the colors are gathered once instead of moving in every pass.
+    std::vector<uint32_t> radixSortZOrderColumn(ColumnarVoxelBatch& voxelBatch, int threadCount) {
+        if(voxelBatch.ZOrderPositions.size() > UINT32_MAX) {
+            throw std::invalid_argument("radixSortVoxels: " + std::to_string(voxelBatch.ZOrderPositions.size()) + " voxels don't fit a 32 bit index");
+        }
+        std::vector<uint32_t> order(voxelBatch.ZOrderPositions.size());
+        for(size_t i = 0; i < order.size(); i++) {
+            order[i] = uint32_t(i);
+        }
+        radixSortByZOrder(voxelBatch.ZOrderPositions, [](uint32_t ZOrder) { return ZOrder; }, threadCount, &order);
+        return order;
+    }
+
+    void radixSortVoxels(ColumnarVoxelBatch& voxelBatch, int threadCount) {
+        std::vector<uint32_t> order = radixSortZOrderColumn(voxelBatch, threadCount);
+        std::vector<Color> sortedColors(order.size());
+        for(size_t i = 0; i < order.size(); i++) {
+            sortedColors[i] = voxelBatch.colors[order[i]];
+        }
+        voxelBatch.colors.swap(sortedColors);
+    }
+
+    void sortAndDeduplicateVoxels(ColumnarVoxelBatch& voxelBatch, int threadCount) {
+        std::vector<uint32_t> order = radixSortZOrderColumn(voxelBatch, threadCount);
+        // The sort is stable, so the last voxel of each run of equal Z-Orders is the last one written. Only the kept colors are gathered.
+        size_t keptVoxels = 0;
+        size_t voxelCount = voxelBatch.ZOrderPositions.size();
+        std::vector<Color> keptColors;
+        keptColors.reserve(voxelCount);
+        for(size_t i = 0; i < voxelCount; i++) {
+            if(i + 1 < voxelCount && voxelBatch.ZOrderPositions[i + 1] == voxelBatch.ZOrderPositions[i]) {
+                continue;
+            }
+            voxelBatch.ZOrderPositions[keptVoxels++] = voxelBatch.ZOrderPositions[i];
+            keptColors.emplace_back(voxelBatch.colors[order[i]]);
+        }
+        voxelBatch.ZOrderPositions.resize(keptVoxels);
+        voxelBatch.colors.swap(keptColors);
     }
 
     void sortVoxelBatch(VoxelBatch& voxelBatch) {
-        std::sort(voxelBatch.begin(), voxelBatch.end(), [](const Voxel& a, const Voxel& b) {
-            return a.ZOrderPosition < b.ZOrderPosition;
-        });
+        radixSortVoxels(voxelBatch);
         return;
     }
 
@@ -361,16 +928,8 @@ namespace projv::utils {
         // Copy chunkQueue to work on it directly
         std::vector<Voxel> voxels = chunk.chunkQueue;
 
-        // Sort by ZOrderPosition (we don't care which duplicate is kept)
-        std::sort(voxels.begin(), voxels.end(), [](const Voxel& a, const Voxel& b) {
-            return a.ZOrderPosition < b.ZOrderPosition;
-        });
-
-        // Remove duplicates: keep first occurrence after sorting
-        auto last = std::unique(voxels.begin(), voxels.end(), [](const Voxel& a, const Voxel& b) {
-            return a.ZOrderPosition == b.ZOrderPosition;
-        });
-        voxels.erase(last, voxels.end());
+        // Sort by ZOrderPosition and remove duplicates, the voxel queued last wins.
+        sortAndDeduplicateVoxels(voxels);
 
         // Assign to VoxelGrid
         voxelGrid.voxels = std::move(voxels);
@@ -395,10 +954,11 @@ namespace projv::utils {
         }
 
         // Update the chunk.
-        chunk.geometryData = createTree64(voxelGrid, resolutionToTheNearestPowOfTwo);
-        //createTree64(voxelGrid, resolutionToTheNearestPowOfTwo);
+        chunk.geometryData = createTree64Parallel(voxelGrid, resolutionToTheNearestPowOfTwo);
         chunk.voxelTypeData = createVoxelTypeData(voxelGrid);
+        chunk.nodeColorData = createTree64NodeColors(chunk.geometryData, chunk.voxelTypeData);
         chunk.LOD = 0;
+        bumpChunkRevision(chunk);
 
         chunk.header.resolution = resolutionToTheNearestPowOfTwo;
         chunk.header.scale = createChunkScaleFromVoxelScaleAndResolution(chunk.header.voxelScale, resolutionToTheNearestPowOfTwo);
@@ -411,44 +971,260 @@ namespace projv::utils {
         return;
     }
 
-    void removeVoxelBatchAFromVoxelBatchB(VoxelBatch& voxelBatchA, VoxelBatch& voxelBatchB, core::ivec3 positionOffset) {
+    void applyVoxelEditsToChunk(Chunk& chunk, const VoxelBatch& voxelsToSet, const VoxelBatch& voxelsToClear) {
+        if(chunk.LOD != 0) {
+            throw std::invalid_argument("applyVoxelEditsToChunk: Chunk " + std::to_string(chunk.header.chunkID) + " is at LOD " + std::to_string(chunk.LOD) + ", edits can only be applied at LOD 0");
+        }
+        if(!hasSingleTree64Root(int(chunk.header.resolution))) {
+            throw std::invalid_argument("applyVoxelEditsToChunk: Chunk " + std::to_string(chunk.header.chunkID) + " has resolution " + std::to_string(chunk.header.resolution) +
+                                        ", edits need a power of 4 resolution (a tree64 with a single root). Rebuild it with updateChunkFromItsVoxelBatch instead");
+        }
         auto start = std::chrono::high_resolution_clock::now();
-    
-        constexpr size_t ZORDER_RANGE = 512 * 512 * 512; // 134217728
-        std::vector<bool> zOrderMask(ZORDER_RANGE, false); // Bitmask for A's Z-order positions
-    
-        // Preprocessing voxelBatchA
-        auto loopStart = std::chrono::high_resolution_clock::now();
-    
-        for (const auto& voxelA : voxelBatchA) {
-            core::ivec3 adjustedPosition = reverseZOrderIndex(voxelA.ZOrderPosition);
-            uint32_t adjustedZOrderIndex = createZOrderIndex(adjustedPosition + positionOffset);
-            zOrderMask[adjustedZOrderIndex] = true; // Mark this index as to-remove
+        int resolution = chunk.header.resolution;
+        int levelsOfDepth = getTree64LevelsOfDepth(resolution);
+
+        // Validate everything first so a bad voxel doesn't leave the chunk half edited.
+        auto validate = [&](const VoxelBatch& voxels) {
+            for(size_t i = 0; i < voxels.size(); i++) {
+                core::ivec3 position = reverseZOrderIndex(voxels[i].ZOrderPosition);
+                if(std::max({position.x, position.y, position.z}) >= resolution || (uint64_t(voxels[i].ZOrderPosition) >> (6 * levelsOfDepth)) != 0) {
+                    throw std::invalid_argument("applyVoxelEditsToChunk: Voxel at (" + std::to_string(position.x) + ", " + std::to_string(position.y) + ", " + std::to_string(position.z) + ") lies outside of chunk " + std::to_string(chunk.header.chunkID) + " with resolution " + std::to_string(resolution));
+                }
+            }
+        };
+        validate(voxelsToClear);
+        validate(voxelsToSet);
+
+        // Node colors are spliced with the nodes, then only the ones on the edited paths are recomputed.
+        bool updateNodeColors = chunk.nodeColorData.size() * 3 == chunk.geometryData.size();
+        std::vector<uint32_t>* nodeColors = updateNodeColors ? &chunk.nodeColorData : nullptr;
+        std::vector<uint32_t> editedZOrders;
+        editedZOrders.reserve(updateNodeColors ? voxelsToClear.size() + voxelsToSet.size() : 0);
+
+        size_t clearedVoxels = 0;
+        for(size_t i = 0; i < voxelsToClear.size(); i++) {
+            if(clearVoxelInTree64(chunk.geometryData, resolution, voxelsToClear[i].ZOrderPosition, nodeColors)) {
+                eraseVoxelFromVoxelTypeData(chunk.voxelTypeData, voxelsToClear[i].ZOrderPosition);
+                clearedVoxels++;
+                if(updateNodeColors) {
+                    editedZOrders.emplace_back(voxelsToClear[i].ZOrderPosition);
+                }
+            }
         }
-    
-        auto loopEnd = std::chrono::high_resolution_clock::now();
-        double loopElapsed = std::chrono::duration<double, std::milli>(loopEnd - loopStart).count();
-        core::info("Time spent processing voxelBatchA: " + std::to_string(loopElapsed) + "ms");
-    
-        // filtering voxelBatchB
-        auto filterStart = std::chrono::high_resolution_clock::now();
-    
-        size_t index = 0;
-        for (size_t i = 0; i < voxelBatchB.size(); ++i) {
-            uint32_t zIndex = voxelBatchB[i].ZOrderPosition;
-            if (zIndex >= ZORDER_RANGE || !zOrderMask[zIndex]) {
-                voxelBatchB[index++] = voxelBatchB[i];
+        for(size_t i = 0; i < voxelsToSet.size(); i++) {
+            setVoxelInTree64(chunk.geometryData, resolution, voxelsToSet[i].ZOrderPosition, nodeColors);
+            setVoxelInVoxelTypeData(chunk.voxelTypeData, voxelsToSet[i]);
+            if(updateNodeColors) {
+                editedZOrders.emplace_back(voxelsToSet[i].ZOrderPosition);
             }
         }
-        voxelBatchB.resize(index);
-    
-        auto filterEnd = std::chrono::high_resolution_clock::now();
-        double filterElapsed = std::chrono::duration<double, std::milli>(filterEnd - filterStart).count();
-        core::info("Time spent filtering voxelBatchB: " + std::to_string(filterElapsed) + "ms");
-    
+        if(updateNodeColors) {
+            updateTree64NodeColors(chunk.geometryData, chunk.voxelTypeData, levelsOfDepth, editedZOrders, chunk.nodeColorData);
+        } else if(!chunk.nodeColorData.empty()) { // Colors that didn't match the nodes can't be updated, only rebuilt.
+            chunk.nodeColorData = createTree64NodeColors(chunk.geometryData, chunk.voxelTypeData);
+        }
+        bumpChunkRevision(chunk);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("applyVoxelEditsToChunk: Applied {} sets and {} clears to chunk {} in {:.2f}ms", voxelsToSet.size(), clearedVoxels, chunk.header.chunkID, elapsed);
+    }
+
+    // Moves Z-Orders by offset and calls keep(index, movedZOrder) for every one that stays inside the Z-Order range (0-1023 per axis).
+    template <typename Keep>
+    void forEachMovedZOrder(const uint32_t* ZOrders, size_t count, core::ivec3 offset, Keep keep) {
+        constexpr size_t BLOCK_SIZE = 4096;
+        std::vector<core::ivec3> positions(std::min(BLOCK_SIZE, count));
+        std::vector<uint32_t> movedZOrders(positions.size());
+        for(size_t blockStart = 0; blockStart < count; blockStart += BLOCK_SIZE) {
+            size_t blockSize = std::min(BLOCK_SIZE, count - blockStart);
+            reverseZOrderIndexBatch(ZOrders + blockStart, positions.data(), blockSize);
+            for(size_t i = 0; i < blockSize; i++) {
+                positions[i] = positions[i] + offset;
+            }
+            createZOrderIndexBatch(positions.data(), movedZOrders.data(), blockSize);
+            for(size_t i = 0; i < blockSize; i++) {
+                core::ivec3 position = positions[i];
+                if(std::min({position.x, position.y, position.z}) < 0 || std::max({position.x, position.y, position.z}) > 1023) {
+                    continue;
+                }
+                keep(blockStart + i, movedZOrders[i]);
+            }
+        }
+    }
+
+    // Returns the Z-Orders moved by offset, sorted and without duplicates.
+    std::vector<uint32_t> createMovedSortedZOrders(const uint32_t* ZOrders, size_t count, core::ivec3 offset) {
+        std::vector<uint32_t> movedZOrders;
+        movedZOrders.reserve(count);
+        forEachMovedZOrder(ZOrders, count, offset, [&](size_t, uint32_t movedZOrder) {
+            movedZOrders.emplace_back(movedZOrder);
+        });
+        radixSortByZOrder(movedZOrders, [](uint32_t ZOrder) { return ZOrder; }, 0);
+        movedZOrders.erase(std::unique(movedZOrders.begin(), movedZOrders.end()), movedZOrders.end());
+        return movedZOrders;
+    }
+
+    // Compacts the elements of a batch whose Z-Order isn't in sortedZOrdersToRemove, keeping their order. moveElement(from, to) moves one element.
+    // A sorted batch is walked alongside the removed Z-Orders in linear time, an unsorted one falls back to a binary search per element.
+    template <typename GetZOrder, typename MoveElement>
+    size_t removeZOrdersFromBatch(size_t count, const std::vector<uint32_t>& sortedZOrdersToRemove, GetZOrder getZOrder, MoveElement moveElement) {
+        bool sorted = true;
+        for(size_t i = 1; i < count && sorted; i++) {
+            sorted = getZOrder(i - 1) <= getZOrder(i);
+        }
+        size_t keptElements = 0;
+        size_t removedIndex = 0;
+        for(size_t i = 0; i < count; i++) {
+            uint32_t ZOrder = getZOrder(i);
+            bool removed;
+            if(sorted) {
+                while(removedIndex < sortedZOrdersToRemove.size() && sortedZOrdersToRemove[removedIndex] < ZOrder) {
+                    removedIndex++;
+                }
+                removed = removedIndex < sortedZOrdersToRemove.size() && sortedZOrdersToRemove[removedIndex] == ZOrder;
+            } else {
+                removed = std::binary_search(sortedZOrdersToRemove.begin(), sortedZOrdersToRemove.end(), ZOrder);
+            }
+            if(!removed) {
+                moveElement(i, keptElements++);
+            }
+        }
+        return keptElements;
+    }
+
+    void removeVoxelBatchAFromVoxelBatchB(VoxelBatch& voxelBatchA, VoxelBatch& voxelBatchB, core::ivec3 positionOffset) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<uint32_t> ZOrdersA(voxelBatchA.size());
+        for(size_t i = 0; i < voxelBatchA.size(); i++) {
+            ZOrdersA[i] = voxelBatchA[i].ZOrderPosition;
+        }
+        std::vector<uint32_t> ZOrdersToRemove = createMovedSortedZOrders(ZOrdersA.data(), ZOrdersA.size(), positionOffset);
+
+        size_t keptVoxels = removeZOrdersFromBatch(voxelBatchB.size(), ZOrdersToRemove,
+            [&](size_t i) { return voxelBatchB[i].ZOrderPosition; },
+            [&](size_t from, size_t to) { voxelBatchB[to] = voxelBatchB[from]; });
+        size_t removedVoxels = voxelBatchB.size() - keptVoxels;
+        voxelBatchB.resize(keptVoxels);
+
         auto end = std::chrono::high_resolution_clock::now();
         double totalElapsed = std::chrono::duration<double, std::milli>(end - start).count();
-        core::info("Function: removeVoxelBatchAFromVoxelBatchB. Time taken: " + std::to_string(totalElapsed) + "ms");
+        core::info("removeVoxelBatchAFromVoxelBatchB: Removed {} voxels in {:.2f}ms", removedVoxels, totalElapsed);
+    }
+
+    void removeVoxelBatchAFromVoxelBatchB(const ColumnarVoxelBatch& voxelBatchA, ColumnarVoxelBatch& voxelBatchB, core::ivec3 positionOffset) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<uint32_t> ZOrdersToRemove = createMovedSortedZOrders(voxelBatchA.ZOrderPositions.data(), voxelBatchA.ZOrderPositions.size(), positionOffset);
+
+        size_t keptVoxels = removeZOrdersFromBatch(voxelBatchB.ZOrderPositions.size(), ZOrdersToRemove,
+            [&](size_t i) { return voxelBatchB.ZOrderPositions[i]; },
+            [&](size_t from, size_t to) {
+                voxelBatchB.ZOrderPositions[to] = voxelBatchB.ZOrderPositions[from];
+                voxelBatchB.colors[to] = voxelBatchB.colors[from];
+            });
+        size_t removedVoxels = voxelBatchB.ZOrderPositions.size() - keptVoxels;
+        voxelBatchB.ZOrderPositions.resize(keptVoxels);
+        voxelBatchB.colors.resize(keptVoxels);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double totalElapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("removeVoxelBatchAFromVoxelBatchB: Removed {} voxels from columnar batch in {:.2f}ms", removedVoxels, totalElapsed);
+    }
+
+    VoxelBatch createMovedVoxelBatch(const VoxelBatch& voxelBatch, core::ivec3 offset) {
+        std::vector<uint32_t> ZOrders(voxelBatch.size());
+        for(size_t i = 0; i < voxelBatch.size(); i++) {
+            ZOrders[i] = voxelBatch[i].ZOrderPosition;
+        }
+        VoxelBatch movedVoxelBatch;
+        movedVoxelBatch.reserve(voxelBatch.size());
+        forEachMovedZOrder(ZOrders.data(), ZOrders.size(), offset, [&](size_t index, uint32_t movedZOrder) {
+            Voxel movedVoxel = voxelBatch[index];
+            movedVoxel.ZOrderPosition = movedZOrder;
+            movedVoxelBatch.emplace_back(movedVoxel);
+        });
+        radixSortVoxels(movedVoxelBatch);
+        return movedVoxelBatch;
+    }
+
+    VoxelBatch createVoxelBatchUnion(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, VoxelColorPrecedence colorPrecedence, core::ivec3 voxelBatchBOffset) {
+        VoxelBatch movedVoxelBatchB;
+        if(voxelBatchBOffset != core::ivec3(0)) {
+            movedVoxelBatchB = createMovedVoxelBatch(voxelBatchB, voxelBatchBOffset);
+        }
+        const VoxelBatch& batchB = voxelBatchBOffset != core::ivec3(0) ? movedVoxelBatchB : voxelBatchB;
+
+        VoxelBatch unionBatch;
+        unionBatch.reserve(voxelBatchA.size() + batchB.size());
+        size_t indexA = 0;
+        size_t indexB = 0;
+        while(indexA < voxelBatchA.size() && indexB < batchB.size()) {
+            uint32_t ZOrderA = voxelBatchA[indexA].ZOrderPosition;
+            uint32_t ZOrderB = batchB[indexB].ZOrderPosition;
+            if(ZOrderA < ZOrderB) {
+                unionBatch.emplace_back(voxelBatchA[indexA++]);
+            } else if(ZOrderB < ZOrderA) {
+                unionBatch.emplace_back(batchB[indexB++]);
+            } else {
+                unionBatch.emplace_back(colorPrecedence == VoxelColorPrecedence::KeepA ? voxelBatchA[indexA] : batchB[indexB]);
+                indexA++;
+                indexB++;
+            }
+        }
+        unionBatch.insert(unionBatch.end(), voxelBatchA.begin() + indexA, voxelBatchA.end());
+        unionBatch.insert(unionBatch.end(), batchB.begin() + indexB, batchB.end());
+        return unionBatch;
+    }
+
+    VoxelBatch createVoxelBatchDifference(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, core::ivec3 voxelBatchBOffset) {
+        VoxelBatch movedVoxelBatchB;
+        if(voxelBatchBOffset != core::ivec3(0)) {
+            movedVoxelBatchB = createMovedVoxelBatch(voxelBatchB, voxelBatchBOffset);
+        }
+        const VoxelBatch& batchB = voxelBatchBOffset != core::ivec3(0) ? movedVoxelBatchB : voxelBatchB;
+
+        VoxelBatch differenceBatch;
+        differenceBatch.reserve(voxelBatchA.size());
+        size_t indexB = 0;
+        for(size_t indexA = 0; indexA < voxelBatchA.size(); indexA++) {
+            uint32_t ZOrderA = voxelBatchA[indexA].ZOrderPosition;
+            while(indexB < batchB.size() && batchB[indexB].ZOrderPosition < ZOrderA) {
+                indexB++;
+            }
+            if(indexB < batchB.size() && batchB[indexB].ZOrderPosition == ZOrderA) {
+                continue;
+            }
+            differenceBatch.emplace_back(voxelBatchA[indexA]);
+        }
+        return differenceBatch;
+    }
+
+    VoxelBatch createVoxelBatchIntersection(const VoxelBatch& voxelBatchA, const VoxelBatch& voxelBatchB, VoxelColorPrecedence colorPrecedence, core::ivec3 voxelBatchBOffset) {
+        VoxelBatch movedVoxelBatchB;
+        if(voxelBatchBOffset != core::ivec3(0)) {
+            movedVoxelBatchB = createMovedVoxelBatch(voxelBatchB, voxelBatchBOffset);
+        }
+        const VoxelBatch& batchB = voxelBatchBOffset != core::ivec3(0) ? movedVoxelBatchB : voxelBatchB;
+
+        VoxelBatch intersectionBatch;
+        size_t indexA = 0;
+        size_t indexB = 0;
+        while(indexA < voxelBatchA.size() && indexB < batchB.size()) {
+            uint32_t ZOrderA = voxelBatchA[indexA].ZOrderPosition;
+            uint32_t ZOrderB = batchB[indexB].ZOrderPosition;
+            if(ZOrderA < ZOrderB) {
+                indexA++;
+            } else if(ZOrderB < ZOrderA) {
+                indexB++;
+            } else {
+                intersectionBatch.emplace_back(colorPrecedence == VoxelColorPrecedence::KeepA ? voxelBatchA[indexA] : batchB[indexB]);
+                indexA++;
+                indexB++;
+            }
+        }
+        return intersectionBatch;
     }
     
     Voxel createVoxel(Color color, core::ivec3 position) {
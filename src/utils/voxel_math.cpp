@@ -1,6 +1,14 @@
 #include "core/log.h"
 #include "utils/voxel_math.h"
 
+// x86 kernels are compiled with per function target attributes and picked at runtime, so no global -mavx2/-mbmi2 is needed.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PROJV_Z_ORDER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define PROJV_Z_ORDER_X86_KERNELS 0
+#endif
+
 namespace projv::utils {
     uint32_t convertVec3ToHeaderPosition(core::ivec3 vec3) {
         return (vec3.x & 0x3FF) | ((vec3.y & 0x3FF) << 10) | ((vec3.z & 0x3FF) << 20);
@@ -27,34 +35,209 @@ namespace projv::utils {
         return z_order;
     }
 
-    // 1 is x, 2 is y, 3 is z.
-    std::array<uint32_t, 512> precalculateArray(int axis) {
-        std::array<uint32_t, 512> LUT;
-        for(int i = 0; i < 512; i++) {
-            core::ivec3 position{ 0, 0, 0};
-            switch (axis) {
-                case 1:
-                    position.x = i;
-                    break;
-                case 2:
-                    position.y = i;
-                    break;
-                case 3:
-                    position.z = i;
-                    break;
-            }
+    // Spreads the low 10 bits of value so there are two zero bits between each of them.
+    constexpr uint32_t spreadBitsBy3(uint32_t value) {
+        value &= 0x3FF;
+        value = (value | (value << 16)) & 0x030000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    // Inverse of spreadBitsBy3, gathers every third bit of value into the low 10 bits.
+    constexpr uint32_t compactBitsBy3(uint32_t value) {
+        value &= 0x09249249;
+        value = (value ^ (value >> 2)) & 0x030C30C3;
+        value = (value ^ (value >> 4)) & 0x0300F00F;
+        value = (value ^ (value >> 8)) & 0x030000FF;
+        value = (value ^ (value >> 16)) & 0x3FF;
+        return value;
+    }
 
-            LUT[i] = createZOrderIndexNOLUT(position, 9);
+    // 0 is x, 1 is y, 2 is z.
+    constexpr std::array<uint32_t, 512> precalculateArray(int axis) {
+        std::array<uint32_t, 512> LUT{};
+        for(uint32_t i = 0; i < 512; i++) {
+            LUT[i] = spreadBitsBy3(i) << axis;
         }
         return LUT;
     }
 
+    // Built at compile time, so lookups don't go through a static initialization guard.
+    constexpr std::array<uint32_t, 512> Z_ORDER_X_LUT = precalculateArray(0);
+    constexpr std::array<uint32_t, 512> Z_ORDER_Y_LUT = precalculateArray(1);
+    constexpr std::array<uint32_t, 512> Z_ORDER_Z_LUT = precalculateArray(2);
+    static_assert(Z_ORDER_X_LUT[511] == 0b001001001001001001001001001, "Z-Order LUT must match createZOrderIndexNOLUT");
+    static_assert(Z_ORDER_Z_LUT[1] == 0b100, "Z-Order LUT must match createZOrderIndexNOLUT");
+
     uint64_t createZOrderIndex(core::ivec3 vec3){
-        static std::array<uint32_t, 512> xArray = precalculateArray(1);
-        static std::array<uint32_t, 512> yArray = precalculateArray(2);
-        static std::array<uint32_t, 512> zArray = precalculateArray(3);
+        return Z_ORDER_X_LUT[vec3.x] + Z_ORDER_Y_LUT[vec3.y] + Z_ORDER_Z_LUT[vec3.z];
+    }
+
+    static_assert(sizeof(core::ivec3) == 3 * sizeof(int32_t), "Batch Z-Order kernels expect tightly packed ivec3's");
+
+    void createZOrderIndexBatchScalar(const core::ivec3* positions, uint32_t* zOrders, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            zOrders[i] = spreadBitsBy3(positions[i].x) | (spreadBitsBy3(positions[i].y) << 1) | (spreadBitsBy3(positions[i].z) << 2);
+        }
+    }
+
+    void reverseZOrderIndexBatchScalar(const uint32_t* zOrders, core::ivec3* positions, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            positions[i] = core::ivec3(compactBitsBy3(zOrders[i]), compactBitsBy3(zOrders[i] >> 1), compactBitsBy3(zOrders[i] >> 2));
+        }
+    }
+
+    void translateZOrderIndexBatchScalar(const uint32_t* zOrders, uint32_t* translatedZOrders, size_t count, core::ivec3 offset, int maxCoordinate) {
+        for(size_t i = 0; i < count; i++) {
+            int x = std::clamp(int(compactBitsBy3(zOrders[i])) + offset.x, 0, maxCoordinate);
+            int y = std::clamp(int(compactBitsBy3(zOrders[i] >> 1)) + offset.y, 0, maxCoordinate);
+            int z = std::clamp(int(compactBitsBy3(zOrders[i] >> 2)) + offset.z, 0, maxCoordinate);
+            translatedZOrders[i] = spreadBitsBy3(x) | (spreadBitsBy3(y) << 1) | (spreadBitsBy3(z) << 2);
+        }
+    }
+
+#if PROJV_Z_ORDER_X86_KERNELS
+    __attribute__((target("bmi2")))
+    void translateZOrderIndexBatchBMI2(const uint32_t* zOrders, uint32_t* translatedZOrders, size_t count, core::ivec3 offset, int maxCoordinate) {
+        for(size_t i = 0; i < count; i++) {
+            int x = std::clamp(int(_pext_u32(zOrders[i], 0x09249249)) + offset.x, 0, maxCoordinate);
+            int y = std::clamp(int(_pext_u32(zOrders[i], 0x12492492)) + offset.y, 0, maxCoordinate);
+            int z = std::clamp(int(_pext_u32(zOrders[i], 0x24924924)) + offset.z, 0, maxCoordinate);
+            translatedZOrders[i] = _pdep_u32(x, 0x09249249) | _pdep_u32(y, 0x12492492) | _pdep_u32(z, 0x24924924);
+        }
+    }
+
+    __attribute__((target("bmi2")))
+    void createZOrderIndexBatchBMI2(const core::ivec3* positions, uint32_t* zOrders, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            zOrders[i] = _pdep_u32(positions[i].x & 0x3FF, 0x09249249) | _pdep_u32(positions[i].y & 0x3FF, 0x12492492) | _pdep_u32(positions[i].z & 0x3FF, 0x24924924);
+        }
+    }
+
+    __attribute__((target("bmi2")))
+    void reverseZOrderIndexBatchBMI2(const uint32_t* zOrders, core::ivec3* positions, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            positions[i] = core::ivec3(_pext_u32(zOrders[i], 0x09249249), _pext_u32(zOrders[i], 0x12492492), _pext_u32(zOrders[i], 0x24924924));
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i spreadBitsBy3AVX2(__m256i value) {
+        value = _mm256_and_si256(value, _mm256_set1_epi32(0x3FF));
+        value = _mm256_and_si256(_mm256_or_si256(value, _mm256_slli_epi32(value, 16)), _mm256_set1_epi32(0x030000FF));
+        value = _mm256_and_si256(_mm256_or_si256(value, _mm256_slli_epi32(value, 8)), _mm256_set1_epi32(0x0300F00F));
+        value = _mm256_and_si256(_mm256_or_si256(value, _mm256_slli_epi32(value, 4)), _mm256_set1_epi32(0x030C30C3));
+        value = _mm256_and_si256(_mm256_or_si256(value, _mm256_slli_epi32(value, 2)), _mm256_set1_epi32(0x09249249));
+        return value;
+    }
 
-        return xArray[vec3.x] + yArray[vec3.y] + zArray[vec3.z];
+    __attribute__((target("avx2")))
+    inline __m256i compactBitsBy3AVX2(__m256i value) {
+        value = _mm256_and_si256(value, _mm256_set1_epi32(0x09249249));
+        value = _mm256_and_si256(_mm256_xor_si256(value, _mm256_srli_epi32(value, 2)), _mm256_set1_epi32(0x030C30C3));
+        value = _mm256_and_si256(_mm256_xor_si256(value, _mm256_srli_epi32(value, 4)), _mm256_set1_epi32(0x0300F00F));
+        value = _mm256_and_si256(_mm256_xor_si256(value, _mm256_srli_epi32(value, 8)), _mm256_set1_epi32(0x030000FF));
+        value = _mm256_and_si256(_mm256_xor_si256(value, _mm256_srli_epi32(value, 16)), _mm256_set1_epi32(0x3FF));
+        return value;
+    }
+
+    __attribute__((target("avx2")))
+    void createZOrderIndexBatchAVX2(const core::ivec3* positions, uint32_t* zOrders, size_t count) {
+        const int* components = reinterpret_cast<const int*>(positions);
+        const __m256i xIndices = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8) {
+            const int* base = components + i * 3;
+            __m256i x = _mm256_i32gather_epi32(base, xIndices, 4);
+            __m256i y = _mm256_i32gather_epi32(base + 1, xIndices, 4);
+            __m256i z = _mm256_i32gather_epi32(base + 2, xIndices, 4);
+            __m256i zOrder = _mm256_or_si256(spreadBitsBy3AVX2(x), _mm256_or_si256(_mm256_slli_epi32(spreadBitsBy3AVX2(y), 1), _mm256_slli_epi32(spreadBitsBy3AVX2(z), 2)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(zOrders + i), zOrder);
+        }
+        createZOrderIndexBatchScalar(positions + i, zOrders + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void reverseZOrderIndexBatchAVX2(const uint32_t* zOrders, core::ivec3* positions, size_t count) {
+        alignas(32) int32_t x[8];
+        alignas(32) int32_t y[8];
+        alignas(32) int32_t z[8];
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8) {
+            __m256i zOrder = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(zOrders + i));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(x), compactBitsBy3AVX2(zOrder));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(y), compactBitsBy3AVX2(_mm256_srli_epi32(zOrder, 1)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(z), compactBitsBy3AVX2(_mm256_srli_epi32(zOrder, 2)));
+            for(int lane = 0; lane < 8; lane++) {
+                positions[i + lane] = core::ivec3(x[lane], y[lane], z[lane]);
+            }
+        }
+        reverseZOrderIndexBatchScalar(zOrders + i, positions + i, count - i);
+    }
+    __attribute__((target("avx2")))
+    void translateZOrderIndexBatchAVX2(const uint32_t* zOrders, uint32_t* translatedZOrders, size_t count, core::ivec3 offset, int maxCoordinate) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i maximum = _mm256_set1_epi32(maxCoordinate);
+        const __m256i offsetX = _mm256_set1_epi32(offset.x);
+        const __m256i offsetY = _mm256_set1_epi32(offset.y);
+        const __m256i offsetZ = _mm256_set1_epi32(offset.z);
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8) {
+            __m256i zOrder = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(zOrders + i));
+            __m256i x = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(compactBitsBy3AVX2(zOrder), offsetX), zero), maximum);
+            __m256i y = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(compactBitsBy3AVX2(_mm256_srli_epi32(zOrder, 1)), offsetY), zero), maximum);
+            __m256i z = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(compactBitsBy3AVX2(_mm256_srli_epi32(zOrder, 2)), offsetZ), zero), maximum);
+            zOrder = _mm256_or_si256(spreadBitsBy3AVX2(x), _mm256_or_si256(_mm256_slli_epi32(spreadBitsBy3AVX2(y), 1), _mm256_slli_epi32(spreadBitsBy3AVX2(z), 2)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(translatedZOrders + i), zOrder);
+        }
+        translateZOrderIndexBatchScalar(zOrders + i, translatedZOrders + i, count - i, offset, maxCoordinate);
+    }
+#endif
+
+    using CreateZOrderIndexBatchKernel = void (*)(const core::ivec3*, uint32_t*, size_t);
+    using ReverseZOrderIndexBatchKernel = void (*)(const uint32_t*, core::ivec3*, size_t);
+    using TranslateZOrderIndexBatchKernel = void (*)(const uint32_t*, uint32_t*, size_t, core::ivec3, int);
+
+    struct ZOrderBatchKernels {
+        CreateZOrderIndexBatchKernel create;
+        ReverseZOrderIndexBatchKernel reverse;
+        TranslateZOrderIndexBatchKernel translate;
+        const char* name;
+    };
+
+    // AVX2 handles 8 voxels at once. pdep/pext only win over the scalar shifts when AVX2 is missing (and are microcoded on AMD before Zen 3).
+    ZOrderBatchKernels selectZOrderBatchKernels() {
+#if PROJV_Z_ORDER_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return {createZOrderIndexBatchAVX2, reverseZOrderIndexBatchAVX2, translateZOrderIndexBatchAVX2, "AVX2"};
+        }
+        if(__builtin_cpu_supports("bmi2")) {
+            return {createZOrderIndexBatchBMI2, reverseZOrderIndexBatchBMI2, translateZOrderIndexBatchBMI2, "BMI2"};
+        }
+#endif
+        return {createZOrderIndexBatchScalar, reverseZOrderIndexBatchScalar, translateZOrderIndexBatchScalar, "scalar"};
+    }
+
+    // Selected once when the library loads.
+    const ZOrderBatchKernels Z_ORDER_BATCH_KERNELS = selectZOrderBatchKernels();
+
+    void createZOrderIndexBatch(const core::ivec3* positions, uint32_t* zOrders, size_t count) {
+        Z_ORDER_BATCH_KERNELS.create(positions, zOrders, count);
+    }
+
+    void reverseZOrderIndexBatch(const uint32_t* zOrders, core::ivec3* positions, size_t count) {
+        Z_ORDER_BATCH_KERNELS.reverse(zOrders, positions, count);
+    }
+
+    void translateZOrderIndexBatch(const uint32_t* zOrders, uint32_t* translatedZOrders, size_t count, core::ivec3 offset, int maxCoordinate) {
+        Z_ORDER_BATCH_KERNELS.translate(zOrders, translatedZOrders, count, offset, maxCoordinate);
+    }
+
+    const char* getZOrderBatchKernelName() {
+        return Z_ORDER_BATCH_KERNELS.name;
     }
 
     std::unordered_map<uint32_t, uint16_t> createReverseLUT(const std::array<uint32_t, 512>& forwardArray) {
@@ -67,15 +250,10 @@ namespace projv::utils {
     };
 
     core::ivec3 reverseZOrderIndex2(uint64_t z_order) {
-        // Forward LUTs
-        static std::array<uint32_t, 512> xArray = precalculateArray(1);
-        static std::array<uint32_t, 512> yArray = precalculateArray(2);
-        static std::array<uint32_t, 512> zArray = precalculateArray(3);
-
         // Reverse LUTs (maps partial z_order  -> coordinate)
-        static std::unordered_map<uint32_t, uint16_t> revXArray = createReverseLUT(xArray);
-        static std::unordered_map<uint32_t, uint16_t> revYArray = createReverseLUT(yArray);
-        static std::unordered_map<uint32_t, uint16_t> revZArray = createReverseLUT(zArray);
+        static std::unordered_map<uint32_t, uint16_t> revXArray = createReverseLUT(Z_ORDER_X_LUT);
+        static std::unordered_map<uint32_t, uint16_t> revYArray = createReverseLUT(Z_ORDER_Y_LUT);
+        static std::unordered_map<uint32_t, uint16_t> revZArray = createReverseLUT(Z_ORDER_Z_LUT);
 
         core::ivec3 coordinate;
         uint32_t xMasked = z_order & 0b100100100100100100100100100;
@@ -108,4 +286,342 @@ namespace projv::utils {
         };
     }
 
+    VoxelRegion createBoxVoxelRegion(core::vec3 boundsMin, core::vec3 boundsMax) {
+        VoxelRegion region = {};
+        region.shape = VoxelRegionShape::Box;
+        region.boundsMin = boundsMin;
+        region.boundsMax = boundsMax;
+        return region;
+    }
+
+    VoxelRegion createSphereVoxelRegion(core::vec3 center, float radius) {
+        VoxelRegion region = {};
+        region.shape = VoxelRegionShape::Sphere;
+        region.center = center;
+        region.radius = radius;
+        return region;
+    }
+
+    VoxelRegion createFrustumVoxelRegion(const core::mat4& viewProjection, bool homogeneousDepth) {
+        // Gribb and Hartmann, every plane is the last row of the matrix plus or minus one of the others.
+        core::vec4 rows[4];
+        for(int row = 0; row < 4; row++) {
+            rows[row] = core::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+        }
+        VoxelRegion region = {};
+        region.shape = VoxelRegionShape::Frustum;
+        region.planes[0] = rows[3] + rows[0]; // Left
+        region.planes[1] = rows[3] - rows[0]; // Right
+        region.planes[2] = rows[3] + rows[1]; // Bottom
+        region.planes[3] = rows[3] - rows[1]; // Top
+        region.planes[4] = homogeneousDepth ? rows[3] + rows[2] : rows[2]; // Near
+        region.planes[5] = rows[3] - rows[2]; // Far
+        for(core::vec4& plane : region.planes) {
+            plane = plane / core::length(core::vec3(plane.x, plane.y, plane.z));
+        }
+        return region;
+    }
+
+    VoxelRegion transformVoxelRegionToGrid(const VoxelRegion& region, core::vec3 chunkPosition, float voxelSize) {
+        VoxelRegion gridRegion = region;
+        gridRegion.boundsMin = (region.boundsMin - chunkPosition) / voxelSize;
+        gridRegion.boundsMax = (region.boundsMax - chunkPosition) / voxelSize;
+        gridRegion.center = (region.center - chunkPosition) / voxelSize;
+        gridRegion.radius = region.radius / voxelSize;
+        for(core::vec4& plane : gridRegion.planes) {
+            // n . (chunkPosition + p * voxelSize) + d = (n * voxelSize) . p + (n . chunkPosition + d)
+            core::vec3 normal(plane.x, plane.y, plane.z);
+            plane = core::vec4(normal * voxelSize, core::dot(normal, chunkPosition) + plane.w);
+        }
+        return gridRegion;
+    }
+
+    VoxelRegionOverlap classifyBoundsInVoxelRegion(const VoxelRegion& region, core::vec3 boundsMin, core::vec3 boundsMax) {
+        switch(region.shape) {
+            case VoxelRegionShape::Box: {
+                bool inside = true;
+                for(int axis = 0; axis < 3; axis++) {
+                    if(boundsMax[axis] <= region.boundsMin[axis] || boundsMin[axis] >= region.boundsMax[axis]) {
+                        return VoxelRegionOverlap::Outside;
+                    }
+                    inside &= boundsMin[axis] >= region.boundsMin[axis] && boundsMax[axis] <= region.boundsMax[axis];
+                }
+                return inside ? VoxelRegionOverlap::Inside : VoxelRegionOverlap::Partial;
+            }
+            case VoxelRegionShape::Sphere: {
+                float nearestDistanceSquared = 0.0f;
+                float farthestDistanceSquared = 0.0f;
+                for(int axis = 0; axis < 3; axis++) {
+                    float nearest = std::clamp(region.center[axis], boundsMin[axis], boundsMax[axis]) - region.center[axis];
+                    float farthest = std::max(fabsf(boundsMin[axis] - region.center[axis]), fabsf(boundsMax[axis] - region.center[axis]));
+                    nearestDistanceSquared += nearest * nearest;
+                    farthestDistanceSquared += farthest * farthest;
+                }
+                float radiusSquared = region.radius * region.radius;
+                if(nearestDistanceSquared >= radiusSquared) {
+                    return VoxelRegionOverlap::Outside;
+                }
+                return farthestDistanceSquared <= radiusSquared ? VoxelRegionOverlap::Inside : VoxelRegionOverlap::Partial;
+            }
+            case VoxelRegionShape::Frustum: {
+                bool inside = true;
+                for(const core::vec4& plane : region.planes) {
+                    // The corners farthest along and against the plane's normal.
+                    core::vec3 positiveCorner(plane.x >= 0.0f ? boundsMax.x : boundsMin.x, plane.y >= 0.0f ? boundsMax.y : boundsMin.y, plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+                    core::vec3 negativeCorner(plane.x >= 0.0f ? boundsMin.x : boundsMax.x, plane.y >= 0.0f ? boundsMin.y : boundsMax.y, plane.z >= 0.0f ? boundsMin.z : boundsMax.z);
+                    if(core::dot(core::vec3(plane.x, plane.y, plane.z), positiveCorner) + plane.w <= 0.0f) {
+                        return VoxelRegionOverlap::Outside;
+                    }
+                    inside &= core::dot(core::vec3(plane.x, plane.y, plane.z), negativeCorner) + plane.w >= 0.0f;
+                }
+                return inside ? VoxelRegionOverlap::Inside : VoxelRegionOverlap::Partial;
+            }
+        }
+        return VoxelRegionOverlap::Partial;
+    }
+
+    std::vector<size_t> findTree64LevelEnds(const std::vector<uint32_t>& tree64, int levelsOfDepth) {
+        std::vector<size_t> levelEnds;
+        if(tree64.empty()) {
+            return levelEnds;
+        }
+        size_t rootCount = countTree64Roots(tree64);
+        if(rootCount > 1) {
+            throw std::invalid_argument("findTree64LevelEnds: The tree64 has " + std::to_string(rootCount) + " roots, only trees of a power of 4 resolution (a single root) have levels");
+        }
+        size_t levelStart = 0;
+        size_t levelEnd = 1;
+        levelEnds.emplace_back(levelEnd);
+        for(int depth = 1; depth < levelsOfDepth; depth++) {
+            size_t nextLevelEnd = levelEnd;
+            for(size_t i = levelStart; i < levelEnd; i++) {
+                const uint32_t* node = tree64.data() + i * 3;
+                if(isTree64LeafParent(node) || getTree64ValidMask(node) == 0) {
+                    continue;
+                }
+                if(i + getTree64ChildPointer(node) != nextLevelEnd) {
+                    throw std::invalid_argument("findTree64LevelEnds: The tree64 isn't stored breadth first (see reorderTree64), node " + std::to_string(i) + " points out of the next level");
+                }
+                nextLevelEnd += __builtin_popcountll(getTree64ValidMask(node));
+            }
+            if(nextLevelEnd * 3 > tree64.size()) {
+                throw std::invalid_argument("findTree64LevelEnds: Level " + std::to_string(depth) + " ends past the end of the tree64");
+            }
+            levelStart = levelEnd;
+            levelEnd = nextLevelEnd;
+            levelEnds.emplace_back(levelEnd);
+        }
+        return levelEnds;
+    }
+
+    void truncateTree64Levels(std::vector<uint32_t>& tree64, const std::vector<size_t>& levelEnds, int keptLevels) {
+        if(tree64.empty()) {
+            return;
+        }
+        if(keptLevels < 1 || keptLevels > int(levelEnds.size())) {
+            throw std::invalid_argument("truncateTree64Levels: Can't keep " + std::to_string(keptLevels) + " of the " + std::to_string(levelEnds.size()) + " levels of the tree64");
+        }
+        size_t levelStart = keptLevels == 1 ? 0 : levelEnds[keptLevels - 2];
+        size_t levelEnd = levelEnds[keptLevels - 1];
+        tree64.resize(levelEnd * 3);
+        for(size_t i = levelStart; i < levelEnd; i++) {
+            tree64[i * 3 + 2] = 1; // Sets the leaf flag and clears the child pointer.
+        }
+    }
+
+    std::vector<uint32_t> mergeVoxelTypeDataLevels(const std::vector<uint32_t>& voxelTypeData, uint32_t removedLevels) {
+        // Every removed level drops the 6 lowest bits of the Z-Order, so the voxels of one merged voxel are next to each other.
+        uint32_t ZOrderShift = 6 * removedLevels;
+        std::vector<uint32_t> mergedVoxelTypeData;
+        size_t voxelCount = voxelTypeData.size() / 3;
+        for(size_t first = 0; first < voxelCount;) {
+            uint32_t ZOrder = ZOrderShift >= 32 ? 0 : voxelTypeData[first * 3] >> ZOrderShift;
+            uint64_t red = 0;
+            uint64_t green = 0;
+            uint64_t blue = 0;
+            size_t last = first;
+            for(; last < voxelCount && (ZOrderShift >= 32 ? 0 : voxelTypeData[last * 3] >> ZOrderShift) == ZOrder; last++) {
+                uint32_t color = voxelTypeData[last * 3 + 1];
+                red += (color >> 20) & 0x3FF;
+                green += (color >> 10) & 0x3FF;
+                blue += color & 0x3FF;
+            }
+            // Rounded like createTree64NodeColors, so a merged voxel has the color of the node it was.
+            uint64_t voxels = last - first;
+            uint64_t half = voxels / 2;
+            mergedVoxelTypeData.emplace_back(ZOrder);
+            mergedVoxelTypeData.emplace_back(uint32_t(((red + half) / voxels) << 20 | ((green + half) / voxels) << 10 | ((blue + half) / voxels)));
+            mergedVoxelTypeData.emplace_back(voxelTypeData[first * 3 + 2]);
+            first = last;
+        }
+        return mergedVoxelTypeData;
+    }
+
+    size_t countTree64Roots(const std::vector<uint32_t>& tree64) {
+        size_t nodeCount = tree64.size() / 3;
+        size_t childCount = 0;
+        for(size_t i = 0; i < nodeCount; i++) {
+            const uint32_t* node = tree64.data() + i * 3;
+            if(!isTree64LeafParent(node)) {
+                childCount += __builtin_popcountll(getTree64ValidMask(node));
+            }
+        }
+        return childCount < nodeCount ? nodeCount - childCount : 0;
+    }
+
+    struct Tree64ColorSum {
+        uint64_t red;
+        uint64_t green;
+        uint64_t blue;
+        uint64_t voxels;
+    };
+
+    // Sums the colors below a node depth first. Children are visited in Z-Order, so the voxels of each leaf parent follow the ones of the leaf parent before it.
+    Tree64ColorSum sumTree64NodeColors(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, size_t nodeIndex, uint32_t ZOrderPrefix, size_t& voxelCursor, std::vector<uint32_t>& nodeColors) {
+        Tree64ColorSum sum = {0, 0, 0, 0};
+        const uint32_t* node = tree64.data() + nodeIndex * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        if(isTree64LeafParent(node)) {
+            size_t voxelCount = voxelTypeData.size() / 3;
+            while(voxelCursor < voxelCount && (voxelTypeData[voxelCursor * 3] >> 6) < ZOrderPrefix) {
+                voxelCursor++;
+            }
+            for(; voxelCursor < voxelCount && (voxelTypeData[voxelCursor * 3] >> 6) == ZOrderPrefix; voxelCursor++) {
+                if(!isTree64ChildValid(validMask, voxelTypeData[voxelCursor * 3] & 63)) {
+                    continue;
+                }
+                uint32_t color = voxelTypeData[voxelCursor * 3 + 1];
+                sum.red += (color >> 20) & 0x3FF;
+                sum.green += (color >> 10) & 0x3FF;
+                sum.blue += color & 0x3FF;
+                sum.voxels++;
+            }
+        } else if(validMask != 0) {
+            size_t childIndex = nodeIndex + getTree64ChildPointer(node);
+            for(uint32_t zOrderInParent = 0; zOrderInParent < 64; zOrderInParent++) {
+                if(!isTree64ChildValid(validMask, zOrderInParent)) {
+                    continue;
+                }
+                if(childIndex >= nodeColors.size()) {
+                    throw std::invalid_argument("createTree64NodeColors: Node " + std::to_string(nodeIndex) + " points past the end of the tree64");
+                }
+                Tree64ColorSum childSum = sumTree64NodeColors(tree64, voxelTypeData, childIndex++, (ZOrderPrefix << 6) | zOrderInParent, voxelCursor, nodeColors);
+                sum.red += childSum.red;
+                sum.green += childSum.green;
+                sum.blue += childSum.blue;
+                sum.voxels += childSum.voxels;
+            }
+        }
+        if(sum.voxels != 0) {
+            uint64_t half = sum.voxels / 2; // Rounds to the nearest value.
+            nodeColors[nodeIndex] = uint32_t(((sum.red + half) / sum.voxels) << 20 | ((sum.green + half) / sum.voxels) << 10 | ((sum.blue + half) / sum.voxels));
+        }
+        return sum;
+    }
+
+    std::vector<uint32_t> createTree64NodeColors(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData) {
+        // The roots of a tree64 with several roots don't record which block of voxels they cover, so there is nothing to sum them from.
+        if(countTree64Roots(tree64) != 1) {
+            return {};
+        }
+        std::vector<uint32_t> nodeColors(tree64.size() / 3, 0);
+        size_t voxelCursor = 0;
+        sumTree64NodeColors(tree64, voxelTypeData, 0, 0, voxelCursor, nodeColors);
+        return nodeColors;
+    }
+
+    // The first voxel at or after a Z-Order, the voxel count if there is none.
+    size_t findFirstVoxelFromZOrder(const std::vector<uint32_t>& voxelTypeData, uint64_t ZOrder) {
+        size_t first = 0;
+        size_t count = voxelTypeData.size() / 3;
+        while(count > 0) {
+            size_t step = count / 2;
+            if(voxelTypeData[(first + step) * 3] < ZOrder) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    void addVoxelColorsToSum(const std::vector<uint32_t>& voxelTypeData, size_t firstVoxel, size_t endVoxel, Tree64ColorSum& sum) {
+        for(size_t voxel = firstVoxel; voxel < endVoxel; voxel++) {
+            uint32_t color = voxelTypeData[voxel * 3 + 1];
+            sum.red += (color >> 20) & 0x3FF;
+            sum.green += (color >> 10) & 0x3FF;
+            sum.blue += color & 0x3FF;
+        }
+        sum.voxels += endVoxel - firstVoxel;
+    }
+
+    struct Tree64PathNode {
+        size_t nodeIndex;
+        Tree64ColorSum sum;
+    };
+
+    void updateTree64NodeColors(const std::vector<uint32_t>& tree64, const std::vector<uint32_t>& voxelTypeData, int levelsOfDepth, const std::vector<uint32_t>& ZOrders, std::vector<uint32_t>& nodeColors) {
+        if(nodeColors.size() * 3 != tree64.size()) {
+            throw std::invalid_argument("updateTree64NodeColors: " + std::to_string(nodeColors.size()) + " node colors for " + std::to_string(tree64.size() / 3) + " nodes");
+        }
+        if(tree64.empty() || levelsOfDepth < 1 || levelsOfDepth > MAX_TREE64_LEVELS) {
+            return;
+        }
+
+        // The nodes on the paths per depth, by the Z-Order prefix they cover. Paths share their upper nodes, so those are only recomputed once.
+        std::vector<std::map<uint32_t, Tree64PathNode>> pathNodes(levelsOfDepth);
+        for(uint32_t ZOrder : ZOrders) {
+            size_t nodeIndex = 0;
+            for(int depth = 0; depth < levelsOfDepth; depth++) {
+                pathNodes[depth].emplace(uint32_t(uint64_t(ZOrder) >> (6 * (levelsOfDepth - depth))), Tree64PathNode{nodeIndex, {0, 0, 0, 0}});
+                const uint32_t* node = tree64.data() + nodeIndex * 3;
+                uint32_t zOrderInParent = (ZOrder >> (6 * (levelsOfDepth - 1 - depth))) & 63;
+                uint64_t validMask = getTree64ValidMask(node);
+                if(depth == levelsOfDepth - 1 || !isTree64ChildValid(validMask, zOrderInParent)) {
+                    break;
+                }
+                nodeIndex += getTree64ChildPointer(node) + countTree64SiblingsBefore(validMask, zOrderInParent);
+            }
+        }
+
+        // Bottom up, a node sums its voxels between the path nodes below it and adds their sums, so each voxel is read once per depth at most.
+        for(int depth = levelsOfDepth - 1; depth >= 0; depth--) {
+            int childShift = 6 * (levelsOfDepth - 1 - depth); // Z-Order bits below a child of a node at this depth.
+            for(auto& [prefix, pathNode] : pathNodes[depth]) {
+                Tree64ColorSum& sum = pathNode.sum;
+                uint64_t firstZOrder = uint64_t(prefix) << (childShift + 6);
+                uint64_t endZOrder = uint64_t(prefix + 1) << (childShift + 6);
+                size_t voxel = findFirstVoxelFromZOrder(voxelTypeData, firstZOrder);
+                if(depth == levelsOfDepth - 1) {
+                    // Voxels missing from the leaf parent are skipped, like createTree64NodeColors does.
+                    uint64_t validMask = getTree64ValidMask(tree64.data() + pathNode.nodeIndex * 3);
+                    size_t voxelCount = voxelTypeData.size() / 3;
+                    for(; voxel < voxelCount && voxelTypeData[voxel * 3] < endZOrder; voxel++) {
+                        if(isTree64ChildValid(validMask, voxelTypeData[voxel * 3] & 63)) {
+                            addVoxelColorsToSum(voxelTypeData, voxel, voxel + 1, sum);
+                        }
+                    }
+                } else {
+                    auto child = pathNodes[depth + 1].lower_bound(prefix << 6);
+                    for(; child != pathNodes[depth + 1].end() && (child->first >> 6) == prefix; child++) {
+                        size_t childFirstVoxel = findFirstVoxelFromZOrder(voxelTypeData, uint64_t(child->first) << childShift);
+                        addVoxelColorsToSum(voxelTypeData, voxel, childFirstVoxel, sum);
+                        sum.red += child->second.sum.red;
+                        sum.green += child->second.sum.green;
+                        sum.blue += child->second.sum.blue;
+                        sum.voxels += child->second.sum.voxels;
+                        voxel = findFirstVoxelFromZOrder(voxelTypeData, uint64_t(child->first + 1) << childShift);
+                    }
+                    addVoxelColorsToSum(voxelTypeData, voxel, findFirstVoxelFromZOrder(voxelTypeData, endZOrder), sum);
+                }
+
+                nodeColors[pathNode.nodeIndex] = 0;
+                if(sum.voxels != 0) {
+                    uint64_t half = sum.voxels / 2;
+                    nodeColors[pathNode.nodeIndex] = uint32_t(((sum.red + half) / sum.voxels) << 20 | ((sum.green + half) / sum.voxels) << 10 | ((sum.blue + half) / sum.voxels));
+                }
+            }
+        }
+    }
 }
@@ -0,0 +1,247 @@
+#include "utils/voxel_query.h"
+
+namespace projv::utils {
+    constexpr size_t MIN_QUERIES_PER_THREAD = 16384;
+
+    // Same containment test as findChunkInSceneBVH, so the cursor's chunk and the hierarchy never disagree about a position.
+    bool getVoxelPositionInChunk(const Chunk& chunk, core::vec3 worldPosition, core::ivec3& voxelPosition) {
+        int resolution = int(chunk.header.resolution);
+        for(int axis = 0; axis < 3; axis++) {
+            float chunkMin = chunk.header.position[axis];
+            float chunkMax = chunk.header.position[axis] + chunk.header.scale;
+            if(!(worldPosition[axis] >= chunkMin && worldPosition[axis] < chunkMax)) {
+                return false;
+            }
+            int voxel = int(floorf((worldPosition[axis] - chunkMin) * float(resolution) / chunk.header.scale));
+            voxelPosition[axis] = std::clamp(voxel, 0, resolution - 1);
+        }
+        return true;
+    }
+
+    // Finds the chunk and voxel at a world position, trying the cursor's chunk before the hierarchy. Returns false when no chunk contains the position.
+    bool locateVoxelInScene(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 worldPosition, VoxelQueryCursor& cursor, core::ivec3& voxelPosition) {
+        if(cursor.chunkIndex < scene.chunks.size() && getVoxelPositionInChunk(scene.chunks[cursor.chunkIndex], worldPosition, voxelPosition)) {
+            return true;
+        }
+        uint32_t chunkIndex = findChunkInSceneBVH(sceneBVH, worldPosition);
+        if(chunkIndex >= scene.chunks.size() || !getVoxelPositionInChunk(scene.chunks[chunkIndex], worldPosition, voxelPosition)) {
+            return false;
+        }
+        int levelsOfDepth = getTree64LevelsOfDepth(int(scene.chunks[chunkIndex].header.resolution));
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("isSolid/getVoxel: Resolution " + std::to_string(scene.chunks[chunkIndex].header.resolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(!hasSingleTree64Root(int(scene.chunks[chunkIndex].header.resolution))) { // Voxels outside of the first root's block would read as empty.
+            throw std::invalid_argument("isSolid/getVoxel: Chunk " + std::to_string(scene.chunks[chunkIndex].header.chunkID) + " has resolution " + std::to_string(scene.chunks[chunkIndex].header.resolution) +
+                                        ", only power of 4 resolutions can be queried");
+        }
+        cursor.chunkIndex = chunkIndex;
+        cursor.levelsOfDepth = levelsOfDepth;
+        cursor.path = Tree64Path();
+        return true;
+    }
+
+    bool isVoxelSolidTree64(const std::vector<uint32_t>& tree64, int levelsOfDepth, core::ivec3 voxelPosition, Tree64Path& path, uint32_t& ZOrder) {
+        int treeSize = 1 << (2 * levelsOfDepth);
+        if(voxelPosition.x < 0 || voxelPosition.y < 0 || voxelPosition.z < 0 || voxelPosition.x >= treeSize || voxelPosition.y >= treeSize || voxelPosition.z >= treeSize) {
+            ZOrder = 0;
+            return false;
+        }
+        ZOrder = uint32_t(createZOrderIndex(voxelPosition));
+        if(tree64.empty()) {
+            return false;
+        }
+        return descendTree64Path(tree64.data(), levelsOfDepth, path, ZOrder) == levelsOfDepth;
+    }
+
+    bool isVoxelSolidInTree64(const std::vector<uint32_t>& tree64, int gridResolution, core::ivec3 voxelPosition, Tree64Path& path) {
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("isVoxelSolidInTree64: Resolution " + std::to_string(gridResolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(!hasSingleTree64Root(gridResolution)) {
+            throw std::invalid_argument("isVoxelSolidInTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        uint32_t ZOrder;
+        return isVoxelSolidTree64(tree64, levelsOfDepth, voxelPosition, path, ZOrder);
+    }
+
+    bool isSolid(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 worldPosition, VoxelQueryCursor& cursor) {
+        core::ivec3 voxelPosition;
+        if(!locateVoxelInScene(scene, sceneBVH, worldPosition, cursor, voxelPosition)) {
+            return false;
+        }
+        uint32_t ZOrder;
+        return isVoxelSolidTree64(scene.chunks[cursor.chunkIndex].geometryData, cursor.levelsOfDepth, voxelPosition, cursor.path, ZOrder);
+    }
+
+    VoxelQueryResult getVoxel(const Scene& scene, const SceneBVH& sceneBVH, core::vec3 worldPosition, VoxelQueryCursor& cursor) {
+        VoxelQueryResult result;
+        result.solid = false;
+        result.chunkIndex = UINT32_MAX;
+        result.voxelPosition = core::ivec3(0);
+        result.ZOrder = 0;
+        result.voxelTypeDataIndex = UINT32_MAX;
+        result.color = Color{0, 0, 0};
+        if(!locateVoxelInScene(scene, sceneBVH, worldPosition, cursor, result.voxelPosition)) {
+            return result;
+        }
+        const Chunk& chunk = scene.chunks[cursor.chunkIndex];
+        result.chunkIndex = cursor.chunkIndex;
+        result.solid = isVoxelSolidTree64(chunk.geometryData, cursor.levelsOfDepth, result.voxelPosition, cursor.path, result.ZOrder);
+        if(!result.solid) {
+            return result;
+        }
+
+        const std::vector<uint32_t>& voxelTypeData = chunk.voxelTypeData;
+        size_t low = 0;
+        size_t high = voxelTypeData.size() / 3;
+        while(low < high) {
+            size_t middle = low + (high - low) / 2;
+            if(voxelTypeData[middle * 3] < result.ZOrder) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if(low < voxelTypeData.size() / 3 && voxelTypeData[low * 3] == result.ZOrder) {
+            result.voxelTypeDataIndex = uint32_t(low);
+            result.color = unserializeColor(voxelTypeData[low * 3 + 1]);
+        }
+        return result;
+    }
+
+    // Splits the queries into one contiguous run per thread, so every thread's cursor sees the positions in the order they were given.
+    // A query that throws stops its run, the first exception is rethrown on the calling thread once every run has finished.
+    template<typename QueryRun>
+    void runVoxelQueryBatch(const char* functionName, size_t count, int threadCount, QueryRun queryRun) {
+        auto start = std::chrono::high_resolution_clock::now();
+        unsigned int workerCount = threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::max<size_t>(1, std::min<size_t>(workerCount, count / MIN_QUERIES_PER_THREAD));
+        std::vector<std::exception_ptr> exceptions(workerCount);
+        auto runQueries = [&](unsigned int worker) {
+            try {
+                queryRun(count * worker / workerCount, count * (worker + 1) / workerCount);
+            } catch(...) {
+                exceptions[worker] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < workerCount; i++) {
+            workers.emplace_back(runQueries, i);
+        }
+        runQueries(0); // The calling thread works too.
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+        for(const std::exception_ptr& exception : exceptions) {
+            if(exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        core::info("{}: Queried {} positions with {} threads in {:.2f}ms ({:.2f} million queries per second)", functionName, count, workerCount, elapsed, elapsed > 0.0 ? count / elapsed / 1000.0 : 0.0);
+    }
+
+    void isSolidBatch(const Scene& scene, const SceneBVH& sceneBVH, const core::vec3* worldPositions, uint8_t* solid, size_t count, int threadCount) {
+        runVoxelQueryBatch("isSolidBatch", count, threadCount, [&](size_t first, size_t last) {
+            VoxelQueryCursor cursor;
+            for(size_t i = first; i < last; i++) {
+                solid[i] = isSolid(scene, sceneBVH, worldPositions[i], cursor) ? 1 : 0;
+            }
+        });
+    }
+
+    void getVoxelBatch(const Scene& scene, const SceneBVH& sceneBVH, const core::vec3* worldPositions, VoxelQueryResult* results, size_t count, int threadCount) {
+        runVoxelQueryBatch("getVoxelBatch", count, threadCount, [&](size_t first, size_t last) {
+            VoxelQueryCursor cursor;
+            for(size_t i = first; i < last; i++) {
+                results[i] = getVoxel(scene, sceneBVH, worldPositions[i], cursor);
+            }
+        });
+    }
+
+    struct Tree64RegionSearch { // What every node of a region search shares.
+        const uint32_t* tree64;
+        const VoxelRegion* region;
+        int level; // Level of the cells to find.
+        std::vector<uint32_t>* ZOrders;
+    };
+
+    // Visits the children of a node that overlaps the region. cellLevel is the level of the node's own cell.
+    void findRegionCellsTree64(const Tree64RegionSearch& search, uint32_t nodeIndex, int cellLevel, uint32_t ZOrderPrefix, core::ivec3 cellMin, bool insideRegion) {
+        const uint32_t* node = search.tree64 + size_t(nodeIndex) * 3;
+        uint64_t validMask = getTree64ValidMask(node);
+        uint32_t firstChild = nodeIndex + getTree64ChildPointer(node);
+        int childLevel = cellLevel - 1;
+        int childSize = 1 << (2 * childLevel);
+        uint32_t childRank = 0;
+        for(uint64_t remaining = validMask; remaining != 0; childRank++) {
+            uint32_t zOrderInParent = uint32_t(__builtin_clzll(remaining));
+            remaining &= ~(1ull << (63 - zOrderInParent));
+            uint32_t childPrefix = (ZOrderPrefix << 6) | zOrderInParent;
+
+            bool childInsideRegion = insideRegion;
+            if(!insideRegion) {
+                core::ivec3 childMin = cellMin + getTree64ChildOffset(zOrderInParent) * childSize;
+                VoxelRegionOverlap overlap = classifyBoundsInVoxelRegion(*search.region, core::vec3(childMin), core::vec3(childMin + core::ivec3(childSize)));
+                if(overlap == VoxelRegionOverlap::Outside) {
+                    continue;
+                }
+                childInsideRegion = overlap == VoxelRegionOverlap::Inside;
+                if(childLevel > search.level) {
+                    findRegionCellsTree64(search, firstChild + childRank, childLevel, childPrefix, childMin, childInsideRegion);
+                    continue;
+                }
+            } else if(childLevel > search.level) {
+                findRegionCellsTree64(search, firstChild + childRank, childLevel, childPrefix, cellMin, true); // Cell positions aren't needed once inside.
+                continue;
+            }
+            search.ZOrders->push_back(childPrefix);
+        }
+    }
+
+    void findVoxelsInRegionTree64(const std::vector<uint32_t>& tree64, int gridResolution, const VoxelRegion& region, std::vector<uint32_t>& ZOrders, int level) {
+        int levelsOfDepth = getTree64LevelsOfDepth(gridResolution);
+        if(levelsOfDepth > MAX_TREE64_LEVELS) {
+            throw std::invalid_argument("findVoxelsInRegionTree64: Resolution " + std::to_string(gridResolution) + " needs more than " + std::to_string(MAX_TREE64_LEVELS) + " levels");
+        }
+        if(!hasSingleTree64Root(gridResolution)) { // Voxels outside of the first root's block would never be found.
+            throw std::invalid_argument("findVoxelsInRegionTree64: Resolution " + std::to_string(gridResolution) + " isn't a power of 4, its tree64 can have more than one root");
+        }
+        if(level < 0 || level > levelsOfDepth) {
+            throw std::invalid_argument("findVoxelsInRegionTree64: Level " + std::to_string(level) + " is outside of a tree64 with " + std::to_string(levelsOfDepth) + " levels");
+        }
+        if(tree64.empty() || getTree64ValidMask(tree64.data()) == 0) {
+            return;
+        }
+        int treeSize = 1 << (2 * levelsOfDepth);
+        VoxelRegionOverlap overlap = classifyBoundsInVoxelRegion(region, core::vec3(0.0f), core::vec3(float(treeSize)));
+        if(overlap == VoxelRegionOverlap::Outside) {
+            return;
+        }
+        if(level == levelsOfDepth) {
+            ZOrders.push_back(0);
+            return;
+        }
+        Tree64RegionSearch search = {tree64.data(), &region, level, &ZOrders};
+        findRegionCellsTree64(search, 0, levelsOfDepth, 0, core::ivec3(0), overlap == VoxelRegionOverlap::Inside);
+    }
+
+    std::vector<ChunkRegionCells> findVoxelsInRegion(const Scene& scene, const SceneBVH& sceneBVH, const VoxelRegion& region, int level) {
+        std::vector<ChunkRegionCells> regionCells;
+        for(uint32_t chunkIndex : findChunksInSceneBVH(sceneBVH, region)) {
+            const Chunk& chunk = scene.chunks[chunkIndex];
+            VoxelRegion gridRegion = transformVoxelRegionToGrid(region, chunk.header.position, chunk.header.scale / float(chunk.header.resolution));
+            ChunkRegionCells chunkCells;
+            chunkCells.chunkIndex = chunkIndex;
+            findVoxelsInRegionTree64(chunk.geometryData, int(chunk.header.resolution), gridRegion, chunkCells.ZOrders, level);
+            if(!chunkCells.ZOrders.empty()) {
+                regionCells.push_back(std::move(chunkCells));
+            }
+        }
+        return regionCells;
+    }
+}